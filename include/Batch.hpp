@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
+ * Reserved. Permission to use, copy, modify and distribute this software for
+ * educational, research, and not-for-profit purposes, without fee and without a
+ * signed license agreement, is hereby granted, provided that this paragraph and
+ * the following two paragraphs appear in all copies, modifications, and
+ * distributions.
+ *
+ * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
+ * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
+ * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
+ *
+ * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
+ * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+/**
+ * @file Batch.hpp
+ *
+ * @brief Contains the batched solver of many instances of one small circuit
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "../lib/external/Eigen/Dense"
+
+struct StampRecord;
+
+/** Instances factorized side by side, one per SIMD lane */
+constexpr int batchLanes = 8;
+
+/** Largest system factorized by the fixed size kernels */
+constexpr int batchUnknowns = 32;
+
+/** Pivot, relative to the largest entry of its column, under which an
+ * instance is solved again with partial pivoting */
+constexpr double batchPivotTolerance = 1e-3;
+
+/** @struct BatchReport
+ *
+ * @brief Describes a batched solve
+ * */
+struct BatchReport
+{
+    int instances = 0;      /**< Instances solved */
+    bool fixedSize = false; /**< Factorized by the fixed size kernels */
+    int repivoted = 0;      /**< Instances whose static pivots were too
+                               small, solved again with partial pivoting */
+    double time = 0.0;      /**< Time of the solve (ms) */
+};
+
+/**
+ * @brief		Solves many instances of a system that differ only in the
+ *				values of some elements
+ *
+ * The rows are put in the partial pivoting order of the netlist values once,
+ * and every instance is factorized in that order without pivoting. Systems
+ * of at most batchUnknowns unknowns are stored entry by entry across
+ * batchLanes instances, so each step of the LU updates all of them with one
+ * vector operation, in kernels unrolled for every size. Larger systems are
+ * solved one instance at a time.
+ *
+ * @param		fixed Stamp records of the elements common to all instances
+ * @param		varying Stamp records of the elements whose value changes
+ * @param		columns Column of values of every varying record
+ * @param		values One row per instance
+ * @param		m Number of unknowns (the sentinel index)
+ * @param		threads Threads solving the instances
+ * @param[out]	report Instances and how they were solved
+ *
+ * @return		m x instances solutions
+ */
+Eigen::MatrixXd solveBatch(const std::vector<StampRecord> &fixed,
+                           const std::vector<StampRecord> &varying,
+                           const std::vector<int> &columns,
+                           const Eigen::MatrixXd &values, int m, int threads,
+                           BatchReport &report);
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
+ * Reserved. Permission to use, copy, modify and distribute this software for
+ * educational, research, and not-for-profit purposes, without fee and without a
+ * signed license agreement, is hereby granted, provided that this paragraph and
+ * the following two paragraphs appear in all copies, modifications, and
+ * distributions.
+ *
+ * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
+ * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
+ * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
+ *
+ * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
+ * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+/**
+ * @file CircuitTable.hpp
+ *
+ * @brief Contains the columnar (structure of arrays) store of circuit elements
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../lib/external/Eigen/Dense"
+#include "CircuitElement.hpp"
+#include "Stamp.hpp"
+
+/** @struct CircuitTable
+ *
+ * @brief Circuit elements stored column by column
+ *
+ * Row r of every column describes the same element. Node and element names
+ * live in side tables, the columns only hold indices into them, so the loops
+ * that stamp or update the elements run over small contiguous arrays.
+ *
+ * The first count rows are the elements to be stamped. A controlling element
+ * that is not one of them is appended after them, it is only referred to.
+ * */
+struct CircuitTable
+{
+    int count = 0; /**< Number of rows to be stamped */
+    std::vector<std::uint8_t> type;    /**< Component of every row */
+    std::vector<std::uint8_t> group;   /**< Group of every row */
+    std::vector<std::uint8_t> control; /**< ControlVariable of every row */
+    std::vector<int> nodeA; /**< Position of nodeA in nodes, 0 is ground */
+    std::vector<int> nodeB; /**< Position of nodeB in nodes, 0 is ground */
+    std::vector<int> controller; /**< Row of the controlling element, or -1 */
+    Eigen::VectorXd value;       /**< Value (or scale factor) of every row */
+    std::vector<std::string> names; /**< Name of the element of every row */
+    std::vector<std::string> nodes; /**< Node names, nodes[0] is ground */
+};
+
+/**
+ * @brief		Stores the elements column by column
+ *
+ * @param		circuitElements Elements to be stored, in stamping order
+ *
+ * @return		Table of the elements and their controlling elements
+ */
+CircuitTable makeCircuitTable(
+    const std::vector<std::shared_ptr<CircuitElement>> &circuitElements);
+
+/**
+ * @brief		Resolves the rows of the table to stamp records, sorted by
+ *				kernel
+ *
+ * Every node and element name is looked up once, the records are then
+ * gathered from the columns.
+ *
+ * @param		circuit Table of the elements
+ * @param		indexMap Index of every unknown; names that are not in
+ *the map (ground) get the sentinel index indexMap.size()
+ *
+ * @return		Records grouped by kernel, the same as makeStampRecords()
+ *				gives for the elements of the table
+ */
+std::vector<StampRecord> makeStampRecords(
+    const CircuitTable &circuit, const std::map<std::string, int> &indexMap);
+
+/**
+ * @brief		Sets the value of every stamped row of an element
+ *
+ * An element split between two islands has one row per half.
+ *
+ * @param		circuit Table of the elements
+ * @param		name Name of the element
+ * @param		value New value
+ *
+ * @return		Number of rows changed
+ */
+int setValue(CircuitTable &circuit, const std::string &name, double value);
@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
+ * Reserved. Permission to use, copy, modify and distribute this software for
+ * educational, research, and not-for-profit purposes, without fee and without a
+ * signed license agreement, is hereby granted, provided that this paragraph and
+ * the following two paragraphs appear in all copies, modifications, and
+ * distributions.
+ *
+ * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
+ * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
+ * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
+ *
+ * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
+ * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+/**
+ * @file CodeGen.hpp
+ *
+ * @brief Contains the generation of C++ code solving one circuit topology
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../lib/external/Eigen/Dense"
+#include "CircuitElement.hpp"
+
+/** Largest system code is generated for */
+constexpr int codegenUnknowns = 5000;
+
+/** Pivot, relative to the largest candidate of its column, that is still
+ * preferred when it has fewer non-zeros in its row */
+constexpr double codegenPivotThreshold = 0.1;
+
+/** @enum TermKind
+ *
+ * Dependence of a stamped term on its element's value v
+ * */
+enum TermKind
+{
+    constantTerm, /**< coefficient */
+    linearTerm,   /**< coefficient * v */
+    inverseTerm,  /**< coefficient / v */
+};
+
+/** @struct StaticTerm
+ *
+ * @brief One stamp added to a slot before the factorization
+ * */
+struct StaticTerm
+{
+    int slot;           /**< Slot the term is added to */
+    int value;          /**< Index of the element value */
+    TermKind kind;      /**< How the term depends on the value */
+    double coefficient; /**< Factor of the term */
+};
+
+/** @enum StaticOpCode
+ *
+ * Operations of a statically ordered solve on its slots s
+ * */
+enum StaticOpCode
+{
+    checkPivot,      /**< Fails if s[a] is zero */
+    divideSlot,      /**< s[target] /= s[a] */
+    subtractProduct, /**< s[target] -= s[a] * s[b] */
+};
+
+/** @struct StaticOp
+ *
+ * @brief One operation of a statically ordered solve
+ * */
+struct StaticOp
+{
+    StaticOpCode code; /**< Operation */
+    int target;        /**< Slot written, unused by checkPivot */
+    int a;             /**< First operand */
+    int b;             /**< Second operand, used by subtractProduct */
+};
+
+/** @struct StaticSolve
+ *
+ * @brief Straight line solve of one topology for any element values
+ *
+ * The first slots hold the RHS, one per row, and the others the non-zeros of
+ * the MNA matrix, including the fill of the factorization. They are stamped
+ * from the terms, then the operations factorize the matrix in a fixed pivot
+ * order and substitute the RHS into the solution.
+ * */
+struct StaticSolve
+{
+    std::vector<std::string> values; /**< Element of every value */
+    Eigen::VectorXd defaults;        /**< Netlist value of every element */
+    std::vector<std::string> unknowns; /**< Name of every unknown */
+    int slots = 0;                     /**< Number of slots */
+    std::vector<StaticTerm> terms;     /**< Stamps, by slot */
+    std::vector<StaticOp> ops;         /**< Factorization and substitution */
+    std::vector<int> solution;         /**< Slot of every unknown */
+};
+
+/**
+ * @brief		Orders the factorization of a circuit and records it
+ *
+ * The terms come from the stamp kernels, called with the values 1 and 2 to
+ * tell constant, linear and inverse terms apart. The columns are ordered by
+ * COLAMD, and the pivot of each column is the row with the fewest non-zeros
+ * among those within codegenPivotThreshold of the largest entry, for the
+ * netlist values.
+ *
+ * @param		elements Elements of the circuit
+ * @param		indexMap Map created by makeIndexMap
+ * @param[out]	solve Recorded solve
+ *
+ * @return		number of errors
+ */
+int makeStaticSolve(
+    const std::vector<std::shared_ptr<CircuitElement>> &elements,
+    const std::map<std::string, int> &indexMap, StaticSolve &solve);
+
+/**
+ * @brief		Runs a recorded solve, the reference for the generated code
+ *
+ * @param		solve Solve created by makeStaticSolve
+ * @param		values Value of every element
+ * @param[out]	x Solution, in the order of solve.unknowns
+ *
+ * @return		false if a pivot is zero
+ */
+bool runStaticSolve(const StaticSolve &solve, const Eigen::VectorXd &values,
+                    Eigen::VectorXd &x);
+
+/**
+ * @brief		Writes a recorded solve as a self-contained C++ source file
+ *
+ * The file defines, with C linkage, the element and unknown names, the
+ * netlist values and int snuSpiceSolve(const double *v, double *x), which
+ * stamps and solves the circuit without loops and returns 1 if a pivot is
+ * zero. It can be compiled into a program or built as a shared object.
+ *
+ * @param		file Path of the source file
+ * @param		solve Solve created by makeStaticSolve
+ * @param		netlist Netlist the solve was made from, for the header
+ *
+ * @return		0 if successful else 1
+ */
+int writeStaticSolve(const std::string &file, const StaticSolve &solve,
+                     const std::string &netlist);
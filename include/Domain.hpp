@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
+ * Reserved. Permission to use, copy, modify and distribute this software for
+ * educational, research, and not-for-profit purposes, without fee and without a
+ * signed license agreement, is hereby granted, provided that this paragraph and
+ * the following two paragraphs appear in all copies, modifications, and
+ * distributions.
+ *
+ * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
+ * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
+ * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
+ *
+ * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
+ * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+/**
+ * @file Domain.hpp
+ *
+ * @brief Contains the domain decomposition solve over worker processes
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "../lib/external/Eigen/Dense"
+#include "../lib/external/Eigen/Sparse"
+
+class Transport;
+
+/** @struct DomainReport
+ *
+ * @brief Describes a domain decomposition solve
+ * */
+struct DomainReport
+{
+    bool used = false;          /**< The system was solved by domains */
+    std::string failure;        /**< Why it was not, if it was tried */
+    int interface = 0;          /**< Unknowns of the interface */
+    std::vector<int> interiors; /**< Interior unknowns of every domain */
+    double time = 0.0;          /**< Time of the whole solve (ms) */
+};
+
+/**
+ * @brief		Splits the unknowns of a system into domains and their
+ *				interface
+ *
+ * The unknowns are numbered breadth first over the pattern of A + A^T and
+ * cut into domains of consecutive numbers. Of every coupling between two
+ * domains one end joins the interface, so the interiors of different
+ * domains never touch, and so do the unknowns without a diagonal entry
+ * (the branch currents of voltage sources) that would leave an interior
+ * singular.
+ *
+ * @param		A m x m system matrix
+ * @param		domains Number of domains
+ *
+ * @return		Domain of every unknown, -1 for the interface
+ */
+std::vector<int> partitionDomains(const Eigen::SparseMatrix<double> &A,
+                                  int domains);
+
+/**
+ * @brief		Solves a system by domains, one worker process each
+ *
+ * Every worker receives the blocks of its domain, factorizes its interior
+ * A_II and writes A_GI A_II^-1 [A_IG b_I] to the transport's window. The
+ * coordinator subtracts those from A_GG and b_G, solves the interface
+ * Schur complement and sends each worker its interface values, which it
+ * back-substitutes into its interior with the same factorization.
+ *
+ * @param		A m x m system matrix
+ * @param		b Right hand side
+ * @param		domains Number of domains
+ * @param		transport Transport to the workers, not started yet
+ * @param[out]	x Solution
+ * @param[out]	report Interface and interior sizes, or the failure
+ *
+ * @return		false if the system is too small to split, an interior or
+ *				the interface is singular, or a worker fails
+ */
+bool solveDomains(const Eigen::SparseMatrix<double> &A,
+                  const Eigen::VectorXd &b, int domains, Transport &transport,
+                  Eigen::VectorXd &x, DomainReport &report);
@@ -1,53 +0,0 @@
-/*
- * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
- * Reserved. Permission to use, copy, modify and distribute this software for
- * educational, research, and not-for-profit purposes, without fee and without a
- * signed license agreement, is hereby granted, provided that this paragraph and
- * the following two paragraphs appear in all copies, modifications, and
- * distributions.
- *
- * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
- * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
- * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
- *
- * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
- * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
- * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
- * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
- * ENHANCEMENTS, OR MODIFICATIONS.
- */
-
-/**
- * @file Edge.hpp
- *
- * @brief Contains the definition of the Edge class
- */
-
-#pragma once
-
-#include <memory>
-
-#include "CircuitElement.hpp"
-#include "Node.hpp"
-
-// Forward Declaration
-class Node;
-
-/**
- * @class Edge
- *
- * @brief Represents an edge in the graph
- *
- * Each edge represents a circuit element that is connected bettween two Node.
- *
- * */
-class Edge
-{
-   public:
-    std::shared_ptr<Node>
-        source; /**< Pointer to starting node of the element */
-    std::shared_ptr<Node> target; /**< Pointer to ending node of the element */
-    std::shared_ptr<CircuitElement>
-        circuitElement; /**< Pointer to the circuit element that the edge
-                           represents */
-};
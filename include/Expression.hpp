@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
+ * Reserved. Permission to use, copy, modify and distribute this software for
+ * educational, research, and not-for-profit purposes, without fee and without a
+ * signed license agreement, is hereby granted, provided that this paragraph and
+ * the following two paragraphs appear in all copies, modifications, and
+ * distributions.
+ *
+ * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
+ * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
+ * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
+ *
+ * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
+ * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+/**
+ * @file Expression.hpp
+ *
+ * @brief Contains the .PARAM parameters and the bytecode of the value
+ * expressions
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../lib/external/Eigen/Dense"
+#include "CircuitElement.hpp"
+
+/**
+ * @brief		Reads a number with an optional engineering suffix
+ *
+ * The suffixes are T, G, MEG, K, M (milli), U, N, P and F, in either case.
+ * A leading + or - sign is accepted.
+ *
+ * @param		text Number as written, e.g. 4.7K, -1E-3 or +5
+ * @param[out]	value Value of the number
+ *
+ * @return		true if the whole text is a finite number
+ */
+bool parseEngineering(const std::string &text, double &value);
+
+/** @enum Opcode
+ *
+ * @brief Operations of the expression bytecode, run on a value stack
+ * */
+enum Opcode : std::uint8_t
+{
+    pushConstant,  /**< Pushes constants[operand] */
+    pushParameter, /**< Pushes the value of parameter slot operand */
+    negate,        /**< Negates the top of the stack */
+    add,           /**< Pops b and a, pushes a + b */
+    subtract,      /**< Pops b and a, pushes a - b */
+    multiply,      /**< Pops b and a, pushes a * b */
+    divide,        /**< Pops b and a, pushes a / b */
+    power,         /**< Pops b and a, pushes a ^ b */
+    callSqrt,      /**< Square root of the top of the stack */
+    callExp,       /**< Exponential of the top of the stack */
+    callLog,       /**< Natural logarithm of the top of the stack */
+    callAbs,       /**< Absolute value of the top of the stack */
+    callMin,       /**< Pops b and a, pushes min(a, b) */
+    callMax        /**< Pops b and a, pushes max(a, b) */
+};
+
+/** @struct Instruction
+ *
+ * @brief One operation of the bytecode
+ * */
+struct Instruction
+{
+    Opcode opcode; /**< Operation */
+    int operand;   /**< Constant or parameter slot, for the push operations */
+};
+
+/**
+ * @class ParameterTable
+ *
+ * @brief Parameters of a netlist and the element values that depend on them
+ *
+ * Every expression is compiled once into a range of one shared bytecode,
+ * the parameters in dependency order followed by the element values.
+ * Evaluating a new parameter set is then a single pass over the bytecode,
+ * without parsing any text again.
+ * */
+class ParameterTable
+{
+   public:
+    std::vector<std::string> names; /**< Name of every parameter slot */
+    Eigen::VectorXd parameters;     /**< Value of every parameter slot */
+    std::vector<std::shared_ptr<CircuitElement>>
+        elements;           /**< Elements whose value is an expression */
+    Eigen::VectorXd values; /**< Value of every bound element, in the order
+                               of elements */
+
+    /**
+     * @brief		Records a .PARAM definition, compiled by compile()
+     *
+     * @param		name Name of the parameter
+     * @param		expression Expression of its value
+     * @param		location Where it is written ("at line number n: ..."),
+     *for the error messages
+     *
+     * @return		number of errors (a parameter defined twice)
+     */
+    int define(const std::string &name, const std::string &expression,
+               const std::string &location);
+
+    /**
+     * @brief		Records an element whose value is an expression, compiled
+     *				by compile()
+     *
+     * @param		element Element whose value is computed
+     * @param		expression Expression of the value
+     * @param		location Where it is written, for the error messages
+     */
+    void bind(std::shared_ptr<CircuitElement> element,
+              const std::string &expression, const std::string &location);
+
+    /**
+     * @brief		Compiles the parameters, each after the ones it refers to,
+     *				then the element values
+     *
+     * @return		number of errors (syntax, unknown or circular parameters)
+     */
+    int compile();
+
+    /**
+     * @brief		Fixes the value of a parameter, its expression is no
+     *				longer evaluated
+     *
+     * @param		name Name of the parameter
+     * @param		value Value of the parameter
+     *
+     * @return		false if there is no such parameter
+     */
+    bool set(const std::string &name, double value);
+
+    /**
+     * @brief		Evaluates the parameters, then the element values, in one
+     *				pass over the bytecode
+     */
+    void evaluate();
+
+    /**
+     * @brief		Evaluates and writes the values into the bound elements
+     *
+     * @return		number of errors (values that are zero or not finite)
+     */
+    int apply();
+
+   private:
+    struct Definition
+    {
+        std::string expression, location;
+        int begin = 0, end = 0; /**< Bytecode range, set by compile() */
+        bool fixed = false;     /**< Value set by set(), not evaluated */
+    };
+
+    std::vector<Definition> definitions; /**< One per parameter slot */
+    std::vector<Definition> bindings;    /**< One per bound element */
+    std::map<std::string, int> slots;    /**< Slot of every parameter */
+    std::vector<int> order;              /**< Slots in evaluation order */
+    std::vector<Instruction> code;       /**< Bytecode of all expressions */
+    std::vector<double> constants;       /**< Constants of the bytecode */
+    std::vector<double> stack;           /**< Deep enough for every range */
+
+    int compile(Definition &definition, std::vector<int> &state);
+    double run(int begin, int end);
+};
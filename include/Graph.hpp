@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
+ * Reserved. Permission to use, copy, modify and distribute this software for
+ * educational, research, and not-for-profit purposes, without fee and without a
+ * signed license agreement, is hereby granted, provided that this paragraph and
+ * the following two paragraphs appear in all copies, modifications, and
+ * distributions.
+ *
+ * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
+ * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
+ * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
+ *
+ * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
+ * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+/**
+ * @file Graph.hpp
+ *
+ * @brief Contains the compressed adjacency structure of the circuit graph
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "CircuitElement.hpp"
+
+/** @struct Graph
+ *
+ * @brief Circuit graph in compressed sparse row (CSR) form
+ *
+ * Nodes and elements are numbered in the order they first appear in the
+ * element list. The incidences of node k are the positions offsets[k] to
+ * offsets[k + 1] - 1 of neighbors and elementIds; every element appears
+ * twice, once from each of its terminals. The arrays are built once and
+ * never changed, so traversals walk contiguous memory.
+ * */
+struct Graph
+{
+    std::vector<std::string> names; /**< Name of every node */
+    std::unordered_map<std::string, int> ids; /**< Number of every node */
+    int ground = -1; /**< Number of ground (0), -1 if it is not in the graph */
+
+    std::vector<std::shared_ptr<CircuitElement>>
+        elements;              /**< Element of every element id */
+    std::vector<int> nodeA;    /**< Number of every element's nodeA */
+    std::vector<int> nodeB;    /**< Number of every element's nodeB */
+
+    std::vector<int> offsets;    /**< Start of every node's incidences, one
+                                    more than the nodes */
+    std::vector<int> neighbors;  /**< Far terminal of every incidence */
+    std::vector<int> elementIds; /**< Element of every incidence */
+
+    /** Number of nodes */
+    int nodeCount() const { return int(names.size()); }
+};
+
+/**
+ * @brief		Creates the graph of a list of circuit elements
+ *
+ * The first pass numbers the nodes and counts the incidences of each, the
+ * second one writes every element into the rows of both its terminals.
+ *
+ * @param		circuitElements Elements of the circuit
+ *
+ * @return		Graph of the elements
+ */
+Graph makeGraph(
+    const std::vector<std::shared_ptr<CircuitElement>> &circuitElements);
@@ -0,0 +1,283 @@
+/*
+ * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
+ * Reserved. Permission to use, copy, modify and distribute this software for
+ * educational, research, and not-for-profit purposes, without fee and without a
+ * signed license agreement, is hereby granted, provided that this paragraph and
+ * the following two paragraphs appear in all copies, modifications, and
+ * distributions.
+ *
+ * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
+ * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
+ * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
+ *
+ * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
+ * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+/**
+ * @file LinearSolver.hpp
+ *
+ * @brief Contains the definition of the linear solver backends
+ */
+
+#pragma once
+
+#include <string>
+
+#include "../lib/external/Eigen/Dense"
+#include "../lib/external/Eigen/Sparse"
+#include "Batch.hpp"
+#include "Domain.hpp"
+#include "OutOfCore.hpp"
+#include "Relaxation.hpp"
+
+/** @struct SolveReport
+ *
+ * @brief Describes how a system was solved
+ * */
+struct SolveReport
+{
+    int refinements = 0;   /**< Refinement steps of the mixed precision solve */
+    double residual = 0.0; /**< Scaled residual ||b - Ax|| / (||A|| ||x||),
+                              infinity norms */
+    bool fellBack = false; /**< Mixed precision did not converge and the
+                              system was solved in double precision */
+    RelaxationReport relaxation; /**< Block relaxation, if it was used */
+    bool diagnosed = false; /**< The figures below were computed */
+    double rcond = 0.0;     /**< Reciprocal condition estimate, 1-norm */
+    double growth = 0.0;    /**< Pivot growth max |U| / max |A| */
+    double smallestPivot = 0.0; /**< Smallest pivot magnitude |U_kk| */
+    int pivotUnknown = -1;  /**< Unknown (column of A) of the smallest pivot */
+    std::string pivotName;  /**< Name of that unknown */
+    bool equilibrated = false; /**< Rows and columns were scaled */
+    BatchReport batch;         /**< Batched solve, if it was used */
+    OutOfCoreReport outOfCore; /**< Out-of-core solve, if it was tried */
+    DomainReport domains;      /**< Solve by domains, if it was tried */
+};
+
+/** Reciprocal condition estimate under which a system is reported as ill
+ * conditioned, and equilibrated when asked for */
+constexpr double illConditioned = 1e-12;
+
+/**
+ * @brief		Scaled residual ||b - Ax|| / (||A|| ||x||) in infinity norms
+ *
+ * @param		A Dense or sparse matrix
+ * @param		x Solution
+ * @param		b Right hand side
+ *
+ * @return		Scaled residual, or ||b - Ax|| when ||A|| ||x|| is zero
+ */
+template <class Matrix>
+double scaledResidual(const Matrix &A, const Eigen::VectorXd &x,
+                      const Eigen::VectorXd &b)
+{
+    double anorm = (A.cwiseAbs() * Eigen::VectorXd::Ones(A.cols())).maxCoeff();
+    double scale = anorm * x.lpNorm<Eigen::Infinity>();
+    Eigen::VectorXd r = b - A * x;
+    double rnorm = r.lpNorm<Eigen::Infinity>();
+    return scale > 0.0 ? rnorm / scale : rnorm;
+}
+
+/** Refinement steps allowed before the mixed precision solve falls back */
+constexpr int maxRefinements = 30;
+
+/**
+ * @brief		Solves Ax = b with a double precision LU factorization
+ *
+ * @param[ref]	A Square matrix, overwritten by its LU factors
+ * @param		b Right hand side
+ *
+ * @return		Solution x
+ */
+Eigen::VectorXd solveDense(Eigen::Ref<Eigen::MatrixXd> A,
+                           const Eigen::VectorXd &b);
+
+/**
+ * @brief		Solves Ax = b and the adjoint systems A^T Y = S with the
+ *				same double precision LU factorization
+ *
+ * @param[ref]	A Square matrix, overwritten by its LU factors
+ * @param		b Right hand side
+ * @param		seeds Right hand sides S of the adjoint systems, one per
+ *				column
+ * @param[out]	adjoints Solutions Y of the adjoint systems
+ *
+ * @return		Solution x
+ */
+Eigen::VectorXd solveDense(Eigen::Ref<Eigen::MatrixXd> A,
+                           const Eigen::VectorXd &b,
+                           const Eigen::MatrixXd &seeds,
+                           Eigen::MatrixXd &adjoints);
+
+/**
+ * @brief		Solves Ax = b with a double precision LU factorization and
+ *				reports the health of the factorization
+ *
+ * Fills the reciprocal condition estimate, the pivot growth and the
+ * smallest pivot. The residual needs A, which is overwritten, so it is left
+ * to the caller.
+ *
+ * @param[ref]	A Square matrix, overwritten by its LU factors
+ * @param		b Right hand side
+ * @param[out]	report Health of the factorization
+ *
+ * @return		Solution x
+ */
+Eigen::VectorXd solveDense(Eigen::Ref<Eigen::MatrixXd> A,
+                           const Eigen::VectorXd &b, SolveReport &report);
+
+/**
+ * @brief		Solves Ax = b by factorizing A in single precision and
+ *				refining x with double precision residuals
+ *
+ * Stops when ||b - Ax|| <= sqrt(n) ||A|| ||x|| eps (as LAPACK's dsgesv). If
+ * that does not happen within maxRefinements steps, or A does not fit in
+ * single precision, A is factorized again in double precision.
+ *
+ * @param		A Square matrix
+ * @param		b Right hand side
+ * @param[out]	report Refinement steps, achieved residual and fallback
+ *
+ * @return		Solution x
+ */
+Eigen::VectorXd solveDenseMixed(const Eigen::Ref<const Eigen::MatrixXd> &A,
+                                const Eigen::VectorXd &b,
+                                SolveReport &report);
+
+/**
+ * @brief		Solves Ax = b by factorizing A in single precision with a
+ *				sparse LU and refining x with double precision residuals
+ *
+ * Same stopping test as solveDenseMixed(). If the single precision
+ * factorization fails, or the refinement does not converge within
+ * maxRefinements steps, A is solved with solveSparse().
+ *
+ * @param		A Square sparse matrix
+ * @param		b Right hand side
+ * @param[out]	report Refinement steps, achieved residual and fallback
+ *
+ * @return		Solution x, NaN if A could not be factorized
+ */
+Eigen::VectorXd solveSparseMixed(const Eigen::SparseMatrix<double> &A,
+                                 const Eigen::VectorXd &b,
+                                 SolveReport &report);
+
+/**
+ * @brief		Solves Ax = b with a sparse LU factorization (COLAMD
+ *				ordering)
+ *
+ * @param		A Square sparse matrix
+ * @param		b Right hand side
+ *
+ * @return		Solution x, NaN if A could not be factorized
+ */
+Eigen::VectorXd solveSparse(const Eigen::SparseMatrix<double> &A,
+                            const Eigen::VectorXd &b);
+
+/**
+ * @brief		Solves Ax = b with a sparse LU factorization and reports
+ *				the health of the factorization and the scaled residual
+ *
+ * With equilibrate, a system whose condition estimate is below
+ * illConditioned is solved again with its rows and columns scaled (see
+ * equilibrationScales()), and the better conditioned solve is kept.
+ *
+ * @param		A Square sparse matrix
+ * @param		b Right hand side
+ * @param		equilibrate Scales an ill conditioned system
+ * @param[out]	report Health of the factorization
+ *
+ * @return		Solution x, NaN if A could not be factorized
+ */
+Eigen::VectorXd solveSparse(const Eigen::SparseMatrix<double> &A,
+                            const Eigen::VectorXd &b, bool equilibrate,
+                            SolveReport &report);
+
+/**
+ * @brief		Pivots and largest entry of the upper factor of a sparse LU
+ *				factorization, P_r A P_c^-1 = LU
+ *
+ * SparseLU only offers triangular solves with its factors, so U is read
+ * from its supernodal storage, which is pinned to the vendored Eigen. No
+ * other function reads that storage.
+ *
+ * @param		lu Successful factorization
+ * @param[out]	pivots U(j, j) for every column j of the factors
+ *
+ * @return		Largest magnitude of the entries of U
+ */
+double upperFactorPivots(
+    const Eigen::SparseLU<Eigen::SparseMatrix<double>> &lu,
+    Eigen::VectorXd &pivots);
+
+/**
+ * @brief		Solves Ax = b and the adjoint systems A^T Y = S with the
+ *				same sparse LU factorization
+ *
+ * @param		A Square sparse matrix
+ * @param		b Right hand side
+ * @param		seeds Right hand sides S of the adjoint systems, one per
+ *				column
+ * @param[out]	adjoints Solutions Y of the adjoint systems
+ *
+ * @return		Solution x, NaN if A could not be factorized
+ */
+Eigen::VectorXd solveSparse(const Eigen::SparseMatrix<double> &A,
+                            const Eigen::VectorXd &b,
+                            const Eigen::MatrixXd &seeds,
+                            Eigen::MatrixXd &adjoints);
+
+/**
+ * @brief		Solves AX = B for all the columns of B with one double
+ *				precision LU factorization
+ *
+ * The triangular solves run on all the columns at once (blocked, matrix-
+ * matrix kernels), which is much faster per column than repeated solves.
+ *
+ * @param[ref]	A Square matrix, overwritten by its LU factors
+ * @param		B Right hand sides, one per column
+ *
+ * @return		Solutions X, one per column
+ */
+Eigen::MatrixXd solveDenseBlock(Eigen::Ref<Eigen::MatrixXd> A,
+                                const Eigen::Ref<const Eigen::MatrixXd> &B);
+
+/**
+ * @brief		Solves AX = B for all the columns of B with one sparse LU
+ *				factorization
+ *
+ * @param		A Square sparse matrix
+ * @param		B Right hand sides, one per column
+ *
+ * @return		Solutions X, NaN if A could not be factorized
+ */
+Eigen::MatrixXd solveSparseBlock(const Eigen::SparseMatrix<double> &A,
+                                 const Eigen::Ref<const Eigen::MatrixXd> &B);
+
+/**
+ * @brief		Row and column scales that equilibrate a matrix
+ *
+ * As LAPACK's dgeequ, every row is scaled so that its largest entry is
+ * close to 1, then every column of the scaled rows. The scales are powers
+ * of 2, so scaling adds no rounding error.
+ *
+ * @param		A Square matrix
+ * @param[out]	rows Scale of every row
+ * @param[out]	cols Scale of every column
+ */
+void equilibrationScales(const Eigen::Ref<const Eigen::MatrixXd> &A,
+                         Eigen::VectorXd &rows, Eigen::VectorXd &cols);
+
+/**
+ * @brief		Row and column scales that equilibrate a sparse matrix
+ *
+ * @param		A Square sparse matrix
+ * @param[out]	rows Scale of every row
+ * @param[out]	cols Scale of every column
+ */
+void equilibrationScales(const Eigen::SparseMatrix<double> &A,
+                         Eigen::VectorXd &rows, Eigen::VectorXd &cols);
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
+ * Reserved. Permission to use, copy, modify and distribute this software for
+ * educational, research, and not-for-profit purposes, without fee and without a
+ * signed license agreement, is hereby granted, provided that this paragraph and
+ * the following two paragraphs appear in all copies, modifications, and
+ * distributions.
+ *
+ * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
+ * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
+ * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
+ *
+ * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
+ * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+/**
+ * @file MatrixMarket.hpp
+ *
+ * @brief Contains the definition of the Matrix Market export and import of
+ * assembled MNA systems
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "../lib/external/Eigen/Dense"
+#include "../lib/external/Eigen/Sparse"
+
+/**
+ * @brief		Writes an assembled system as three files:
+ *				<base>.mtx (coordinate real general), <base>.rhs.mtx
+ *				(array real general) and <base>.names (one "index name"
+ *				line per unknown, 1-based as in the .mtx file)
+ *
+ * @param		base Path of the files without extension
+ * @param		A MNA matrix
+ * @param		b RHS vector
+ * @param		names Name of every unknown, in index order
+ *
+ * @return		0 if successful else 1
+ */
+int writeMatrixMarket(const std::string &base,
+                      const Eigen::SparseMatrix<double> &A,
+                      const Eigen::VectorXd &b,
+                      const std::vector<std::string> &names);
+
+/**
+ * @brief		Reads a system written by writeMatrixMarket
+ *
+ * <base>.mtx is required. Without <base>.rhs.mtx the RHS is a vector of
+ * ones; without <base>.names the unknowns are named by their index.
+ *
+ * @param		base Path of the files without extension
+ * @param[out]	A MNA matrix
+ * @param[out]	b RHS vector
+ * @param[out]	names Name of every unknown, in index order
+ *
+ * @return		0 if successful else 1
+ */
+int readMatrixMarket(const std::string &base, Eigen::SparseMatrix<double> &A,
+                     Eigen::VectorXd &b, std::vector<std::string> &names);
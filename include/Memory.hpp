@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
+ * Reserved. Permission to use, copy, modify and distribute this software for
+ * educational, research, and not-for-profit purposes, without fee and without a
+ * signed license agreement, is hereby granted, provided that this paragraph and
+ * the following two paragraphs appear in all copies, modifications, and
+ * distributions.
+ *
+ * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
+ * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
+ * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
+ *
+ * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
+ * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ */
+/**
+ * @file Memory.hpp
+ *
+ * @brief Contains the definition of the memory planning of the solve and of
+ * the measurement of the resident memory
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Topology.hpp"
+
+/** @enum SolvePath
+ *
+ * @brief Ways to solve the system of an island
+ * */
+enum SolvePath
+{
+    denseSolve,    /**< Dense LU in double precision */
+    mixedSolve,    /**< Dense LU in single precision with refinement */
+    sparseSolve,   /**< Sparse LU with a COLAMD ordering */
+    outOfCoreSolve /**< Banded LU with its factors on disk */
+};
+
+/** Non-zeros assumed per stamped element, the most any kernel stamps */
+constexpr int stampEntriesPerElement = 6;
+
+/** Non-zeros of the sparse LU factors per non-zero of the matrix, a
+ * pessimistic fill for MNA matrices ordered by COLAMD */
+constexpr int sparseFillFactor = 10;
+
+/** @struct MemoryEstimate
+ *
+ * @brief Estimated peak memory of one solve path
+ * */
+struct MemoryEstimate
+{
+    SolvePath path;   /**< Solve path */
+    std::size_t bytes; /**< Peak of the islands solved at the same time */
+};
+
+/** @struct MemoryPlan
+ *
+ * @brief Solve path picked for the memory limit
+ * */
+struct MemoryPlan
+{
+    SolvePath path = denseSolve; /**< Picked path */
+    bool fits = true;            /**< Whether the picked path fits */
+    std::size_t resident = 0;    /**< Resident memory when planning */
+    std::vector<MemoryEstimate> candidates; /**< Every path, in order of
+                                               preference */
+};
+
+/**
+ * @brief		Size in KB, MB or GB with one decimal
+ */
+std::string formatBytes(std::size_t bytes);
+
+/**
+ * @brief		Name of a solve path
+ */
+const char *solvePathName(SolvePath path);
+
+/**
+ * @brief		Estimated memory of solving one system
+ *
+ * The out-of-core path only counts what it keeps in memory besides its band
+ * window, which is given what is left of the limit when it solves.
+ *
+ * @param		path Solve path
+ * @param		unknowns Unknowns of the system
+ * @param		elements Elements stamped into the system
+ *
+ * @return		Estimate in bytes
+ */
+std::size_t estimateSolveBytes(SolvePath path, std::size_t unknowns,
+                               std::size_t elements);
+
+/**
+ * @brief		Picks the first solve path whose islands fit the limit
+ *
+ * Islands are solved by up to threadCount threads, so the peak is taken as
+ * the sum of the threadCount largest islands on top of the memory already
+ * resident. The out-of-core path is only tried last, and only if asked for.
+ *
+ * @param		islands Islands to be solved
+ * @param		indexMap Index map of the whole circuit
+ * @param		threadCount Threads solving the islands
+ * @param		preferred Path asked for on the command line
+ * @param		limit Memory limit in bytes, 0 for none
+ * @param		outOfCore Whether the out-of-core path may be picked
+ *
+ * @return		Plan with the picked path and every estimate
+ */
+MemoryPlan planMemory(const std::vector<Island> &islands,
+                      const std::map<std::string, int> &indexMap,
+                      std::size_t threadCount, SolvePath preferred,
+                      std::size_t limit, bool outOfCore = false);
+
+/**
+ * @brief		Prints the estimates of a plan against the limit
+ */
+void printMemoryPlan(const MemoryPlan &plan, std::size_t limit);
+
+/**
+ * @brief		Peak resident memory of the process since the last
+ *				resetPeakResident(), in bytes
+ */
+std::size_t peakResidentBytes();
+
+/**
+ * @brief		Current resident memory of the process, in bytes
+ */
+std::size_t residentBytes();
+
+/**
+ * @brief		Restarts the peak resident memory from the current one,
+ *				where the system allows it
+ */
+void resetPeakResident();
+
+/** @struct PhaseMemory
+ *
+ * @brief Peak resident memory of every phase of a run
+ * */
+struct PhaseMemory
+{
+    std::vector<std::pair<std::string, std::size_t>>
+        phases; /**< Name and peak resident bytes of every phase */
+
+    /**
+     * @brief		Records the peak of the phase that just ended and
+     *				starts the next one
+     */
+    void record(const std::string &phase);
+
+    /**
+     * @brief		Prints the peak of every recorded phase
+     */
+    void print() const;
+};
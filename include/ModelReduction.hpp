@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
+ * Reserved. Permission to use, copy, modify and distribute this software for
+ * educational, research, and not-for-profit purposes, without fee and without a
+ * signed license agreement, is hereby granted, provided that this paragraph and
+ * the following two paragraphs appear in all copies, modifications, and
+ * distributions.
+ *
+ * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
+ * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
+ * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
+ *
+ * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
+ * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+/**
+ * @file ModelReduction.hpp
+ *
+ * @brief Contains the Krylov (PRIMA) model order reduction of passive R, C
+ * and L subnetworks
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "../lib/external/Eigen/Dense"
+#include "Parser.hpp"
+
+/** @struct ReducedModel
+ *
+ * @brief Reduced model of a passive subnetwork seen from its ports
+ *
+ * The model is (G + sC) x = B i with x = [port voltages; states] and
+ * B = [I; 0], obtained by the congruence transform of the subnetwork's MNA
+ * matrices with an orthonormal Krylov basis of its internal unknowns. The
+ * transform keeps the model passive, and its port admittance matches the
+ * one of the subnetwork exactly at DC and in the first moments around it.
+ * */
+struct ReducedModel
+{
+    std::vector<std::string> ports; /**< Port nodes, ground is the reference */
+    Eigen::MatrixXd G; /**< (ports + states) square conductance matrix */
+    Eigen::MatrixXd C; /**< (ports + states) square susceptance matrix */
+    int internal = 0;  /**< Internal unknowns of the replaced subnetwork */
+    int elements = 0;  /**< Elements of the replaced subnetwork */
+};
+
+/**
+ * @brief		Replaces every passive subnetwork with a reduced model
+ *
+ * Group 1 resistors and capacitors and inductors are passive, unless they
+ * are probed, are outputs of .SENS or control a source. A node touched by
+ * another element, or probed, is a port; the other nodes of the passive
+ * elements are internal. Each connected set of internal nodes, with the
+ * passive elements touching it, forms one subnetwork. Its model is stamped
+ * in its place by stampReducedModel(); the internal nodes are no longer
+ * unknowns of the circuit.
+ *
+ * @param[ref]	parser Parser whose elements and nodes are replaced
+ * @param		moments Krylov blocks of each basis, each one matches one
+ *more moment of the port admittance
+ * @param[out]	models Models of the replaced subnetworks
+ *
+ * @return		number of errors (subnetworks without a DC path to a port
+ *or ground)
+ */
+int reduceNetworks(Parser &parser, int moments,
+                   std::vector<ReducedModel> &models);
+
+/**
+ * @brief		Port admittance of a model at DC
+ *
+ * @param		model Reduced model
+ * @param[out]	Y Admittance matrix of the ports, Y = G_pp - G_ps G_ss^-1
+ *G_sp
+ *
+ * @return		false if the states of the model are singular at DC
+ */
+bool dcAdmittance(const ReducedModel &model, Eigen::MatrixXd &Y);
+
+/**
+ * @brief		Stamps a model into the circuit as its DC equivalent
+ *
+ * Capacitors are open at DC, so the model reduces to its port admittance.
+ * It is added as one group 1 resistor per coupled pair of ports and per
+ * port with a path to ground, named R<name>_<k>.
+ *
+ * @param[ref]	parser Parser the equivalent resistors are added to
+ * @param		model Reduced model, its ports are nodes of the netlist
+ * @param		name Name of the model, unique in the netlist
+ *
+ * @return		number of errors (a model singular at DC)
+ */
+int stampReducedModel(Parser &parser, const ReducedModel &model,
+                      const std::string &name);
+
+/**
+ * @brief		Writes reduced models to a text file
+ *
+ * @param		file Path of the file
+ * @param		models Models to be written
+ *
+ * @return		number of errors
+ */
+int saveReducedModels(const std::string &file,
+                      const std::vector<ReducedModel> &models);
+
+/**
+ * @brief		Reads the reduced models written by saveReducedModels()
+ *
+ * @param		file Path of the file
+ * @param[out]	models Models of the file
+ *
+ * @return		number of errors
+ */
+int loadReducedModels(const std::string &file,
+                      std::vector<ReducedModel> &models);
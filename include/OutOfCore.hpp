@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
+ * Reserved. Permission to use, copy, modify and distribute this software for
+ * educational, research, and not-for-profit purposes, without fee and without a
+ * signed license agreement, is hereby granted, provided that this paragraph and
+ * the following two paragraphs appear in all copies, modifications, and
+ * distributions.
+ *
+ * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
+ * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
+ * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
+ *
+ * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
+ * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+/**
+ * @file OutOfCore.hpp
+ *
+ * @brief Contains the out-of-core solve of systems larger than memory
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "../lib/external/Eigen/Dense"
+
+struct StampRecord;
+
+/** @struct OutOfCoreReport
+ *
+ * @brief Describes an out-of-core solve
+ * */
+struct OutOfCoreReport
+{
+    bool used = false;          /**< The system was solved out of core */
+    std::string failure;        /**< Why it was not, if it was tried */
+    int lower = 0;              /**< Lower bandwidth after the ordering */
+    int upper = 0;              /**< Upper bandwidth after the ordering */
+    int panels = 0;             /**< Panels of the factors on disk */
+    int panelColumns = 0;       /**< Columns of a panel */
+    std::size_t window = 0;     /**< Bytes of the band being factorized */
+    std::size_t factors = 0;    /**< Bytes of the factors on disk */
+};
+
+/**
+ * @brief		Solves a system with its factors on disk
+ *
+ * The stamps are spilled to a memory mapped scratch file, and the unknowns
+ * are ordered by reverse Cuthill-McKee on an adjacency that is mapped as
+ * well. The banded LU with partial pivoting (as LAPACK's dgbtrf) then only
+ * holds in memory the window of columns the current column updates. Every
+ * finished column goes to a panel, written to a scratch file when full, and
+ * the substitutions read the panels back one at a time, forward then
+ * backward. Only vectors of the number of unknowns stay in memory.
+ *
+ * @param		records Stamp records of the system
+ * @param		m Number of unknowns (the sentinel index)
+ * @param		B m x k right hand sides
+ * @param		scratch Directory of the scratch files
+ * @param		budget Bytes the window and a panel may take
+ * @param[out]	X m x k solutions
+ * @param[out]	report Band, panels and sizes, or the failure
+ *
+ * @return		false if the window does not fit the budget, the system
+ *				is singular or a scratch file fails
+ */
+bool solveOutOfCore(const std::vector<StampRecord> &records, int m,
+                    const Eigen::MatrixXd &B, const std::string &scratch,
+                    std::size_t budget, Eigen::MatrixXd &X,
+                    OutOfCoreReport &report);
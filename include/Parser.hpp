@@ -31,6 +31,19 @@
 #include <vector>
 
 #include "CircuitElement.hpp"
+#include "Expression.hpp"
+
+/** @struct Sweep
+ *
+ * @brief DC sweep of an independent source, from a .DC line
+ * */
+struct Sweep
+{
+    std::string source; /**< Swept source, empty if there is no sweep */
+    double start = 0.0; /**< First value of the source */
+    double stop = 0.0;  /**< Last value of the source */
+    double step = 0.0;  /**< Increment between two points */
+};
 
 /**
  * @class Parser
@@ -50,6 +63,20 @@ class Parser
         circuitElements; /**< Stores the circuit elements in form of a vector */
     std::set<std::string> nodes_group2; /**< Stores all node names and group_2
                                          circuit element names*/
+    std::vector<std::shared_ptr<CircuitElement>>
+        currentProbes; /**< Group 2 elements without a branch unknown, their
+                          current is computed after the solve */
+    std::vector<std::string>
+        probes; /**< Unknowns to be printed, from .PROBE/.PRINT lines (and
+                   the command line); empty prints every unknown */
+    Sweep sweep; /**< Source swept by a .DC line */
+    std::vector<std::string>
+        sensitivities; /**< Outputs of .SENS lines, whose derivatives to
+                          every element value are wanted */
+    ParameterTable parameters; /**< .PARAM parameters and the element values
+                                  computed from them */
+    std::vector<std::string>
+        reducedModels; /**< Files of reduced models from .ROM lines */
 
     /**
      * @brief		Parses the file (netlist) into a vector
@@ -66,3 +93,12 @@ class Parser
      */
     void printParser();
 };
+
+/**
+ * @brief		Name of the node or element a probe refers to
+ *
+ * @param		token Probe as written: name, V(node) or I(element)
+ *
+ * @return		Name without the V( ) or I( ) around it
+ */
+std::string probeName(const std::string &token);
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
+ * Reserved. Permission to use, copy, modify and distribute this software for
+ * educational, research, and not-for-profit purposes, without fee and without a
+ * signed license agreement, is hereby granted, provided that this paragraph and
+ * the following two paragraphs appear in all copies, modifications, and
+ * distributions.
+ *
+ * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
+ * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
+ * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
+ *
+ * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
+ * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+/**
+ * @file Probe.hpp
+ *
+ * @brief Contains the definition of the post-solve branch current probes
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../lib/external/Eigen/Dense"
+#include "CircuitElement.hpp"
+
+/** @struct CurrentProbes
+ *
+ * @brief Branch currents computed from the solution instead of being
+ * unknowns of the MNA system
+ *
+ * Every current is I = gain * (x[a] - x[b]) + branchGain * x[branch] +
+ * offset, where x is the solution extended with a zero for ground. Kept as
+ * a structure of arrays so that all currents come out of one vectorized
+ * expression.
+ * */
+struct CurrentProbes
+{
+    std::vector<std::string> names; /**< Name of the probed elements */
+    Eigen::VectorXi a;              /**< Index of the positive voltage */
+    Eigen::VectorXi b;              /**< Index of the negative voltage */
+    Eigen::VectorXi branch;         /**< Index of a controlling current */
+    Eigen::VectorXd gain;           /**< Factor of x[a] - x[b] */
+    Eigen::VectorXd branchGain;     /**< Factor of x[branch] */
+    Eigen::VectorXd offset;         /**< Constant part of the current */
+};
+
+/**
+ * @brief		Resolves the probed elements to solution indices
+ *
+ * Elements that refer to an unknown missing from indexMap (e.g. one of an
+ * invalid island) are left out.
+ *
+ * @param		elements Elements whose current is wanted (Parser's
+ *currentProbes)
+ * @param		indexMap Index of every unknown in the solution
+ * @param		ground Index standing for ground, the number of rows of
+ *the solution
+ *
+ * @return		Probes ready to be evaluated
+ */
+CurrentProbes makeCurrentProbes(
+    const std::vector<std::shared_ptr<CircuitElement>> &elements,
+    const std::map<std::string, int> &indexMap, int ground);
+
+/**
+ * @brief		Computes the probed currents and appends them to the
+ *				solution under the element names
+ *
+ * @param		probes Probes created by makeCurrentProbes, with ground
+ *at X.rows()
+ * @param[ref]	indexMap Index map of the solution
+ * @param[ref]	X Solution, resized to hold the currents
+ */
+void appendProbeCurrents(const CurrentProbes &probes,
+                         std::map<std::string, int> &indexMap,
+                         Eigen::MatrixXd &X);
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
+ * Reserved. Permission to use, copy, modify and distribute this software for
+ * educational, research, and not-for-profit purposes, without fee and without a
+ * signed license agreement, is hereby granted, provided that this paragraph and
+ * the following two paragraphs appear in all copies, modifications, and
+ * distributions.
+ *
+ * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
+ * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
+ * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
+ *
+ * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
+ * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+/**
+ * @file Reduction.hpp
+ *
+ * @brief Contains the definition of the topological circuit reduction
+ */
+
+#pragma once
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "../lib/external/Eigen/Dense"
+#include "Parser.hpp"
+
+/** @struct EliminatedNode
+ *
+ * @brief Recovers the voltage of a node removed by the reduction
+ *
+ * V(node) = V(nodeA) + ratio * (V(nodeB) - V(nodeA))
+ * */
+struct EliminatedNode
+{
+    std::string node;  /**< Removed node */
+    std::string nodeA; /**< Neighbour the voltage is measured from */
+    std::string nodeB; /**< Neighbour the voltage is measured to */
+    double ratio;      /**< Position of the node between nodeA and nodeB */
+};
+
+/** @struct Reduction
+ *
+ * @brief Record of a reduction, needed to recover the removed nodes
+ * */
+struct Reduction
+{
+    std::vector<EliminatedNode>
+        eliminated;    /**< Removed nodes, in the order of removal */
+    int series = 0;    /**< Series resistor pairs collapsed */
+    int parallel = 0;  /**< Parallel resistors merged */
+    int sources = 0;   /**< Parallel current sources merged */
+    int dangling = 0;  /**< Dangling resistors removed */
+};
+
+/**
+ * @brief		Collapses series and parallel group 1 resistors, merges
+ *				parallel group 1 current sources and removes dangling
+ *				resistors
+ *
+ * Nodes used as controlling voltages and nodes touched by any other kind of
+ * element are never removed, so group 2 currents are not affected.
+ *
+ * @param[ref]	parser Parser whose elements and nodes are reduced
+ * @param		variable Elements whose value changes after the reduction
+ *(swept or tabulated sources), kept as they are
+ *
+ * @return		Record of the removed nodes
+ */
+Reduction reduceCircuit(Parser &parser,
+                        const std::set<std::string> &variable = {});
+
+/**
+ * @brief		Adds the removed nodes back to the solution
+ *
+ * @param		reduction Record returned by reduceCircuit
+ * @param[ref]	indexMap Index map of the solved circuit, the removed nodes
+ *are appended to it
+ * @param[ref]	X Solution of the reduced circuit, resized to hold the
+ *removed nodes
+ */
+void recoverEliminated(const Reduction &reduction,
+                       std::map<std::string, int> &indexMap,
+                       Eigen::MatrixXd &X);
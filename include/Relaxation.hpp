@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
+ * Reserved. Permission to use, copy, modify and distribute this software for
+ * educational, research, and not-for-profit purposes, without fee and without a
+ * signed license agreement, is hereby granted, provided that this paragraph and
+ * the following two paragraphs appear in all copies, modifications, and
+ * distributions.
+ *
+ * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
+ * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
+ * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
+ *
+ * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
+ * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+/**
+ * @file Relaxation.hpp
+ *
+ * @brief Contains the block relaxation of loosely coupled partitions
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "../lib/external/Eigen/Dense"
+#include "../lib/external/Eigen/Sparse"
+
+struct StampRecord;
+
+/** Largest change of a relaxed solution, relative to its size, that ends
+ * the iterations */
+constexpr double relaxationTolerance = 1e-12;
+
+/** Iterations after which a relaxation that has not converged stops */
+constexpr int relaxationIterations = 1000;
+
+/** @struct PartitionTiming
+ *
+ * @brief Size and cost of one partition of a relaxation
+ * */
+struct PartitionTiming
+{
+    int unknowns = 0;           /**< Unknowns of the partition */
+    double factorization = 0.0; /**< Time of its LU factorization (ms) */
+    double solves = 0.0;        /**< Time of all its solves (ms) */
+};
+
+/** @struct RelaxationReport
+ *
+ * @brief Describes a relaxation
+ * */
+struct RelaxationReport
+{
+    int iterations = 0;     /**< Sweeps over the partitions */
+    double change = 0.0;    /**< Relative change of the last sweep */
+    bool converged = false; /**< The change fell below the tolerance */
+    std::vector<PartitionTiming> partitions; /**< One per partition */
+};
+
+/**
+ * @brief		Splits the unknowns of a system at its weak couplings
+ *
+ * Every element joins the unknowns it stamps, except group 1 resistors of
+ * at least cut ohms, and the controlling unknowns of controlled sources.
+ * Those are the couplings the relaxation iterates on.
+ *
+ * @param		records Stamp records of the system
+ * @param		m Number of unknowns (the sentinel index)
+ * @param		cut Smallest resistance that is cut
+ *
+ * @return		Partition of every unknown, numbered from 0
+ */
+std::vector<int> partitionUnknowns(const std::vector<StampRecord> &records,
+                                   int m, double cut);
+
+/**
+ * @brief		Solves a system by block Jacobi relaxation over partitions
+ *
+ * Each partition's diagonal block is factorized once. Every sweep then
+ * solves all partitions in parallel against the previous sweep's values of
+ * the others, until the largest change is below relaxationTolerance.
+ *
+ * @param		A m x m system matrix
+ * @param		b Right hand side
+ * @param		partition Partition of every unknown
+ * @param		threads Threads solving the partitions
+ * @param[out]	report Iterations and per partition timing
+ *
+ * @return		Solution after the last sweep
+ */
+Eigen::VectorXd solveRelaxed(const Eigen::SparseMatrix<double> &A,
+                             const Eigen::VectorXd &b,
+                             const std::vector<int> &partition, int threads,
+                             RelaxationReport &report);
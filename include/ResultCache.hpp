@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
+ * Reserved. Permission to use, copy, modify and distribute this software for
+ * educational, research, and not-for-profit purposes, without fee and without a
+ * signed license agreement, is hereby granted, provided that this paragraph and
+ * the following two paragraphs appear in all copies, modifications, and
+ * distributions.
+ *
+ * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
+ * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
+ * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
+ *
+ * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
+ * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+/**
+ * @file ResultCache.hpp
+ *
+ * @brief Contains the on-disk cache of operating point results
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../lib/external/Eigen/Dense"
+#include "Parser.hpp"
+#include "SourceTable.hpp"
+
+/** Size limit of the cache directory when none is given */
+constexpr std::uintmax_t defaultCacheLimit = std::uintmax_t(64) << 20;
+
+/**
+ * @brief		Canonical description of a parsed circuit and its analysis
+ *
+ * One line per element (name, type, nodes, group, exact value, controlling
+ * variable and element), sorted, so that the order of the netlist lines and
+ * its comments and spacing do not change it. The probes, the tabulated
+ * source values, a hash of the contents of every .ROM file and the analysis
+ * options follow.
+ *
+ * @param		parser Parsed netlist, after the parameters are applied
+ * @param		table Source table of the run (empty if none)
+ * @param		analysis Options that change the results
+ *
+ * @return		Description, equal for circuits with equal results
+ */
+std::string describeCircuit(const Parser &parser, const SourceTable &table,
+                            const std::string &analysis);
+
+/**
+ * @class ResultCache
+ *
+ * @brief Directory of results keyed by the hash of their description
+ *
+ * Every entry is one file named after the 64-bit FNV-1a hash of the
+ * description and holds the description itself, so a collision is a miss.
+ * A hit touches the entry; when the entries exceed the size limit the least
+ * recently used ones are removed. Hits, misses and evictions are kept in a
+ * statistics file of the directory.
+ * */
+class ResultCache
+{
+   public:
+    std::string directory;           /**< Directory of the entries */
+    std::uintmax_t limit = 0;        /**< Largest total size of the entries */
+    std::uint64_t hits = 0;          /**< Lookups that found their entry */
+    std::uint64_t misses = 0;        /**< Lookups that did not */
+    std::uint64_t evictions = 0;     /**< Entries removed to fit the limit */
+
+    /**
+     * @brief		Opens (and creates) the cache directory
+     *
+     * @param		path Directory of the cache
+     * @param		sizeLimit Largest total size of the entries in bytes
+     *
+     * @return		number of errors
+     */
+    int open(const std::string &path, std::uintmax_t sizeLimit);
+
+    /**
+     * @brief		Looks up the results of a description
+     *
+     * @param		description Description from describeCircuit()
+     * @param[out]	names Names of the stored outputs
+     * @param[out]	values Stored values, one row per output and one column
+     *per case
+     *
+     * @return		true on a hit
+     */
+    bool lookup(const std::string &description,
+                std::vector<std::string> &names, Eigen::MatrixXd &values);
+
+    /**
+     * @brief		Stores the results of a description, then evicts the
+     *				least recently used entries beyond the limit
+     *
+     * @param		description Description from describeCircuit()
+     * @param		names Names of the outputs
+     * @param		values Values, one row per output and one column per case
+     *
+     * @return		number of errors
+     */
+    int store(const std::string &description,
+              const std::vector<std::string> &names,
+              const Eigen::MatrixXd &values);
+
+    /**
+     * @brief		Prints the entries, their size and the statistics
+     */
+    void printStatistics();
+
+   private:
+    std::string entryPath(const std::string &description) const;
+    void saveStatistics() const;
+};
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
+ * Reserved. Permission to use, copy, modify and distribute this software for
+ * educational, research, and not-for-profit purposes, without fee and without a
+ * signed license agreement, is hereby granted, provided that this paragraph and
+ * the following two paragraphs appear in all copies, modifications, and
+ * distributions.
+ *
+ * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
+ * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
+ * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
+ *
+ * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
+ * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+/**
+ * @file Scratch.hpp
+ *
+ * @brief Contains the scratch files data is spilled to
+ */
+
+#pragma once
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <string>
+
+/**
+ * @class ScratchFile
+ *
+ * @brief Anonymous file of a scratch directory, removed from the directory
+ * at once and from the disk when closed
+ * */
+class ScratchFile
+{
+   public:
+    ScratchFile() = default;
+    ScratchFile(const ScratchFile &) = delete;
+    ScratchFile &operator=(const ScratchFile &) = delete;
+    ~ScratchFile() { close(); }
+
+    /** Creates the file in directory; false on failure */
+    bool open(const std::string &directory);
+
+    /** Closes the file, which removes it */
+    void close();
+
+    /** Writes bytes at an offset; false on failure */
+    bool write(const void *data, std::size_t bytes, std::size_t offset);
+
+    /** Reads bytes at an offset; false on failure */
+    bool read(void *data, std::size_t bytes, std::size_t offset);
+
+    /** File descriptor, -1 if not open */
+    int descriptor() const { return file; }
+
+   private:
+    int file = -1; /**< File descriptor */
+};
+
+/**
+ * @class MappedArray
+ *
+ * @brief Fixed size array of trivially copyable items backed by a scratch
+ * file mapped into memory
+ *
+ * The pages are the file's, so the kernel writes them out and drops them
+ * under memory pressure instead of the process running out of memory.
+ * */
+template <class T>
+class MappedArray
+{
+   public:
+    MappedArray() = default;
+    MappedArray(const MappedArray &) = delete;
+    MappedArray &operator=(const MappedArray &) = delete;
+    ~MappedArray() { release(); }
+
+    /** Maps count zeroed items in a new file of directory; false on
+     * failure */
+    bool create(const std::string &directory, std::size_t count)
+    {
+        release();
+        if (count == 0) return true;
+        if (!file.open(directory) ||
+            ftruncate(file.descriptor(), off_t(count * sizeof(T))) != 0)
+            return false;
+        void *memory =
+            mmap(nullptr, count * sizeof(T), PROT_READ | PROT_WRITE,
+                 MAP_SHARED, file.descriptor(), 0);
+        if (memory == MAP_FAILED) return false;
+        items = static_cast<T *>(memory);
+        this->count = count;
+        return true;
+    }
+
+    T *begin() { return items; }
+    T *end() { return items + count; }
+    T &operator[](std::size_t k) { return items[k]; }
+    std::size_t size() const { return count; }
+
+   private:
+    void release()
+    {
+        if (items != nullptr) munmap(items, count * sizeof(T));
+        file.close();
+        items = nullptr;
+        count = 0;
+    }
+
+    T *items = nullptr;    /**< Mapped items */
+    std::size_t count = 0; /**< Number of items */
+    ScratchFile file;      /**< Backing file */
+};
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
+ * Reserved. Permission to use, copy, modify and distribute this software for
+ * educational, research, and not-for-profit purposes, without fee and without a
+ * signed license agreement, is hereby granted, provided that this paragraph and
+ * the following two paragraphs appear in all copies, modifications, and
+ * distributions.
+ *
+ * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
+ * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
+ * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
+ *
+ * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
+ * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ */
+/**
+ * @file Sensitivity.hpp
+ *
+ * @brief Contains the definition of the adjoint sensitivity analysis
+ *
+ * For an output y = c^T x of the system A x = b, the adjoint A^T w = c gives
+ * dy/dp = w^T (db/dp - dA/dp x) for every element value p at once. Only the
+ * stamp of the element itself depends on p, so each derivative comes from
+ * stamping that one element through a SensitivitySink.
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../lib/external/Eigen/Dense"
+#include "CircuitElement.hpp"
+
+/** @struct Sensitivity
+ *
+ * @brief Derivative of an output with respect to the value of an element
+ * */
+struct Sensitivity
+{
+    std::string element; /**< Name of the element */
+    double derivative;   /**< d(output) / d(value of the element) */
+};
+
+/** @struct SensitivitySink
+ *
+ * @brief Contracts stamps with the adjoint and the solution
+ *
+ * Accumulates w^T (A_e x - b_e) for the stamped entries A_e and b_e. Both
+ * vectors hold a zero at the sentinel index.
+ * */
+struct SensitivitySink
+{
+    const Eigen::VectorXd &adjoint; /**< (m + 1) adjoint solution w */
+    const Eigen::VectorXd &x;       /**< (m + 1) solution */
+    double total = 0.0;             /**< Accumulated w^T (A_e x - b_e) */
+
+    void add(int row, int col, double value)
+    {
+        total += adjoint(row) * value * x(col);
+    }
+    void addRhs(int row, double value) { total -= adjoint(row) * value; }
+};
+
+/**
+ * @brief		Right hand sides of the adjoint systems of the outputs
+ *
+ * An output is an unknown (node voltage or branch current) or an element
+ * whose current is computed after the solve.
+ *
+ * @param		outputs Names of the outputs
+ * @param		indexMap Index map of the solved unknowns
+ * @param		currentProbes Elements whose current is computed after the
+ *				solve
+ * @param[out]	seeds One column c per output, indexMap.size() rows
+ *
+ * @return		Number of outputs that could not be resolved
+ */
+int makeSensitivitySeeds(
+    const std::vector<std::string> &outputs,
+    const std::map<std::string, int> &indexMap,
+    const std::vector<std::shared_ptr<CircuitElement>> &currentProbes,
+    Eigen::MatrixXd &seeds);
+
+/**
+ * @brief		Sensitivities of one output to every element value
+ *
+ * Capacitors and inductors do not change the DC solution and are left out.
+ * Elements that appear more than once (halves of an element bridging two
+ * islands) are summed.
+ *
+ * @param		elements Solved elements
+ * @param		indexMap Index map of the solved unknowns
+ * @param		x Solution
+ * @param		adjoint Adjoint solution of the output
+ * @param		output Name of the output
+ * @param		outputValue Value of the output
+ * @param		currentProbes Elements whose current is computed after the
+ *				solve
+ *
+ * @return		Sensitivities, largest magnitude first
+ */
+std::vector<Sensitivity> computeSensitivities(
+    const std::vector<std::shared_ptr<CircuitElement>> &elements,
+    const std::map<std::string, int> &indexMap, const Eigen::VectorXd &x,
+    const Eigen::VectorXd &adjoint, const std::string &output,
+    double outputValue,
+    const std::vector<std::shared_ptr<CircuitElement>> &currentProbes);
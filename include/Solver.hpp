@@ -17,14 +17,27 @@
  * ENHANCEMENTS, OR MODIFICATIONS.
  */
 #pragma once
+#include <cmath>
 #include <map>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "../lib/external/Eigen/Dense"
-#include "Node.hpp"
+#include "CodeGen.hpp"
+#include "LinearSolver.hpp"
+#include "MatrixMarket.hpp"
+#include "Memory.hpp"
+#include "ModelReduction.hpp"
 #include "Parser.hpp"
+#include "Probe.hpp"
+#include "Reduction.hpp"
+#include "ResultCache.hpp"
+#include "Sensitivity.hpp"
+#include "SourceTable.hpp"
+#include "Stamp.hpp"
+#include "Topology.hpp"
+#include "Waveform.hpp"
 
 /*
  * @file Solver.hpp
@@ -32,6 +45,91 @@
  * @brief Contains the definition of the main functions
  */
 
+/** @struct SolverOptions
+ *
+ * @brief Options given on the command line
+ * */
+struct SolverOptions
+{
+    std::string netlist = "circuit.sns"; /**< Netlist file */
+    bool reduce = false; /**< Runs the topological reduction before solving */
+    bool mixedPrecision = false; /**< Factorizes in single precision and
+                                    refines in double precision */
+    bool sparse = false; /**< Solves the islands with sparse LU, asked for or
+                            picked by the memory plan */
+    std::size_t memLimit = 0; /**< Memory limit in bytes, 0 for none */
+    std::string sourceTable; /**< Solves every case of this table of source
+                                values instead of the netlist values */
+    int threads = 0; /**< Threads of the run, 0 for one per core */
+    int assemblyThreads = 1; /**< Threads assembling the system of one island,
+                                set by solveIslands */
+    std::string exportBase; /**< Writes the assembled system in Matrix Market
+                               format to <exportBase>.* if not empty */
+    std::string replayBase; /**< Benchmarks the solver backends on the system
+                               in <replayBase>.* instead of a netlist */
+    std::vector<std::string> probes; /**< Unknowns to be printed, added to
+                                        the .PROBE/.PRINT ones */
+    std::string waveFile; /**< Waveform file of a .DC sweep, the netlist
+                             name with a .wave extension if empty */
+    double waveTolerance = 0.0; /**< Largest error of a stored sweep value, 0
+                                   stores the values losslessly */
+    std::string readWave; /**< Prints signals of this waveform file instead of
+                             solving a netlist */
+    double windowFrom = -HUGE_VAL; /**< Lower end of the printed sweep */
+    double windowTo = HUGE_VAL;    /**< Upper end of the printed sweep */
+    std::vector<std::pair<std::string, double>>
+        parameters; /**< .PARAM values replacing the netlist ones */
+    int morMoments = 0; /**< Krylov blocks of the reduced models of the
+                           passive subnetworks, 0 keeps them as they are */
+    std::string morSave; /**< File the reduced models are written to */
+    std::string cacheDir; /**< Directory of the result cache, none if empty */
+    std::uintmax_t cacheLimit =
+        defaultCacheLimit;   /**< Size limit of the result cache */
+    bool cacheStats = false; /**< Prints the statistics of the cache */
+    bool equilibrate = false; /**< Scales the rows and columns of the ill
+                                 conditioned systems */
+    bool health = false; /**< Prints the health of every factorization */
+    double relaxCut = 0.0; /**< Solves the partitions left by cutting the
+                              resistors of at least this many ohms by block
+                              relaxation, 0 solves directly */
+    std::string batchTable; /**< Solves every instance of this table of
+                               element values, batched across SIMD lanes */
+    std::string codegenFile; /**< Writes C++ code solving the circuit for
+                                any element values to this file */
+    std::string scratchDir; /**< Lets the memory plan solve out of core, with
+                               the scratch files in this directory */
+    bool outOfCore = false; /**< Solves the islands with their factors on
+                               disk, picked by the memory plan */
+    std::size_t outOfCoreBudget = 0; /**< Bytes of the band window and panel
+                                        of one island solved out of core */
+    int domains = 1; /**< Solves the islands by domain decomposition over
+                        this many worker processes, 1 solves directly */
+};
+
+/**
+ * @brief		Reads the command line arguments into options
+ *
+ * Usage: SNU_Spice [netlist] [--reduce] [--mixed-precision]
+ *                  [--export-mtx base] [--replay base]
+ *                  [--probe name[,name...]] [--wave file]
+ *                  [--wave-tol bound] [--read-wave file]
+ *                  [--window from,to] [--sparse]
+ *                  [--mem-limit size[K|M|G]] [--threads n]
+ *                  [--source-table file] [--param name=value[,...]]
+ *                  [--mor moments] [--mor-save file] [--cache dir]
+ *                  [--cache-limit size[K|M|G]] [--cache-stats]
+ *                  [--relax ohms] [--equilibrate] [--health]
+ *                  [--batch file] [--codegen file] [--scratch dir]
+ *                  [--domains n]
+ *
+ * @param		argc Number of arguments
+ * @param		argv Arguments
+ * @param[out]	options Parsed options
+ *
+ * @return		0 if successful else 1
+ */
+int parseArguments(int argc, char *argv[], SolverOptions &options);
+
 /**
  * @brief		Creates map of nodes and group_2 element to
  *				index position of in MNA and RHS matrices
@@ -57,14 +155,49 @@ void printMNAandRHS(std::vector<std::vector<double>> &mna,
                     std::vector<double> &rhs);
 
 /**
- * @brief		Creates graph from the vector for traversal
+ * @brief		Assembles and solves the system of a single island
  *
- * @param[ref]	nodeMap map<string, shared_ptr<Node>>
- * @param		parser Parser
+ * @param		island Island to be solved
+ * @param		indexMap Created index map from the makeIndexMap
+ * function
+ * @param		options Options given on the command line
+ * @param[out]	X Solution of the whole circuit, the island's unknowns are
+ *written at their indexMap position
+ * @param		seeds Right hand sides of adjoint systems over the whole
+ *circuit, one per column, or nullptr
+ * @param[out]	adjoints Solutions of the adjoint systems, the island's rows
+ *are written with the same factorization as X (in double precision)
+ * @param		table Source values of several cases, or nullptr; X gets
+ *one column per case, solved with one factorization (in double precision)
+ *
+ * @return		How the island's system was solved
+ */
+SolveReport solveIsland(Island &island,
+                        const std::map<std::string, int> &indexMap,
+                        const SolverOptions &options, Eigen::MatrixXd &X,
+                        const Eigen::MatrixXd *seeds = nullptr,
+                        Eigen::MatrixXd *adjoints = nullptr,
+                        const SourceTable *table = nullptr);
+
+/**
+ * @brief		Solves all the valid islands in parallel
+ *
+ * @param		islands Islands created by findIslands
+ * @param		indexMap Created index map from the makeIndexMap
+ * function
+ * @param		options Options given on the command line
+ * @param[out]	X Solution of the whole circuit
+ * @param		seeds Right hand sides of adjoint systems, or nullptr
+ * @param[out]	adjoints Solutions of the adjoint systems
+ * @param		table Source values of several cases, or nullptr
  *
+ * @return		How each island's system was solved, in island order
  */
-void makeGraph(std::map<std::string, std::shared_ptr<Node>> &nodeMap,
-               Parser &parser);
+std::vector<SolveReport> solveIslands(
+    std::vector<Island> &islands, const std::map<std::string, int> &indexMap,
+    const SolverOptions &options, Eigen::MatrixXd &X,
+    const Eigen::MatrixXd *seeds = nullptr,
+    Eigen::MatrixXd *adjoints = nullptr, const SourceTable *table = nullptr);
 
 /**
  * @brief		Print the solution of x along with unknown variables
@@ -75,6 +208,143 @@ void makeGraph(std::map<std::string, std::shared_ptr<Node>> &nodeMap,
  */
 void printxX(std::map<std::string, int> &indexMap, Eigen::MatrixXd &X);
 
+/**
+ * @brief		Selects the unknowns to be printed
+ *
+ * A name probed twice is selected once, at its first position.
+ *
+ * @param		indexMap Index map of the solution
+ * @param		probes Names of the wanted unknowns, empty for all
+ * @param[out]	outputs (name, index) of every selected unknown, in print
+ *				order
+ *
+ * @return		number of probes without a value in the solution
+ */
+int selectOutputs(const std::map<std::string, int> &indexMap,
+                  const std::vector<std::string> &probes,
+                  std::vector<std::pair<std::string, int>> &outputs);
+
+/**
+ * @brief		Print the solution of the selected unknowns
+ *
+ * @param   	outputs Unknowns created by selectOutputs
+ * @param		X Eigen::MatrixXd
+ *
+ */
+void printxX(const std::vector<std::pair<std::string, int>> &outputs,
+             Eigen::MatrixXd &X);
+
+/**
+ * @brief		Assembles the whole circuit into one sparse system and
+ *				writes it in Matrix Market format
+ *
+ * @param		parser Parser holding the circuit elements
+ * @param		indexMap Created index map from the makeIndexMap
+ * function
+ * @param		base Path of the files without extension
+ * @param		threads Threads assembling the system
+ *
+ * @return		0 if successful else 1
+ */
+int exportSystem(Parser &parser, const std::map<std::string, int> &indexMap,
+                 const std::string &base, int threads = 1);
+
+/**
+ * @brief		Loads a system written by exportSystem and times every
+ *				solver backend on it
+ *
+ * @param		base Path of the files without extension
+ *
+ * @return		0 if successful else 1
+ */
+int runReplay(const std::string &base);
+
+/**
+ * @brief		Streams a DC sweep to a waveform file
+ *
+ * The circuit is linear, so every point is the solution at the netlist value
+ * of the source plus a multiple of the response to a change of the source.
+ * Only that response needs one more solve; the points are generated one at
+ * a time and written in compressed chunks.
+ *
+ * @param		sweep Swept source and range
+ * @param		islands Islands of the circuit, the values of the source
+ *				are restored after the call
+ * @param		indexMap Index map of the solved unknowns
+ * @param		reduction Nodes removed by the reduction
+ * @param		currentProbes Elements whose current is computed after the
+ *				solve
+ * @param		options Options of the run
+ * @param		outputs Unknowns to be stored, selected by selectOutputs
+ * @param		X Completed solution at the netlist value of the source
+ *
+ * @return		0 if successful else 1
+ */
+int runSweep(const Sweep &sweep, std::vector<Island> &islands,
+             const std::map<std::string, int> &indexMap,
+             const Reduction &reduction,
+             const std::vector<std::shared_ptr<CircuitElement>> &currentProbes,
+             const SolverOptions &options,
+             const std::vector<std::pair<std::string, int>> &outputs,
+             const Eigen::MatrixXd &X);
+
+/**
+ * @brief		Prints signals of a waveform file
+ *
+ * @param		options Options of the run: the file, the probes (every
+ *				signal if empty) and the window
+ *
+ * @return		0 if successful else 1
+ */
+int runWaveRead(const SolverOptions &options);
+
+/**
+ * @brief		Prints the sensitivities of every .SENS output to every
+ *				element value, largest magnitude first
+ *
+ * @param		outputs Names of the outputs
+ * @param		islands Solved islands
+ * @param		solveMap Index map the systems were solved with
+ * @param		indexMap Index map of the completed solution
+ * @param		currentProbes Elements whose current is computed after the
+ *				solve
+ * @param		X Completed solution
+ * @param		adjoints Adjoint solutions, one column per output
+ */
+void printSensitivities(
+    const std::vector<std::string> &outputs, std::vector<Island> &islands,
+    const std::map<std::string, int> &solveMap,
+    const std::map<std::string, int> &indexMap,
+    const std::vector<std::shared_ptr<CircuitElement>> &currentProbes,
+    const Eigen::MatrixXd &X, const Eigen::MatrixXd &adjoints);
+
+/**
+ * @brief		Reads the source table of the options and checks it
+ *				against the netlist
+ *
+ * A --batch table may hold the values of resistors and controlled sources
+ * too, a --source-table only those of independent sources.
+ *
+ * @param[ref]	options Options of the run, options incompatible with the
+ *table are turned off
+ * @param		parser Parser holding the circuit elements
+ * @param[out]	table Parsed table
+ *
+ * @return		number of errors
+ */
+int loadSourceTable(SolverOptions &options, const Parser &parser,
+                    SourceTable &table);
+
+/**
+ * @brief		Prints the selected unknowns of every case, one case per
+ *				line
+ *
+ * @param		outputs Unknowns created by selectOutputs
+ * @param		X Solution, one column per case
+ */
+void printCases(const std::vector<std::pair<std::string, int>> &outputs,
+                Eigen::MatrixXd &X);
+
 /**
  * @brief		Runs the solver
  * The function contains the entire functionality to run the solver
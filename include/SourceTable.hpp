@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
+ * Reserved. Permission to use, copy, modify and distribute this software for
+ * educational, research, and not-for-profit purposes, without fee and without a
+ * signed license agreement, is hereby granted, provided that this paragraph and
+ * the following two paragraphs appear in all copies, modifications, and
+ * distributions.
+ *
+ * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
+ * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
+ * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
+ *
+ * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
+ * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ */
+/**
+ * @file SourceTable.hpp
+ *
+ * @brief Contains the definition of the source value tables solved as one
+ * multi-RHS system
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../lib/external/Eigen/Dense"
+#include "CircuitElement.hpp"
+
+/** @struct SourceTable
+ *
+ * @brief Values of independent sources for several solves of one circuit
+ * */
+struct SourceTable
+{
+    std::vector<std::string> sources; /**< Names of the tabulated sources */
+    Eigen::MatrixXd values; /**< One row per case, one column per source */
+};
+
+/**
+ * @brief		Reads a source table
+ *
+ * The first line holds the source names, each at most once, every other line
+ * the values of one case, separated by spaces, tabs or commas. Values take
+ * the engineering multipliers of the netlist. Lines starting with % are
+ * comments.
+ *
+ * @param		file Path of the table
+ * @param[out]	table Parsed table
+ *
+ * @return		number of errors in the table
+ */
+int parseSourceTable(const std::string &file, SourceTable &table);
+
+/**
+ * @brief		Right hand sides of every case of the table
+ *
+ * The RHS is linear in the source values, so the RHS of the netlist values
+ * is corrected by the unit RHS of each tabulated source times the change of
+ * its value: B = b 1^T + U (V - 1 v^T)^T, one matrix product for all cases.
+ *
+ * @param		table Source table
+ * @param		elements Elements of the system
+ * @param		indexMap Index map of the system
+ * @param		rhs (m + 1) RHS of the netlist values
+ *
+ * @return		(m + 1) x cases RHS matrix
+ */
+Eigen::MatrixXd makeTableRhs(
+    const SourceTable &table,
+    const std::vector<std::shared_ptr<CircuitElement>> &elements,
+    const std::map<std::string, int> &indexMap, const Eigen::VectorXd &rhs);
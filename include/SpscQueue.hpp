@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
+ * Reserved. Permission to use, copy, modify and distribute this software for
+ * educational, research, and not-for-profit purposes, without fee and without a
+ * signed license agreement, is hereby granted, provided that this paragraph and
+ * the following two paragraphs appear in all copies, modifications, and
+ * distributions.
+ *
+ * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
+ * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
+ * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
+ *
+ * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
+ * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+/**
+ * @file SpscQueue.hpp
+ *
+ * @brief Contains the bounded queue connecting two pipeline stages
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * @class SpscQueue
+ *
+ * @brief Bounded lock-free queue between one producer and one consumer
+ *
+ * A ring of capacity + 1 slots: only the producer moves the tail and only
+ * the consumer moves the head, so neither side takes a lock. A side that
+ * finds the queue full (or empty) yields a few times, then sleeps between
+ * checks so that it does not take the core from the other side.
+ * */
+template <class T>
+class SpscQueue
+{
+   public:
+    /** Queue of at most capacity items */
+    explicit SpscQueue(size_t capacity) : slots(capacity + 1) {}
+
+    /** Appends an item, waiting while the queue is full */
+    void push(T item)
+    {
+        size_t tail = this->tail.load(std::memory_order_relaxed);
+        size_t next = (tail + 1) % slots.size();
+        for (int spins = 0; next == head.load(std::memory_order_acquire);)
+            wait(spins);
+        slots[tail] = std::move(item);
+        this->tail.store(next, std::memory_order_release);
+    }
+
+    /** Marks the end of the items, called by the producer after its last
+     * push */
+    void close() { closed.store(true, std::memory_order_release); }
+
+    /** Removes the oldest item, waiting while the queue is empty; false once
+     * the queue is closed and empty */
+    bool pop(T &item)
+    {
+        size_t head = this->head.load(std::memory_order_relaxed);
+        for (int spins = 0; head == tail.load(std::memory_order_acquire);) {
+            // The last push happens before close, so a closed queue that
+            // still looks empty is empty
+            if (closed.load(std::memory_order_acquire) &&
+                head == tail.load(std::memory_order_acquire))
+                return false;
+            wait(spins);
+        }
+        item = std::move(slots[head]);
+        this->head.store((head + 1) % slots.size(), std::memory_order_release);
+        return true;
+    }
+
+   private:
+    static void wait(int &spins)
+    {
+        if (++spins < 64)
+            std::this_thread::yield();
+        else
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+
+    std::vector<T> slots;                 /**< Ring of items */
+    alignas(64) std::atomic<size_t> head{0}; /**< Next item to pop */
+    alignas(64) std::atomic<size_t> tail{0}; /**< Next slot to push to */
+    std::atomic<bool> closed{false};      /**< No more items will be pushed */
+};
@@ -0,0 +1,314 @@
+/*
+ * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
+ * Reserved. Permission to use, copy, modify and distribute this software for
+ * educational, research, and not-for-profit purposes, without fee and without a
+ * signed license agreement, is hereby granted, provided that this paragraph and
+ * the following two paragraphs appear in all copies, modifications, and
+ * distributions.
+ *
+ * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
+ * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
+ * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
+ *
+ * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
+ * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+/**
+ * @file Stamp.hpp
+ *
+ * @brief Contains the element stamp kernels used to assemble the MNA system
+ */
+
+#pragma once
+
+#include <array>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../lib/external/Eigen/Dense"
+#include "../lib/external/Eigen/Sparse"
+#include "CircuitElement.hpp"
+
+/** @struct StampRecord
+ *
+ * @brief A circuit element resolved to the matrix indices it stamps
+ *
+ * Every index that refers to ground holds the sentinel index, which is one
+ * past the last unknown. The sinks allocate one extra row and column for it,
+ * so the kernels never need to test for ground.
+ * */
+struct StampRecord
+{
+    int kernel;   /**< Position of the element's kernel in the kernel table */
+    int a;        /**< Index of nodeA */
+    int b;        /**< Index of nodeB */
+    int branch;   /**< Index of the element's own branch current */
+    int ca;       /**< Index of the controlling element's nodeA */
+    int cb;       /**< Index of the controlling element's nodeB */
+    int cbranch;  /**< Index of the controlling element's branch current */
+    double value; /**< Value of the element (or scale factor) */
+};
+
+/** @struct DenseSink
+ *
+ * @brief Accumulates stamps into a dense MNA matrix and RHS vector
+ * */
+struct DenseSink
+{
+    Eigen::MatrixXd &mna; /**< (m + 1) x (m + 1) MNA matrix */
+    Eigen::VectorXd &rhs; /**< (m + 1) RHS vector */
+
+    void add(int row, int col, double value) { mna(row, col) += value; }
+    void addRhs(int row, double value) { rhs(row) += value; }
+};
+
+/** @struct TripletSink
+ *
+ * @brief Accumulates stamps as (row, column, value) triplets
+ *
+ * Triplets in the sentinel row or column are kept, they are dropped when the
+ * triplets are turned into a matrix (see assembleSparse()).
+ * */
+struct TripletSink
+{
+    std::vector<Eigen::Triplet<double>> &triplets; /**< Stamped entries */
+    Eigen::VectorXd &rhs; /**< (m + 1) RHS vector */
+
+    void add(int row, int col, double value)
+    {
+        triplets.emplace_back(row, col, value);
+    }
+    void addRhs(int row, double value) { rhs(row) += value; }
+};
+
+/** @struct RhsSink
+ *
+ * @brief Accumulates only the RHS of the stamps
+ * */
+struct RhsSink
+{
+    Eigen::Ref<Eigen::VectorXd> rhs; /**< (m + 1) RHS vector */
+
+    void add(int, int, double) {}
+    void addRhs(int row, double value) { rhs(row) += value; }
+};
+
+/** @struct ResidualSink
+ *
+ * @brief Accumulates the residual b - Ax of the stamps without storing A
+ * */
+struct ResidualSink
+{
+    const Eigen::VectorXd &x;  /**< (m + 1) solution, zero at the sentinel */
+    Eigen::VectorXd &residual; /**< (m + 1) residual b - Ax */
+
+    void add(int row, int col, double value)
+    {
+        residual(row) -= value * x(col);
+    }
+    void addRhs(int row, double value) { residual(row) += value; }
+};
+
+/**
+ * @brief		Position of the kernel for a (Component, Group,
+ *				ControlVariable) combination in the kernel table
+ */
+constexpr int kernelIndex(Component type, Group group,
+                          ControlVariable controlling_variable)
+{
+    return (int(type) * 2 + int(group)) * 3 + int(controlling_variable);
+}
+
+/** Number of entries in the kernel table */
+constexpr int kernelCount = kernelIndex(L, G2, i) + 1;
+
+/**
+ * @brief		Stamps a batch of elements that share the same kernel
+ *
+ * This is the only place that knows the stamp of each element type.
+ * Combinations that no element can have (e.g. a group 1 voltage source)
+ * stamp nothing.
+ *
+ * @param		record First record of the batch
+ * @param		end One past the last record of the batch
+ * @param[out]	sink Matrix and RHS the stamps are added to
+ */
+template <class Sink, Component type, Group group,
+          ControlVariable controlling_variable>
+void stampBatch(const StampRecord *record, const StampRecord *end, Sink &sink)
+{
+    for (; record != end; record++) {
+        const int a = record->a, b = record->b, k = record->branch;
+        const double value = record->value;
+
+        // Resistor
+        if constexpr (type == R && group == G1) {
+            sink.add(a, a, 1.0 / value);
+            sink.add(a, b, -1.0 / value);
+            sink.add(b, a, -1.0 / value);
+            sink.add(b, b, 1.0 / value);
+        } else if constexpr (type == R && group == G2) {
+            sink.add(a, k, 1.0);
+            sink.add(b, k, -1.0);
+            sink.add(k, a, 1.0);
+            sink.add(k, b, -1.0);
+            sink.add(k, k, -value);
+        }
+        // Capacitor (open circuit, its current is zero)
+        else if constexpr (type == C && group == G2) {
+            sink.add(k, k, 1.0);
+        }
+        // Independent Current Source
+        else if constexpr (type == I && group == G1) {
+            sink.addRhs(a, -value);
+            sink.addRhs(b, value);
+        } else if constexpr (type == I && group == G2) {
+            sink.add(a, k, 1.0);
+            sink.add(b, k, -1.0);
+            sink.add(k, k, 1.0);
+            sink.addRhs(k, value);
+        }
+        // Inductor, Independent and Dependent Voltage Source (always Group 2)
+        else if constexpr ((type == L || type == V || type == Vc) &&
+                           group == G2) {
+            sink.add(a, k, 1.0);
+            sink.add(b, k, -1.0);
+            sink.add(k, a, 1.0);
+            sink.add(k, b, -1.0);
+
+            if constexpr (type == V) sink.addRhs(k, value);
+            // Current Controlled Voltage Source (CCVS)
+            if constexpr (type == Vc && controlling_variable == i)
+                sink.add(k, record->cbranch, -value);
+            // Voltage Controlled Voltage Source (VCVS)
+            if constexpr (type == Vc && controlling_variable == v) {
+                sink.add(k, record->ca, -value);
+                sink.add(k, record->cb, value);
+            }
+        }
+        // Current Controlled Current Source (CCCS)
+        else if constexpr (type == Ic && group == G1 &&
+                           controlling_variable == i) {
+            sink.add(a, record->cbranch, value);
+            sink.add(b, record->cbranch, -value);
+        }
+        // Voltage Controlled Current Source (VCCS)
+        else if constexpr (type == Ic && group == G1 &&
+                           controlling_variable == v) {
+            sink.add(a, record->ca, value);
+            sink.add(a, record->cb, -value);
+            sink.add(b, record->ca, -value);
+            sink.add(b, record->cb, value);
+        }
+    }
+}
+
+/** Function pointer type of an entry in the kernel table */
+template <class Sink>
+using StampKernel = void (*)(const StampRecord *, const StampRecord *,
+                             Sink &);
+
+template <class Sink, size_t... index>
+constexpr std::array<StampKernel<Sink>, sizeof...(index)> makeKernelTable(
+    std::index_sequence<index...>)
+{
+    return {&stampBatch<Sink, Component(index / 6), Group(index / 3 % 2),
+                        ControlVariable(index % 3)>...};
+}
+
+/** Kernel table, indexed by kernelIndex() */
+template <class Sink>
+constexpr std::array<StampKernel<Sink>, kernelCount> kernelTable =
+    makeKernelTable<Sink>(std::make_index_sequence<kernelCount>());
+
+/**
+ * @brief		Resolves one element to its stamp record
+ *
+ * @param		element Element to be stamped
+ * @param		indexMap Index of every unknown; names that are not in
+ *the map (ground) get the sentinel index indexMap.size()
+ *
+ * @return		Record of the element
+ */
+StampRecord makeStampRecord(const CircuitElement &element,
+                            const std::map<std::string, int> &indexMap);
+
+/**
+ * @brief		Resolves the elements to stamp records, sorted by kernel
+ *
+ * @param		circuitElements Elements to be stamped
+ * @param		indexMap Index of every unknown; names that are not in
+ *the map (ground) get the sentinel index indexMap.size()
+ *
+ * @return		Records grouped by kernel
+ */
+std::vector<StampRecord> makeStampRecords(
+    const std::vector<std::shared_ptr<CircuitElement>> &circuitElements,
+    const std::map<std::string, int> &indexMap);
+
+/**
+ * @brief		Stamps a range of records batch by batch through the kernel
+ *				table
+ *
+ * @param		begin First record, from makeStampRecords
+ * @param		end One past the last record
+ * @param[out]	sink Matrix and RHS the stamps are added to
+ */
+template <class Sink>
+void stampRecords(const StampRecord *begin, const StampRecord *end,
+                  Sink &sink)
+{
+    while (begin != end) {
+        const StampRecord *batchEnd = begin;
+        while (batchEnd != end && batchEnd->kernel == begin->kernel)
+            batchEnd++;
+        kernelTable<Sink>[begin->kernel](begin, batchEnd, sink);
+        begin = batchEnd;
+    }
+}
+
+/**
+ * @brief		Stamps all the records batch by batch through the kernel
+ *				table
+ *
+ * @param		records Records created by makeStampRecords
+ * @param[out]	sink Matrix and RHS the stamps are added to
+ */
+template <class Sink>
+void stampRecords(const std::vector<StampRecord> &records, Sink &sink)
+{
+    stampRecords(records.data(), records.data() + records.size(), sink);
+}
+
+/** Fewest records a thread is given by assembleSparse */
+constexpr size_t assemblyGrain = 4096;
+
+/**
+ * @brief		Stamps the records into a sparse matrix with several threads
+ *
+ * Every thread stamps a contiguous range of the records into its own triplet
+ * buffer and RHS. The buffers are then scattered into columns, and every
+ * column is sorted by row with its duplicates summed. Each step is split
+ * across the threads, and the compressed column matrix is written in
+ * place, without a shared setFromTriplets.
+ *
+ * The duplicates are summed in record order, so the matrix does not depend
+ * on the thread count. The RHS is summed per thread, so a row fed by the
+ * records of several threads may differ in its last bits.
+ *
+ * @param		records Records created by makeStampRecords
+ * @param		m Number of unknowns (the sentinel index)
+ * @param		threads Threads to use, fewer for small circuits
+ * @param[out]	A m x m sparse MNA matrix
+ * @param[out]	rhs (m + 1) RHS vector
+ */
+void assembleSparse(const std::vector<StampRecord> &records, int m,
+                    int threads, Eigen::SparseMatrix<double> &A,
+                    Eigen::VectorXd &rhs);
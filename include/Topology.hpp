@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
+ * Reserved. Permission to use, copy, modify and distribute this software for
+ * educational, research, and not-for-profit purposes, without fee and without a
+ * signed license agreement, is hereby granted, provided that this paragraph and
+ * the following two paragraphs appear in all copies, modifications, and
+ * distributions.
+ *
+ * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
+ * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
+ * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
+ *
+ * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
+ * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+/**
+ * @file Topology.hpp
+ *
+ * @brief Contains the definition of the topology pass over the circuit graph
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "CircuitElement.hpp"
+#include "CircuitTable.hpp"
+#include "Graph.hpp"
+
+/** @struct Island
+ *
+ * @brief A connected component of the circuit that can be solved on its own
+ *
+ * Two nodes belong to the same island when an element stamps both of them
+ * into the MNA matrix, or when a controlled source refers to an element of the
+ * other one. Ground is the common reference and does not join islands.
+ * */
+struct Island
+{
+    std::vector<std::string> nodes; /**< Non ground nodes of the island */
+    std::vector<std::shared_ptr<CircuitElement>>
+        elements; /**< Elements to be stamped into the island's system */
+    CircuitTable circuit; /**< The same elements column by column, the store
+                             the island's system is stamped from */
+    bool valid;   /**< False if the island has a floating node or a loop of
+                     voltage defining elements */
+};
+
+/**
+ * @brief		Splits the circuit graph into islands and validates each
+ *				of them
+ *
+ * Floating nodes (no DC path to ground through R, V, Vc or L) and loops
+ * formed only by V, Vc and L elements are reported as errors, and the island
+ * containing them is marked invalid.
+ *
+ * @param		graph Graph created by makeGraph
+ * @param		indexMap Map created by makeIndexMap
+ * @param[out]	islands Islands found in the circuit
+ *
+ * @return		number of invalid islands
+ */
+int findIslands(const Graph &graph, std::map<std::string, int> &indexMap,
+                std::vector<Island> &islands);
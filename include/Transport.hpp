@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
+ * Reserved. Permission to use, copy, modify and distribute this software for
+ * educational, research, and not-for-profit purposes, without fee and without a
+ * signed license agreement, is hereby granted, provided that this paragraph and
+ * the following two paragraphs appear in all copies, modifications, and
+ * distributions.
+ *
+ * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
+ * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
+ * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
+ *
+ * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
+ * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+/**
+ * @file Transport.hpp
+ *
+ * @brief Contains the transport between the processes of a solve
+ */
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+/**
+ * @class Transport
+ *
+ * @brief Messages and a shared window between a coordinator (rank 0) and
+ * its workers (ranks 1 to n)
+ *
+ * Every rank may read and write the window. Writes to it are seen by a rank
+ * once it has received a message sent after them, as with the fences of an
+ * MPI window, so a transport between machines can keep the same protocol.
+ * */
+class Transport
+{
+   public:
+    virtual ~Transport() = default;
+
+    /**
+     * @brief		Starts the workers, the caller goes on as rank 0
+     *
+     * @param		workers Number of workers
+     * @param		windowSize Doubles of the shared window
+     * @param		work Run by every worker with its rank, returns its
+     *exit status
+     *
+     * @return		false if the workers could not be started
+     */
+    virtual bool start(int workers, std::size_t windowSize,
+                       const std::function<int(int)> &work) = 0;
+
+    /** Shared window of doubles */
+    virtual double *window() = 0;
+
+    /** Sends a message to a rank; false on failure */
+    virtual bool send(int rank, const std::vector<double> &message) = 0;
+
+    /** Receives the next message of a rank; false on failure */
+    virtual bool receive(int rank, std::vector<double> &message) = 0;
+
+    /** Waits for the workers; false if any of them failed */
+    virtual bool finish() = 0;
+};
+
+/**
+ * @class LocalTransport
+ *
+ * @brief Transport between processes of one machine
+ *
+ * The workers are forked, the window is an anonymous shared mapping made
+ * before the fork, and every worker talks to the coordinator over its own
+ * Unix socket pair.
+ * */
+class LocalTransport : public Transport
+{
+   public:
+    LocalTransport() = default;
+    LocalTransport(const LocalTransport &) = delete;
+    LocalTransport &operator=(const LocalTransport &) = delete;
+    ~LocalTransport() override;
+
+    bool start(int workers, std::size_t windowSize,
+               const std::function<int(int)> &work) override;
+    double *window() override { return shared; }
+    bool send(int rank, const std::vector<double> &message) override;
+    bool receive(int rank, std::vector<double> &message) override;
+    bool finish() override;
+
+   private:
+    std::vector<int> sockets;  /**< Socket to every rank, -1 for none */
+    std::vector<pid_t> pids;   /**< Process of every worker */
+    double *shared = nullptr;  /**< Shared window */
+    std::size_t sharedSize = 0; /**< Doubles of the window */
+};
@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
+ * Reserved. Permission to use, copy, modify and distribute this software for
+ * educational, research, and not-for-profit purposes, without fee and without a
+ * signed license agreement, is hereby granted, provided that this paragraph and
+ * the following two paragraphs appear in all copies, modifications, and
+ * distributions.
+ *
+ * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
+ * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
+ * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
+ *
+ * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
+ * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ */
+/**
+ * @file Waveform.hpp
+ *
+ * @brief Contains the definition of the compressed, chunked waveform file
+ * used for results with many points per unknown
+ *
+ * Layout of a waveform file:
+ * - header: magic, version, chunk length, quantization bound, name of the
+ *   axis and of every signal
+ * - chunks: for every chunk of up to chunkPoints points, the axis column
+ *   followed by one column per signal, each encoded on its own
+ * - index: first point, number of points, axis range and the offset and size
+ *   of every column of every chunk
+ * - trailer: offset of the index and a second magic
+ *
+ * A column is stored as zigzag varints of the differences between every
+ * value and the linear extrapolation of the two before it: differences of
+ * the bit patterns of the doubles when lossless, of the values rounded to
+ * multiples of twice the bound when quantized. Numbers are in the byte
+ * order of the machine that wrote the file.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "../lib/external/Eigen/Dense"
+
+/** Points per chunk used when none is given */
+constexpr int waveformChunkPoints = 1024;
+
+/** @struct WaveformChunk
+ *
+ * @brief Index entry of one chunk
+ * */
+struct WaveformChunk
+{
+    std::uint64_t firstPoint = 0; /**< Number of the first point */
+    std::uint32_t points = 0;     /**< Points in the chunk */
+    double axisMin = 0.0;         /**< Smallest axis value in the chunk */
+    double axisMax = 0.0;         /**< Largest axis value in the chunk */
+    std::vector<std::uint64_t> offset; /**< File offset of every column, the
+                                          axis first */
+    std::vector<std::uint32_t> bytes;  /**< Encoded size of every column */
+};
+
+/**
+ * @class WaveformWriter
+ *
+ * @brief Streams points to a waveform file, one chunk at a time
+ *
+ * Only the current chunk and the index are kept in memory.
+ * */
+class WaveformWriter
+{
+   public:
+    /**
+     * @brief		Creates the file and writes its header
+     *
+     * @param		file Path of the waveform file
+     * @param		axis Name of the swept quantity
+     * @param		names Name of every signal, in the order of append
+     * @param		tolerance Largest error allowed on a signal value, 0
+     *				for lossless storage
+     * @param		chunkPoints Points per chunk
+     *
+     * @return		0 if successful else 1
+     */
+    int open(const std::string &file, const std::string &axis,
+             const std::vector<std::string> &names, double tolerance = 0.0,
+             int chunkPoints = waveformChunkPoints);
+
+    /**
+     * @brief		Adds one point, writing the chunk once it is full
+     *
+     * @param		axisValue Value of the swept quantity
+     * @param		values Value of every signal
+     */
+    void append(double axisValue, const Eigen::VectorXd &values);
+
+    /**
+     * @brief		Writes the last chunk, the index and the trailer
+     *
+     * @return		0 if successful else 1
+     */
+    int close();
+
+    std::uint64_t points() const { return total; } /**< Points appended */
+    std::uint64_t bytes() const { return written; } /**< Size of the file */
+
+   private:
+    void flush();
+
+    std::ofstream stream;
+    int signals = 0;
+    int chunkPoints = waveformChunkPoints;
+    double tolerance = 0.0;
+    Eigen::MatrixXd buffer; /**< Current chunk, one column per signal and
+                               the axis in column 0 */
+    int buffered = 0;
+    std::uint64_t total = 0;
+    std::uint64_t written = 0;
+    std::vector<WaveformChunk> index;
+};
+
+/**
+ * @class WaveformReader
+ *
+ * @brief Reads single signals of a waveform file
+ *
+ * Only the index is loaded; a read decodes the columns of the requested
+ * signal in the chunks that overlap the requested axis window.
+ * */
+class WaveformReader
+{
+   public:
+    /**
+     * @brief		Opens the file and loads its header and index
+     *
+     * @param		file Path of the waveform file
+     *
+     * @return		0 if successful else 1
+     */
+    int open(const std::string &file);
+
+    /**
+     * @brief		Reads one signal inside an axis window
+     *
+     * @param		name Name of the signal
+     * @param		from Lower end of the axis window
+     * @param		to Upper end of the axis window
+     * @param[out]	axisValues Axis value of every point read
+     * @param[out]	values Signal value of every point read
+     *
+     * @return		0 if successful else 1
+     */
+    int read(const std::string &name, double from, double to,
+             std::vector<double> &axisValues, std::vector<double> &values);
+
+    std::string axis;               /**< Name of the swept quantity */
+    std::vector<std::string> names; /**< Name of every signal */
+    double tolerance = 0.0;         /**< Quantization bound, 0 if lossless */
+    std::uint64_t points = 0;       /**< Points in the file */
+    std::vector<WaveformChunk> index; /**< One entry per chunk */
+
+   private:
+    std::ifstream stream;
+};
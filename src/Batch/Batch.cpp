@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
+ * Reserved. Permission to use, copy, modify and distribute this software for
+ * educational, research, and not-for-profit purposes, without fee and without a
+ * signed license agreement, is hereby granted, provided that this paragraph and
+ * the following two paragraphs appear in all copies, modifications, and
+ * distributions.
+ *
+ * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
+ * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
+ * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
+ *
+ * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
+ * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+/**
+ * @file Batch.cpp
+ *
+ * @brief Contains the implementation of the batched solver
+ */
+
+#include "../../include/Batch.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "../../include/Stamp.hpp"
+
+/** One entry of the systems of all lanes */
+using Lane = Eigen::Array<double, batchLanes, 1>;
+
+/** Entries of a batch, row major */
+using Lanes = std::vector<Lane, Eigen::aligned_allocator<Lane>>;
+
+/** @struct LaneSink
+ *
+ * @brief Accumulates the stamps of one instance into its lane of a batch,
+ * rows in the static pivoting order
+ * */
+struct LaneSink
+{
+    Lanes &A; /**< (m + 1) x (m + 1) entries */
+    Lanes &b; /**< (m + 1) RHS entries */
+    const std::vector<int> &order; /**< Batch row of every system row */
+    int stride;                    /**< m + 1 */
+    int lane;                      /**< Lane of the instance */
+
+    void add(int row, int col, double value)
+    {
+        A[order[row] * stride + col](lane) += value;
+    }
+    void addRhs(int row, double value) { b[order[row]](lane) += value; }
+};
+
+// Factorizes the N x N systems of all lanes without pivoting and solves
+// them in place of b. worst is the smallest ratio of every lane between a
+// pivot and the largest entry of its column that partial pivoting would have
+// chosen from.
+template <int N>
+static void solveLanes(Lane *A, Lane *b, Lane &worst)
+{
+    constexpr int stride = N + 1;
+    worst.setConstant(HUGE_VAL);
+    for (int k = 0; k < N; k++) {
+        const Lane pivot = A[k * stride + k];
+        Lane largest = pivot.abs();
+        for (int i = k + 1; i < N; i++)
+            largest = largest.max(A[i * stride + k].abs());
+        worst = worst.min(pivot.abs() / largest);
+        const Lane inverse = pivot.inverse();
+        for (int i = k + 1; i < N; i++) {
+            // Every instance has the zeros of the common structure
+            if ((A[i * stride + k] == 0.0).all()) continue;
+            const Lane factor = A[i * stride + k] * inverse;
+            for (int j = k + 1; j < N; j++)
+                A[i * stride + j] -= factor * A[k * stride + j];
+            b[i] -= factor * b[k];
+        }
+    }
+    for (int k = N - 1; k >= 0; k--) {
+        Lane sum = b[k];
+        for (int j = k + 1; j < N; j++) sum -= A[k * stride + j] * b[j];
+        b[k] = sum / A[k * stride + k];
+    }
+}
+
+/** Function pointer type of a fixed size kernel */
+using LaneKernel = void (*)(Lane *, Lane *, Lane &);
+
+template <size_t... size>
+constexpr std::array<LaneKernel, sizeof...(size)> makeLaneKernels(
+    std::index_sequence<size...>)
+{
+    return {&solveLanes<int(size)>...};
+}
+
+/** Fixed size kernels, indexed by the number of unknowns */
+static constexpr std::array<LaneKernel, batchUnknowns + 1> laneKernels =
+    makeLaneKernels(std::make_index_sequence<batchUnknowns + 1>());
+
+// Runs worker on threads threads, at most one per task
+template <class Worker>
+static void runWorkers(int threads, int tasks, Worker worker)
+{
+    std::vector<std::thread> pool;
+    for (int t = 1; t < std::min(threads, tasks); t++)
+        pool.emplace_back(worker);
+    worker();
+    for (std::thread &thread : pool) thread.join();
+}
+
+Eigen::MatrixXd solveBatch(const std::vector<StampRecord> &fixed,
+                           const std::vector<StampRecord> &varying,
+                           const std::vector<int> &columns,
+                           const Eigen::MatrixXd &values, int m, int threads,
+                           BatchReport &report)
+{
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    auto elapsed = [&]() {
+        return std::chrono::duration<double, std::milli>(
+                   std::chrono::steady_clock::now() - start)
+            .count();
+    };
+    int instances = int(values.rows());
+    report.instances = instances;
+    report.fixedSize = m <= batchUnknowns;
+    Eigen::MatrixXd X(m, instances);
+
+    // Stamps of the elements common to all instances
+    Eigen::MatrixXd fixedA = Eigen::MatrixXd::Zero(m + 1, m + 1);
+    Eigen::VectorXd fixedB = Eigen::VectorXd::Zero(m + 1);
+    DenseSink fixedSink{fixedA, fixedB};
+    stampRecords(fixed, fixedSink);
+
+    // An instance on its own, with partial pivoting
+    auto solveInstance = [&](int instance, std::vector<StampRecord> &records) {
+        for (size_t k = 0; k < records.size(); k++)
+            records[k].value = values(instance, columns[k]);
+        Eigen::MatrixXd A = fixedA;
+        Eigen::VectorXd b = fixedB;
+        DenseSink sink{A, b};
+        stampRecords(records, sink);
+        X.col(instance) =
+            A.topLeftCorner(m, m).partialPivLu().solve(b.head(m));
+    };
+
+    std::atomic<int> next(0);
+    if (!report.fixedSize) {
+        runWorkers(threads, instances, [&]() {
+            std::vector<StampRecord> records = varying;
+            for (int instance = next++; instance < instances;
+                 instance = next++)
+                solveInstance(instance, records);
+        });
+        report.time = elapsed();
+        return X;
+    }
+
+    // Static row order: partial pivoting of the netlist values
+    Eigen::MatrixXd nominal = fixedA;
+    Eigen::VectorXd rhs = fixedB;
+    DenseSink sink{nominal, rhs};
+    stampRecords(varying, sink);
+    Eigen::PartialPivLU<Eigen::MatrixXd> lu(nominal.topLeftCorner(m, m));
+    std::vector<int> order(m + 1, m);
+    for (int k = 0; k < m; k++) order[k] = lu.permutationP().indices()(k);
+
+    // Common stamps broadcast to every lane
+    int stride = m + 1;
+    Lanes baseA(stride * stride, Lane::Zero());
+    Lanes baseB(stride, Lane::Zero());
+    for (int row = 0; row <= m; row++) {
+        for (int col = 0; col <= m; col++)
+            baseA[order[row] * stride + col] = Lane::Constant(fixedA(row, col));
+        baseB[order[row]] = Lane::Constant(fixedB(row));
+    }
+
+    LaneKernel kernel = laneKernels[m];
+    int tasks = (instances + batchLanes - 1) / batchLanes;
+    std::atomic<int> repivoted(0);
+    runWorkers(threads, tasks, [&]() {
+        std::vector<StampRecord> records = varying;
+        Lanes A, b;
+        Lane worst;
+        for (int task = next++; task < tasks; task = next++) {
+            int first = task * batchLanes;
+            int count = std::min(batchLanes, instances - first);
+            A = baseA;
+            b = baseB;
+            for (int lane = 0; lane < batchLanes; lane++) {
+                // Lanes past the last instance repeat it
+                int instance = first + std::min(lane, count - 1);
+                for (size_t k = 0; k < records.size(); k++)
+                    records[k].value = values(instance, columns[k]);
+                LaneSink sink{A, b, order, stride, lane};
+                stampRecords(records, sink);
+            }
+            kernel(A.data(), b.data(), worst);
+
+            for (int lane = 0; lane < count; lane++) {
+                if (worst(lane) >= batchPivotTolerance) {
+                    for (int k = 0; k < m; k++)
+                        X(k, first + lane) = b[k](lane);
+                } else {
+                    solveInstance(first + lane, records);
+                    repivoted++;
+                }
+            }
+        }
+    });
+
+    report.repivoted = repivoted;
+    report.time = elapsed();
+    return X;
+}
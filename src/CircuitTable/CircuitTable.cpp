@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
+ * Reserved. Permission to use, copy, modify and distribute this software for
+ * educational, research, and not-for-profit purposes, without fee and without a
+ * signed license agreement, is hereby granted, provided that this paragraph and
+ * the following two paragraphs appear in all copies, modifications, and
+ * distributions.
+ *
+ * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
+ * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
+ * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
+ *
+ * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
+ * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+/**
+ * @file CircuitTable.cpp
+ *
+ * @brief Contains the implementation of the columnar element store
+ */
+
+#include "../../include/CircuitTable.hpp"
+
+#include <array>
+
+CircuitTable makeCircuitTable(
+    const std::vector<std::shared_ptr<CircuitElement>> &circuitElements)
+{
+    CircuitTable circuit;
+    circuit.nodes.push_back("0");
+    std::map<std::string, int> nodeOf{{"0", 0}};
+    auto node = [&](const std::string &name) {
+        auto inserted = nodeOf.emplace(name, int(circuit.nodes.size()));
+        if (inserted.second) circuit.nodes.push_back(name);
+        return inserted.first->second;
+    };
+
+    // Rows are found by element rather than by name, so that a controller
+    // reads the nodes of the controlling element itself and not those of a
+    // half of it split across islands
+    std::vector<const CircuitElement *> rows;
+    std::map<const CircuitElement *, int> rowOf;
+    for (const std::shared_ptr<CircuitElement> &element : circuitElements) {
+        rowOf.emplace(element.get(), int(rows.size()));
+        rows.push_back(element.get());
+    }
+    circuit.count = int(rows.size());
+
+    // Controlling elements outside the table are appended as reference rows
+    for (int r = 0; r < circuit.count; r++) {
+        const CircuitElement &element = *rows[r];
+        if (element.controlling_variable == none) continue;
+        if (rowOf.emplace(element.controlling_element.get(), int(rows.size()))
+                .second)
+            rows.push_back(element.controlling_element.get());
+    }
+
+    size_t size = rows.size();
+    circuit.type.resize(size);
+    circuit.group.resize(size);
+    circuit.control.resize(size);
+    circuit.nodeA.resize(size);
+    circuit.nodeB.resize(size);
+    circuit.controller.resize(size);
+    circuit.value.resize(size);
+    circuit.names.resize(size);
+    for (size_t r = 0; r < size; r++) {
+        const CircuitElement &element = *rows[r];
+        circuit.type[r] = std::uint8_t(element.type);
+        circuit.group[r] = std::uint8_t(element.group);
+        circuit.control[r] = std::uint8_t(element.controlling_variable);
+        circuit.nodeA[r] = node(element.nodeA);
+        circuit.nodeB[r] = node(element.nodeB);
+        circuit.controller[r] =
+            int(r) < circuit.count && element.controlling_variable != none
+                ? rowOf.at(element.controlling_element.get())
+                : -1;
+        circuit.value(r) = element.value;
+        circuit.names[r] = element.name;
+    }
+
+    return circuit;
+}
+
+std::vector<StampRecord> makeStampRecords(
+    const CircuitTable &circuit, const std::map<std::string, int> &indexMap)
+{
+    const int sentinel = int(indexMap.size());
+    auto index = [&](const std::string &name) {
+        std::map<std::string, int>::const_iterator iter = indexMap.find(name);
+        return iter != indexMap.end() ? iter->second : sentinel;
+    };
+
+    // Unknown of every node and of every row's branch current
+    std::vector<int> nodeIndex(circuit.nodes.size());
+    for (size_t k = 0; k < circuit.nodes.size(); k++)
+        nodeIndex[k] = index(circuit.nodes[k]);
+    std::vector<int> branchIndex(circuit.names.size());
+    for (size_t r = 0; r < circuit.names.size(); r++)
+        branchIndex[r] = index(circuit.names[r]);
+
+    const int count = circuit.count;
+    std::vector<int> kernel(count);
+    for (int r = 0; r < count; r++)
+        kernel[r] = kernelIndex(Component(circuit.type[r]),
+                                Group(circuit.group[r]),
+                                ControlVariable(circuit.control[r]));
+
+    // Counting sort by kernel so that each batch is contiguous
+    std::array<int, kernelCount + 1> offset{};
+    for (int r = 0; r < count; r++) offset[kernel[r] + 1]++;
+    for (int k = 0; k < kernelCount; k++) offset[k + 1] += offset[k];
+
+    std::vector<StampRecord> records(count);
+    for (int r = 0; r < count; r++) {
+        StampRecord &record = records[offset[kernel[r]]++];
+        record.kernel = kernel[r];
+        record.a = nodeIndex[circuit.nodeA[r]];
+        record.b = nodeIndex[circuit.nodeB[r]];
+        record.branch = branchIndex[r];
+        record.value = circuit.value(r);
+        const int c = circuit.controller[r];
+        record.ca = c >= 0 ? nodeIndex[circuit.nodeA[c]] : sentinel;
+        record.cb = c >= 0 ? nodeIndex[circuit.nodeB[c]] : sentinel;
+        record.cbranch = c >= 0 ? branchIndex[c] : sentinel;
+    }
+
+    return records;
+}
+
+int setValue(CircuitTable &circuit, const std::string &name, double value)
+{
+    int changed = 0;
+    for (int r = 0; r < circuit.count; r++)
+        if (circuit.names[r] == name) {
+            circuit.value(r) = value;
+            changed++;
+        }
+    return changed;
+}
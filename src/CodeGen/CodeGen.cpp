@@ -0,0 +1,376 @@
+/*
+ * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
+ * Reserved. Permission to use, copy, modify and distribute this software for
+ * educational, research, and not-for-profit purposes, without fee and without a
+ * signed license agreement, is hereby granted, provided that this paragraph and
+ * the following two paragraphs appear in all copies, modifications, and
+ * distributions.
+ *
+ * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
+ * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
+ * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
+ *
+ * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
+ * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+/**
+ * @file CodeGen.cpp
+ *
+ * @brief Contains the implementation of the code generation
+ */
+
+#include "../../include/CodeGen.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <sstream>
+
+#include "../../include/Stamp.hpp"
+#include "../../lib/external/Eigen/OrderingMethods"
+#include "../../lib/external/Eigen/Sparse"
+
+/** @struct Stamped
+ *
+ * @brief One call of a stamp kernel
+ * */
+struct Stamped
+{
+    int row;      /**< Row of the entry */
+    int col;      /**< Column of the entry, -1 for the RHS */
+    double value; /**< Value added */
+};
+
+/** @struct RecordingSink
+ *
+ * @brief Records the stamps of a kernel in the order they are made
+ * */
+struct RecordingSink
+{
+    std::vector<Stamped> &stamps; /**< Stamps made so far */
+
+    void add(int row, int col, double value)
+    {
+        stamps.push_back({row, col, value});
+    }
+    void addRhs(int row, double value) { stamps.push_back({row, -1, value}); }
+};
+
+// Stamps of one element with the given value
+static std::vector<Stamped> recordStamps(StampRecord record, double value)
+{
+    std::vector<Stamped> stamps;
+    RecordingSink sink{stamps};
+    record.value = value;
+    kernelTable<RecordingSink>[record.kernel](&record, &record + 1, sink);
+    return stamps;
+}
+
+// Slots of a solve stamped for the given values
+static std::vector<double> stampSlots(const StaticSolve &solve,
+                                      const Eigen::VectorXd &values)
+{
+    std::vector<double> s(solve.slots, 0.0);
+    for (const StaticTerm &term : solve.terms) {
+        double v = values(term.value);
+        s[term.slot] += term.kind == constantTerm ? term.coefficient
+                        : term.kind == linearTerm ? term.coefficient * v
+                                                  : term.coefficient / v;
+    }
+    return s;
+}
+
+// Runs one operation, false if it checks a zero pivot
+static bool runOp(const StaticOp &op, std::vector<double> &s)
+{
+    if (op.code == checkPivot) return s[op.a] != 0.0;
+    if (op.code == divideSlot)
+        s[op.target] /= s[op.a];
+    else
+        s[op.target] -= s[op.a] * s[op.b];
+    return true;
+}
+
+int makeStaticSolve(
+    const std::vector<std::shared_ptr<CircuitElement>> &elements,
+    const std::map<std::string, int> &indexMap, StaticSolve &solve)
+{
+    int m = int(indexMap.size());
+    if (m > codegenUnknowns) {
+        std::cout << "Error: Code is generated for at most "
+                  << codegenUnknowns << " unknowns, the circuit has " << m
+                  << std::endl;
+        return 1;
+    }
+
+    solve = StaticSolve();
+    solve.unknowns.resize(m);
+    for (const std::pair<const std::string, int> &entry : indexMap)
+        solve.unknowns[entry.second] = entry.first;
+    solve.solution.resize(m);
+    solve.slots = m;
+
+    // Slot of every non-zero, by row and column, and the rows not pivoted
+    // yet with a non-zero in every column
+    std::vector<std::map<int, int>> rows(m);
+    std::vector<std::set<int>> columns(m);
+    auto slotOf = [&](int row, int col) {
+        std::pair<std::map<int, int>::iterator, bool> inserted =
+            rows[row].emplace(col, solve.slots);
+        if (inserted.second) {
+            solve.slots++;
+            columns[col].insert(row);
+        }
+        return inserted.first->second;
+    };
+
+    // Every stamp made with the values 1 and 2 is the same term of the value
+    int error = 0;
+    solve.defaults.resize(int(elements.size()));
+    for (size_t e = 0; e < elements.size(); e++) {
+        const CircuitElement &element = *elements[e];
+        solve.values.push_back(element.name);
+        solve.defaults(int(e)) = element.value;
+
+        StampRecord record = makeStampRecord(element, indexMap);
+        std::vector<Stamped> once = recordStamps(record, 1.0);
+        std::vector<Stamped> twice = recordStamps(record, 2.0);
+        for (size_t t = 0; t < once.size(); t++) {
+            const Stamped &stamp = once[t];
+            if (stamp.row == m || stamp.col == m) continue;
+            TermKind kind;
+            if (twice[t].value == stamp.value)
+                kind = constantTerm;
+            else if (twice[t].value == 2.0 * stamp.value)
+                kind = linearTerm;
+            else if (twice[t].value == 0.5 * stamp.value)
+                kind = inverseTerm;
+            else {
+                std::cout << "Error: No code can be generated for the stamp "
+                             "of " + element.name
+                          << std::endl;
+                error += 1;
+                break;
+            }
+            int slot = stamp.col < 0 ? stamp.row : slotOf(stamp.row, stamp.col);
+            solve.terms.push_back({slot, int(e), kind, stamp.value});
+        }
+    }
+    if (error != 0) return error;
+    std::stable_sort(solve.terms.begin(), solve.terms.end(),
+                     [](const StaticTerm &a, const StaticTerm &b) {
+                         return a.slot < b.slot;
+                     });
+
+    // Columns in COLAMD order of the stamped pattern
+    std::vector<Eigen::Triplet<double>> pattern;
+    for (int row = 0; row < m; row++)
+        for (const std::pair<const int, int> &entry : rows[row])
+            pattern.emplace_back(row, entry.first, 1.0);
+    Eigen::SparseMatrix<double> A(m, m);
+    A.setFromTriplets(pattern.begin(), pattern.end());
+    A.makeCompressed();
+    Eigen::PermutationMatrix<Eigen::Dynamic, Eigen::Dynamic, int> permutation;
+    Eigen::COLAMDOrdering<int>()(A, permutation);
+    std::vector<int> stepColumn(m);
+    for (int col = 0; col < m; col++)
+        stepColumn[permutation.indices()(col)] = col;
+
+    // The operations are recorded and run on the netlist values, which pick
+    // the pivots
+    std::vector<double> s = stampSlots(solve, solve.defaults);
+    auto record = [&](StaticOp op) {
+        solve.ops.push_back(op);
+        s.resize(solve.slots, 0.0);
+        runOp(op, s);
+    };
+
+    std::vector<int> pivotRow(m), stepOf(m);
+    std::vector<bool> pivoted(m, false);
+    for (int k = 0; k < m; k++) {
+        int q = stepColumn[k];
+        double largest = 0.0;
+        for (int i : columns[q])
+            largest = std::max(largest, std::abs(s[rows[i].at(q)]));
+        if (largest == 0.0) {
+            std::cout << "Error: The circuit is singular for its netlist "
+                         "values, no code is generated"
+                      << std::endl;
+            return 1;
+        }
+
+        // Sparsest row among the large enough ones
+        int p = -1;
+        for (int i : columns[q])
+            if (std::abs(s[rows[i].at(q)]) >= codegenPivotThreshold * largest &&
+                (p < 0 || rows[i].size() < rows[p].size()))
+                p = i;
+        pivotRow[k] = p;
+        stepOf[q] = k;
+        pivoted[q] = true;
+        for (const std::pair<const int, int> &entry : rows[p])
+            columns[entry.first].erase(p);
+
+        int pivot = rows[p].at(q);
+        record({checkPivot, -1, pivot, -1});
+        std::set<int> eliminated = columns[q];
+        for (int i : eliminated) {
+            int factor = rows[i].at(q);
+            record({divideSlot, factor, pivot, -1});
+            for (const std::pair<const int, int> &entry : rows[p])
+                if (!pivoted[entry.first])
+                    record({subtractProduct, slotOf(i, entry.first), factor,
+                            entry.second});
+            record({subtractProduct, i, factor, p});
+        }
+    }
+
+    // Back substitution, the RHS slot of every pivot row ends holding the
+    // unknown of its column
+    for (int k = m - 1; k >= 0; k--) {
+        int p = pivotRow[k], q = stepColumn[k];
+        for (const std::pair<const int, int> &entry : rows[p])
+            if (stepOf[entry.first] > k)
+                record({subtractProduct, p, entry.second,
+                        pivotRow[stepOf[entry.first]]});
+        record({divideSlot, p, rows[p].at(q), -1});
+        solve.solution[q] = p;
+    }
+    return 0;
+}
+
+bool runStaticSolve(const StaticSolve &solve, const Eigen::VectorXd &values,
+                    Eigen::VectorXd &x)
+{
+    std::vector<double> s = stampSlots(solve, values);
+    for (const StaticOp &op : solve.ops)
+        if (!runOp(op, s)) return false;
+    x.resize(int(solve.solution.size()));
+    for (size_t k = 0; k < solve.solution.size(); k++)
+        x(int(k)) = s[solve.solution[k]];
+    return true;
+}
+
+// Double literal that reads back as the same value
+static std::string literal(double value)
+{
+    std::ostringstream text;
+    text << std::setprecision(17) << value;
+    std::string digits = text.str();
+    if (digits.find_first_of(".e") == std::string::npos) digits += ".0";
+    return digits;
+}
+
+// C string literal
+static std::string quoted(const std::string &text)
+{
+    std::string result = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') result += '\\';
+        result += c;
+    }
+    return result + "\"";
+}
+
+// Expression of one term, with its sign in front
+static std::string termExpression(const StaticTerm &term)
+{
+    std::string v = "v[" + std::to_string(term.value) + "]";
+    double magnitude = std::abs(term.coefficient);
+    std::string sign = term.coefficient < 0.0 ? "-" : "";
+    if (term.kind == constantTerm) return sign + literal(magnitude);
+    if (term.kind == inverseTerm)
+        return sign + literal(magnitude) + " / " + v;
+    return sign + (magnitude == 1.0 ? v : literal(magnitude) + " * " + v);
+}
+
+int writeStaticSolve(const std::string &file, const StaticSolve &solve,
+                     const std::string &netlist)
+{
+    std::ofstream out(file);
+    if (!out) {
+        std::cout << "Error: Cannot write the generated code to " + file
+                  << std::endl;
+        return 1;
+    }
+
+    out << "/*\n * Generated by SNU_Spice from " << netlist << ": "
+        << solve.unknowns.size() << " unknowns, " << solve.values.size()
+        << " values, " << solve.ops.size() << " operations\n"
+        << " *\n"
+        << " * snuSpiceSolve(v, x) solves the circuit for the element values"
+           " v, in the\n"
+        << " * order of snuSpiceValueNames, into the unknowns x, in the "
+           "order of\n"
+        << " * snuSpiceUnknownNames. It returns 1 if a pivot is zero, else "
+           "0.\n */\n\n";
+
+    out << "extern \"C\" {\n\n";
+    out << "extern const int snuSpiceValueCount = " << solve.values.size()
+        << ";\n";
+    out << "extern const char *const snuSpiceValueNames[] = {";
+    for (const std::string &name : solve.values) out << quoted(name) << ", ";
+    out << "nullptr};\n";
+    out << "extern const double snuSpiceDefaultValues[] = {";
+    for (int k = 0; k < solve.defaults.size(); k++)
+        out << literal(solve.defaults(k)) << ", ";
+    out << "0.0};\n";
+    out << "extern const int snuSpiceUnknownCount = " << solve.unknowns.size()
+        << ";\n";
+    out << "extern const char *const snuSpiceUnknownNames[] = {";
+    for (const std::string &name : solve.unknowns) out << quoted(name) << ", ";
+    out << "nullptr};\n\n";
+
+    out << "int snuSpiceSolve(const double *v, double *x)\n{\n";
+    out << "    double s[" << std::max(solve.slots, 1) << "];\n";
+
+    // Stamps, one sum per slot
+    size_t t = 0;
+    for (int slot = 0; slot < solve.slots; slot++) {
+        out << "    s[" << slot << "] = ";
+        if (t == solve.terms.size() || solve.terms[t].slot != slot)
+            out << "0.0";
+        for (bool first = true;
+             t < solve.terms.size() && solve.terms[t].slot == slot;
+             t++, first = false) {
+            std::string term = termExpression(solve.terms[t]);
+            if (first)
+                out << term;
+            else if (term[0] == '-')
+                out << " - " << term.substr(1);
+            else
+                out << " + " << term;
+        }
+        out << ";\n";
+    }
+
+    // Factorization and substitution
+    for (const StaticOp &op : solve.ops) {
+        if (op.code == checkPivot)
+            out << "    if (s[" << op.a << "] == 0.0) return 1;\n";
+        else if (op.code == divideSlot)
+            out << "    s[" << op.target << "] /= s[" << op.a << "];\n";
+        else
+            out << "    s[" << op.target << "] -= s[" << op.a << "] * s["
+                << op.b << "];\n";
+    }
+
+    for (size_t k = 0; k < solve.solution.size(); k++)
+        out << "    x[" << k << "] = s[" << solve.solution[k] << "];\n";
+    out << "    return 0;\n}\n\n}\n";
+
+    out.close();
+    if (!out) {
+        std::cout << "Error: Cannot write the generated code to " + file
+                  << std::endl;
+        return 1;
+    }
+    return 0;
+}
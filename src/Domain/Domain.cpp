@@ -0,0 +1,338 @@
+/*
+ * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
+ * Reserved. Permission to use, copy, modify and distribute this software for
+ * educational, research, and not-for-profit purposes, without fee and without a
+ * signed license agreement, is hereby granted, provided that this paragraph and
+ * the following two paragraphs appear in all copies, modifications, and
+ * distributions.
+ *
+ * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
+ * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
+ * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
+ *
+ * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
+ * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+/**
+ * @file Domain.cpp
+ *
+ * @brief Contains the implementation of the domain decomposition solve
+ */
+
+#include "../../include/Domain.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <numeric>
+
+#include "../../include/Transport.hpp"
+#include "../../lib/external/Eigen/SparseLU"
+
+using Triplets = std::vector<Eigen::Triplet<double>>;
+
+std::vector<int> partitionDomains(const Eigen::SparseMatrix<double> &A,
+                                  int domains)
+{
+    const int m = int(A.rows());
+    Eigen::SparseMatrix<double> pattern =
+        Eigen::SparseMatrix<double>(A.transpose()) + A;
+
+    // Breadth first numbering, every component from its sparsest unknown
+    std::vector<int> bySparsity(m);
+    std::iota(bySparsity.begin(), bySparsity.end(), 0);
+    std::stable_sort(bySparsity.begin(), bySparsity.end(), [&](int i, int j) {
+        return pattern.col(i).nonZeros() < pattern.col(j).nonZeros();
+    });
+    std::vector<int> order;
+    order.reserve(m);
+    std::vector<bool> visited(m, false);
+    for (int root : bySparsity) {
+        if (visited[root]) continue;
+        visited[root] = true;
+        order.push_back(root);
+        for (std::size_t next = order.size() - 1; next < order.size();
+             next++)
+            for (Eigen::SparseMatrix<double>::InnerIterator it(pattern,
+                                                               order[next]);
+                 it; ++it)
+                if (!visited[it.row()]) {
+                    visited[it.row()] = true;
+                    order.push_back(int(it.row()));
+                }
+    }
+
+    std::vector<int> domain(m);
+    for (int k = 0; k < m; k++)
+        domain[order[k]] = int(static_cast<long long>(k) * domains / m);
+
+    // One end of every coupling between domains joins the interface
+    std::vector<int> interface(domain);
+    for (int col = 0; col < m; col++)
+        for (Eigen::SparseMatrix<double>::InnerIterator it(pattern, col); it;
+             ++it) {
+            int row = int(it.row());
+            if (domain[row] == domain[col] || interface[row] < 0 ||
+                interface[col] < 0)
+                continue;
+            if (domain[row] < domain[col])
+                interface[row] = -1;
+            else
+                interface[col] = -1;
+        }
+    for (int k = 0; k < m; k++)
+        if (A.coeff(k, k) == 0.0) interface[k] = -1;
+    return interface;
+}
+
+// Reads count triplets of a rows x cols block from a message
+static Eigen::SparseMatrix<double> readBlock(const std::vector<double> &message,
+                                             std::size_t &next, int rows,
+                                             int cols, std::size_t count)
+{
+    Triplets triplets;
+    triplets.reserve(count);
+    for (std::size_t k = 0; k < count; k++, next += 3)
+        triplets.emplace_back(int(message[next]), int(message[next + 1]),
+                              message[next + 2]);
+    Eigen::SparseMatrix<double> block(rows, cols);
+    block.setFromTriplets(triplets.begin(), triplets.end());
+    return block;
+}
+
+static void writeBlock(const Triplets &triplets, std::vector<double> &message)
+{
+    for (const Eigen::Triplet<double> &triplet : triplets) {
+        message.push_back(triplet.row());
+        message.push_back(triplet.col());
+        message.push_back(triplet.value());
+    }
+}
+
+// Work of one worker: factorizes its interior, leaves its part of the Schur
+// complement in the window and back-substitutes the interface values the
+// coordinator sends
+static int solveInterior(Transport &transport)
+{
+    std::vector<double> message;
+    if (!transport.receive(0, message) || message.size() < 6) return 1;
+    std::size_t offset = std::size_t(message[0]);
+    int interior = int(message[1]);
+    int boundary = int(message[2]);
+    std::size_t next = 6;
+    if (message.size() != next + interior +
+                              3 * std::size_t(message[3] + message[4] +
+                                              message[5]))
+        return 1;
+    Eigen::SparseMatrix<double> AII =
+        readBlock(message, next, interior, interior, std::size_t(message[3]));
+    Eigen::SparseMatrix<double> AIG =
+        readBlock(message, next, interior, boundary, std::size_t(message[4]));
+    Eigen::SparseMatrix<double> AGI =
+        readBlock(message, next, boundary, interior, std::size_t(message[5]));
+
+    // A_II^-1 [A_IG b_I], its last column gives the interior for a zero
+    // interface
+    Eigen::MatrixXd R(interior, boundary + 1);
+    R.leftCols(boundary) = Eigen::MatrixXd(AIG);
+    R.col(boundary) =
+        Eigen::Map<const Eigen::VectorXd>(message.data() + next, interior);
+    Eigen::SparseLU<Eigen::SparseMatrix<double>> lu(AII);
+    Eigen::MatrixXd Y;
+    if (lu.info() == Eigen::Success) Y = lu.solve(R);
+    if (lu.info() != Eigen::Success || !Y.allFinite()) {
+        transport.send(0, {1.0});
+        return 1;
+    }
+    Eigen::Map<Eigen::MatrixXd>(transport.window() + offset, boundary,
+                                boundary + 1) = AGI * Y;
+    if (!transport.send(0, {0.0})) return 1;
+
+    if (!transport.receive(0, message) || int(message.size()) != boundary)
+        return 1;
+    Eigen::VectorXd xI =
+        Y.col(boundary) -
+        Y.leftCols(boundary) *
+            Eigen::Map<const Eigen::VectorXd>(message.data(), boundary);
+    return transport.send(0, std::vector<double>(xI.data(), xI.data() +
+                                                             interior))
+               ? 0
+               : 1;
+}
+
+bool solveDomains(const Eigen::SparseMatrix<double> &A,
+                  const Eigen::VectorXd &b, int domains, Transport &transport,
+                  Eigen::VectorXd &x, DomainReport &report)
+{
+    auto start = std::chrono::steady_clock::now();
+    const int m = int(A.rows());
+    std::vector<int> domain = partitionDomains(A, domains);
+
+    // Domains left without an interior get no worker
+    std::vector<int> interiorSize(domains, 0);
+    for (int k = 0; k < m; k++)
+        if (domain[k] >= 0) interiorSize[domain[k]]++;
+    std::vector<int> worker(domains, -1);
+    int workers = 0;
+    for (int d = 0; d < domains; d++)
+        if (interiorSize[d] > 0) {
+            worker[d] = workers++;
+            report.interiors.push_back(interiorSize[d]);
+        }
+    if (workers < 2) {
+        report.failure = "it is too small to split";
+        return false;
+    }
+
+    // Local index of every unknown in its interior or the interface
+    std::vector<int> local(m);
+    std::vector<int> interface;
+    std::vector<std::vector<int>> interiors(workers);
+    for (int k = 0; k < m; k++) {
+        if (domain[k] < 0) {
+            local[k] = int(interface.size());
+            interface.push_back(k);
+            continue;
+        }
+        domain[k] = worker[domain[k]];
+        local[k] = int(interiors[domain[k]].size());
+        interiors[domain[k]].push_back(k);
+    }
+    const int g = int(interface.size());
+    report.interface = g;
+
+    // Blocks of every domain, its boundary being the interface unknowns its
+    // interior couples to
+    std::vector<Triplets> AII(workers), AIG(workers), AGI(workers);
+    std::vector<std::vector<int>> boundaries(workers);
+    std::vector<std::vector<int>> boundaryIndex(workers,
+                                                std::vector<int>(g, -1));
+    Triplets S;
+    auto boundaryOf = [&](int p, int unknown) {
+        int &index = boundaryIndex[p][local[unknown]];
+        if (index < 0) {
+            index = int(boundaries[p].size());
+            boundaries[p].push_back(local[unknown]);
+        }
+        return index;
+    };
+    for (int col = 0; col < m; col++)
+        for (Eigen::SparseMatrix<double>::InnerIterator it(A, col); it;
+             ++it) {
+            int row = int(it.row());
+            if (domain[row] >= 0 && domain[col] >= 0)
+                AII[domain[row]].emplace_back(local[row], local[col],
+                                              it.value());
+            else if (domain[row] >= 0)
+                AIG[domain[row]].emplace_back(
+                    local[row], boundaryOf(domain[row], col), it.value());
+            else if (domain[col] >= 0)
+                AGI[domain[col]].emplace_back(boundaryOf(domain[col], row),
+                                              local[col], it.value());
+            else
+                S.emplace_back(local[row], local[col], it.value());
+        }
+    boundaryIndex.clear();
+
+    std::vector<std::size_t> offsets(workers + 1, 0);
+    for (int p = 0; p < workers; p++) {
+        std::size_t boundary = boundaries[p].size();
+        offsets[p + 1] = offsets[p] + boundary * (boundary + 1);
+    }
+    if (!transport.start(workers, offsets[workers], [&](int) {
+            return solveInterior(transport);
+        })) {
+        report.failure = "its workers could not be started";
+        return false;
+    }
+    for (int p = 0; p < workers; p++) {
+        std::vector<double> message = {
+            double(offsets[p]),          double(interiors[p].size()),
+            double(boundaries[p].size()), double(AII[p].size()),
+            double(AIG[p].size()),       double(AGI[p].size())};
+        message.reserve(message.size() + interiors[p].size() +
+                        3 * (AII[p].size() + AIG[p].size() + AGI[p].size()));
+        writeBlock(AII[p], message);
+        writeBlock(AIG[p], message);
+        writeBlock(AGI[p], message);
+        for (int unknown : interiors[p]) message.push_back(b(unknown));
+        Triplets().swap(AII[p]);
+        Triplets().swap(AIG[p]);
+        Triplets().swap(AGI[p]);
+        if (!transport.send(p + 1, message)) {
+            report.failure = "a worker failed";
+            transport.finish();
+            return false;
+        }
+    }
+
+    // Schur complement S = A_GG - sum A_GI A_II^-1 A_IG, summed from the
+    // window once every worker has reported
+    Eigen::VectorXd bG(g);
+    for (int k = 0; k < g; k++) bG(k) = b(interface[k]);
+    std::vector<double> message;
+    for (int p = 0; p < workers; p++) {
+        if (!transport.receive(p + 1, message) || message.size() != 1 ||
+            message[0] != 0.0) {
+            report.failure = "the interior of a domain is singular";
+            transport.finish();
+            return false;
+        }
+        const std::vector<int> &boundary = boundaries[p];
+        int size = int(boundary.size());
+        Eigen::Map<const Eigen::MatrixXd> C(transport.window() + offsets[p],
+                                            size, size + 1);
+        for (int j = 0; j < size; j++)
+            for (int i = 0; i < size; i++)
+                if (C(i, j) != 0.0)
+                    S.emplace_back(boundary[i], boundary[j], -C(i, j));
+        for (int i = 0; i < size; i++) bG(boundary[i]) -= C(i, size);
+    }
+    Eigen::SparseMatrix<double> schur(g, g);
+    schur.setFromTriplets(S.begin(), S.end());
+    Triplets().swap(S);
+    Eigen::VectorXd xG;
+    Eigen::SparseLU<Eigen::SparseMatrix<double>> lu(schur);
+    if (lu.info() == Eigen::Success) xG = lu.solve(bG);
+    if (lu.info() != Eigen::Success || !xG.allFinite()) {
+        report.failure = "its interface is singular";
+        transport.finish();
+        return false;
+    }
+
+    x.resize(m);
+    for (int k = 0; k < g; k++) x(interface[k]) = xG(k);
+    for (int p = 0; p < workers; p++) {
+        std::vector<double> values;
+        values.reserve(boundaries[p].size());
+        for (int k : boundaries[p]) values.push_back(xG(k));
+        if (!transport.send(p + 1, values)) {
+            report.failure = "a worker failed";
+            transport.finish();
+            return false;
+        }
+    }
+    for (int p = 0; p < workers; p++) {
+        if (!transport.receive(p + 1, message) ||
+            message.size() != interiors[p].size()) {
+            report.failure = "a worker failed";
+            transport.finish();
+            return false;
+        }
+        for (std::size_t k = 0; k < message.size(); k++)
+            x(interiors[p][k]) = message[k];
+    }
+    if (!transport.finish()) {
+        report.failure = "a worker failed";
+        return false;
+    }
+    report.used = true;
+    report.time = std::chrono::duration<double, std::milli>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+    return true;
+}
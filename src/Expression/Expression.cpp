@@ -0,0 +1,428 @@
+/*
+ * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
+ * Reserved. Permission to use, copy, modify and distribute this software for
+ * educational, research, and not-for-profit purposes, without fee and without a
+ * signed license agreement, is hereby granted, provided that this paragraph and
+ * the following two paragraphs appear in all copies, modifications, and
+ * distributions.
+ *
+ * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
+ * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
+ * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
+ *
+ * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
+ * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+/**
+ * @file Expression.cpp
+ *
+ * @brief Contains the implementation of the expression compiler and its
+ * bytecode interpreter
+ */
+
+#include "../../include/Expression.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <functional>
+#include <iostream>
+
+using std::cout, std::endl;
+
+// Reads a number with an optional engineering suffix at text[position],
+// advancing position past it
+static bool readNumber(const std::string &text, size_t &position,
+                       double &value)
+{
+    auto digit = [&](size_t k) {
+        return k < text.size() && std::isdigit((unsigned char)text[k]);
+    };
+
+    size_t k = position;
+    while (digit(k)) k++;
+    if (k < text.size() && text[k] == '.') k++;
+    while (digit(k)) k++;
+    if (k == position || (k == position + 1 && text[position] == '.'))
+        return false;
+    if (k < text.size() && std::toupper((unsigned char)text[k]) == 'E') {
+        size_t exponent = k + 1;
+        if (exponent < text.size() &&
+            (text[exponent] == '+' || text[exponent] == '-'))
+            exponent++;
+        if (digit(exponent)) {
+            k = exponent;
+            while (digit(k)) k++;
+        }
+    }
+    value = std::strtod(text.substr(position, k - position).c_str(), nullptr);
+
+    std::string rest = text.substr(k, 3);
+    std::transform(rest.begin(), rest.end(), rest.begin(), ::toupper);
+    static const std::pair<const char *, double> suffixes[] = {
+        {"MEG", 1e6}, {"T", 1e12}, {"G", 1e9},   {"K", 1e3}, {"M", 1e-3},
+        {"U", 1e-6},  {"N", 1e-9}, {"P", 1e-12}, {"F", 1e-15}};
+    for (const std::pair<const char *, double> &suffix : suffixes)
+        if (rest.compare(0, std::string(suffix.first).size(), suffix.first) ==
+            0) {
+            value *= suffix.second;
+            k += std::string(suffix.first).size();
+            break;
+        }
+
+    // A number is not glued to a name
+    if (k < text.size() &&
+        (std::isalnum((unsigned char)text[k]) || text[k] == '_'))
+        return false;
+    position = k;
+    return std::isfinite(value);
+}
+
+bool parseEngineering(const std::string &text, double &value)
+{
+    // An optional sign, then the number
+    size_t position = !text.empty() && (text[0] == '-' || text[0] == '+');
+    if (!readNumber(text, position, value) || position != text.size())
+        return false;
+    if (text[0] == '-') value = -value;
+    return true;
+}
+
+// Recursive descent compiler of one expression into bytecode:
+//   expression := term (('+' | '-') term)*
+//   term       := unary (('*' | '/') unary)*
+//   unary      := ('-' | '+') unary | power
+//   power      := primary ('^' unary)?
+//   primary    := number | name | name '(' arguments ')' | '(' expression ')'
+struct Compiler
+{
+    const std::string &text;
+    size_t position;
+    std::vector<Instruction> &code;
+    std::vector<double> &constants;
+    // Resolves a parameter to its slot, -1 after reporting an error
+    std::function<int(const std::string &)> resolve;
+    bool failed;
+
+    char peek()
+    {
+        return position < text.size() ? char(std::toupper(text[position]))
+                                      : '\0';
+    }
+
+    bool expression()
+    {
+        if (!term()) return false;
+        while (peek() == '+' || peek() == '-') {
+            Opcode opcode = peek() == '+' ? add : subtract;
+            position++;
+            if (!term()) return false;
+            code.push_back({opcode, 0});
+        }
+        return true;
+    }
+
+    bool term()
+    {
+        if (!unary()) return false;
+        while (peek() == '*' || peek() == '/') {
+            Opcode opcode = peek() == '*' ? multiply : divide;
+            position++;
+            if (!unary()) return false;
+            code.push_back({opcode, 0});
+        }
+        return true;
+    }
+
+    bool unary()
+    {
+        if (peek() == '-' || peek() == '+') {
+            bool negative = peek() == '-';
+            position++;
+            if (!unary()) return false;
+            if (negative) code.push_back({negate, 0});
+            return true;
+        }
+        if (!primary()) return false;
+        if (peek() == '^') {
+            position++;
+            if (!unary()) return false;
+            code.push_back({power, 0});
+        }
+        return true;
+    }
+
+    bool primary()
+    {
+        if (peek() == '(') {
+            position++;
+            if (!expression() || peek() != ')') return false;
+            position++;
+            return true;
+        }
+
+        double value;
+        if (std::isdigit((unsigned char)peek()) || peek() == '.') {
+            if (!readNumber(text, position, value)) return false;
+            code.push_back({pushConstant, int(constants.size())});
+            constants.push_back(value);
+            return true;
+        }
+
+        size_t start = position;
+        while (std::isalnum((unsigned char)peek()) || peek() == '_')
+            position++;
+        if (start == position || std::isdigit((unsigned char)text[start]))
+            return false;
+        std::string name = text.substr(start, position - start);
+        std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+
+        if (peek() == '(') {
+            static const std::map<std::string, std::pair<Opcode, int>>
+                functions = {{"SQRT", {callSqrt, 1}}, {"EXP", {callExp, 1}},
+                             {"LOG", {callLog, 1}},   {"ABS", {callAbs, 1}},
+                             {"MIN", {callMin, 2}},   {"MAX", {callMax, 2}},
+                             {"POW", {power, 2}}};
+            std::map<std::string, std::pair<Opcode, int>>::const_iterator
+                function = functions.find(name);
+            if (function == functions.end()) return false;
+            position++;
+            for (int k = 0; k < function->second.second; k++) {
+                if (k > 0 && peek() != ',') return false;
+                if (k > 0) position++;
+                if (!expression()) return false;
+            }
+            if (peek() != ')') return false;
+            position++;
+            code.push_back({function->second.first, 0});
+            return true;
+        }
+
+        int slot = resolve(name);
+        if (slot < 0) {
+            failed = true;
+            return false;
+        }
+        code.push_back({pushParameter, slot});
+        return true;
+    }
+};
+
+int ParameterTable::define(const std::string &name,
+                           const std::string &expression,
+                           const std::string &location)
+{
+    if (slots.count(name)) {
+        cout << "Error: Parameter " + name + " is defined twice " + location
+             << endl;
+        return 1;
+    }
+    slots[name] = int(names.size());
+    names.push_back(name);
+    Definition definition;
+    definition.expression = expression;
+    definition.location = location;
+    definitions.push_back(definition);
+    return 0;
+}
+
+void ParameterTable::bind(std::shared_ptr<CircuitElement> element,
+                          const std::string &expression,
+                          const std::string &location)
+{
+    elements.push_back(element);
+    Definition binding;
+    binding.expression = expression;
+    binding.location = location;
+    bindings.push_back(binding);
+}
+
+int ParameterTable::compile(Definition &definition, std::vector<int> &state)
+{
+    int errors = 0;
+    std::vector<Instruction> local;
+    Compiler compiler{definition.expression, 0, local, constants, nullptr,
+                      false};
+    compiler.resolve = [&](const std::string &name) {
+        std::map<std::string, int>::iterator slot = slots.find(name);
+        if (slot == slots.end()) {
+            cout << "Error: Unknown parameter " + name + " " +
+                        definition.location
+                 << endl;
+            errors++;
+            return -1;
+        }
+        // Compiles the parameter first, its code has to run before this one
+        if (state[slot->second] == 1) {
+            cout << "Error: Parameter " + name + " depends on itself " +
+                        definition.location
+                 << endl;
+            errors++;
+            return -1;
+        }
+        if (state[slot->second] == 0) {
+            state[slot->second] = 1;
+            errors += compile(definitions[slot->second], state);
+            state[slot->second] = 2;
+            order.push_back(slot->second);
+        }
+        return slot->second;
+    };
+
+    if (!compiler.expression() || compiler.position != compiler.text.size()) {
+        if (!compiler.failed)
+            cout << "Error: Illegal expression " + definition.location
+                 << endl;
+        return std::max(errors, 1);
+    }
+
+    // Stack depth the range needs: pushes add a value, binary operations
+    // take one away
+    int depth = 0, deepest = 0;
+    for (const Instruction &instruction : local) {
+        switch (instruction.opcode) {
+            case pushConstant:
+            case pushParameter:
+                deepest = std::max(deepest, ++depth);
+                break;
+            case add:
+            case subtract:
+            case multiply:
+            case divide:
+            case power:
+            case callMin:
+            case callMax:
+                depth--;
+                break;
+            default:
+                break;
+        }
+    }
+    if (stack.size() < size_t(deepest)) stack.resize(deepest);
+
+    definition.begin = int(code.size());
+    code.insert(code.end(), local.begin(), local.end());
+    definition.end = int(code.size());
+    return errors;
+}
+
+int ParameterTable::compile()
+{
+    int errors = 0;
+    code.clear();
+    constants.clear();
+    order.clear();
+    std::vector<int> state(definitions.size(), 0);
+    for (size_t slot = 0; slot < definitions.size(); slot++) {
+        if (state[slot] != 0) continue;
+        state[slot] = 1;
+        errors += compile(definitions[slot], state);
+        state[slot] = 2;
+        order.push_back(int(slot));
+    }
+    for (Definition &binding : bindings) errors += compile(binding, state);
+
+    parameters = Eigen::VectorXd::Zero(int(names.size()));
+    values = Eigen::VectorXd::Zero(int(bindings.size()));
+    return errors;
+}
+
+bool ParameterTable::set(const std::string &name, double value)
+{
+    std::map<std::string, int>::iterator slot = slots.find(name);
+    if (slot == slots.end()) return false;
+    definitions[slot->second].fixed = true;
+    parameters(slot->second) = value;
+    return true;
+}
+
+double ParameterTable::run(int begin, int end)
+{
+    double *top = stack.data() - 1;
+    for (int k = begin; k < end; k++) {
+        const Instruction &instruction = code[k];
+        switch (instruction.opcode) {
+            case pushConstant:
+                *++top = constants[instruction.operand];
+                break;
+            case pushParameter:
+                *++top = parameters(instruction.operand);
+                break;
+            case negate:
+                *top = -*top;
+                break;
+            case add:
+                top--;
+                *top += top[1];
+                break;
+            case subtract:
+                top--;
+                *top -= top[1];
+                break;
+            case multiply:
+                top--;
+                *top *= top[1];
+                break;
+            case divide:
+                top--;
+                *top /= top[1];
+                break;
+            case power:
+                top--;
+                *top = std::pow(*top, top[1]);
+                break;
+            case callSqrt:
+                *top = std::sqrt(*top);
+                break;
+            case callExp:
+                *top = std::exp(*top);
+                break;
+            case callLog:
+                *top = std::log(*top);
+                break;
+            case callAbs:
+                *top = std::abs(*top);
+                break;
+            case callMin:
+                top--;
+                *top = std::min(*top, top[1]);
+                break;
+            case callMax:
+                top--;
+                *top = std::max(*top, top[1]);
+                break;
+        }
+    }
+    return *top;
+}
+
+void ParameterTable::evaluate()
+{
+    for (int slot : order)
+        if (!definitions[slot].fixed)
+            parameters(slot) =
+                run(definitions[slot].begin, definitions[slot].end);
+    for (size_t k = 0; k < bindings.size(); k++)
+        values(int(k)) = run(bindings[k].begin, bindings[k].end);
+}
+
+int ParameterTable::apply()
+{
+    evaluate();
+    int errors = 0;
+    for (size_t k = 0; k < elements.size(); k++) {
+        if (!std::isfinite(values(int(k))) || values(int(k)) == 0) {
+            cout << "Error: Illegal argument for value " +
+                        bindings[k].location
+                 << endl;
+            errors++;
+            continue;
+        }
+        elements[k]->value = values(int(k));
+    }
+    return errors;
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
+ * Reserved. Permission to use, copy, modify and distribute this software for
+ * educational, research, and not-for-profit purposes, without fee and without a
+ * signed license agreement, is hereby granted, provided that this paragraph and
+ * the following two paragraphs appear in all copies, modifications, and
+ * distributions.
+ *
+ * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
+ * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
+ * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
+ *
+ * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
+ * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+/**
+ * @file Graph.cpp
+ *
+ * @brief Contains the implementation of the circuit graph
+ */
+
+#include "../../include/Graph.hpp"
+
+Graph makeGraph(
+    const std::vector<std::shared_ptr<CircuitElement>> &circuitElements)
+{
+    Graph graph;
+    graph.elements = circuitElements;
+    const size_t count = circuitElements.size();
+    graph.nodeA.resize(count);
+    graph.nodeB.resize(count);
+
+    // Numbers the nodes and counts the incidences of each
+    auto number = [&](const std::string &name) {
+        auto inserted = graph.ids.try_emplace(name, graph.nodeCount());
+        if (inserted.second) {
+            graph.names.push_back(name);
+            graph.offsets.push_back(0);
+        }
+        graph.offsets[inserted.first->second]++;
+        return inserted.first->second;
+    };
+    graph.ids.reserve(count);
+    for (size_t e = 0; e < count; e++) {
+        graph.nodeA[e] = number(circuitElements[e]->nodeA);
+        graph.nodeB[e] = number(circuitElements[e]->nodeB);
+    }
+    auto ground = graph.ids.find("0");
+    if (ground != graph.ids.end()) graph.ground = ground->second;
+
+    // Counts to row starts, then every element into both rows
+    int total = 0;
+    for (int &offset : graph.offsets) {
+        int degree = offset;
+        offset = total;
+        total += degree;
+    }
+    graph.offsets.push_back(total);
+    graph.neighbors.resize(total);
+    graph.elementIds.resize(total);
+
+    std::vector<int> next(graph.offsets.begin(), graph.offsets.end() - 1);
+    for (size_t e = 0; e < count; e++) {
+        int a = graph.nodeA[e], b = graph.nodeB[e];
+        graph.neighbors[next[a]] = b;
+        graph.elementIds[next[a]++] = int(e);
+        graph.neighbors[next[b]] = a;
+        graph.elementIds[next[b]++] = int(e);
+    }
+
+    return graph;
+}
@@ -0,0 +1,361 @@
+/*
+ * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
+ * Reserved. Permission to use, copy, modify and distribute this software for
+ * educational, research, and not-for-profit purposes, without fee and without a
+ * signed license agreement, is hereby granted, provided that this paragraph and
+ * the following two paragraphs appear in all copies, modifications, and
+ * distributions.
+ *
+ * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
+ * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
+ * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
+ *
+ * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
+ * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+/**
+ * @file LinearSolver.cpp
+ *
+ * @brief Contains the implementation of the linear solver backends
+ */
+
+#include "../../include/LinearSolver.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+Eigen::VectorXd solveDense(Eigen::Ref<Eigen::MatrixXd> A,
+                           const Eigen::VectorXd &b)
+{
+    Eigen::PartialPivLU<Eigen::Ref<Eigen::MatrixXd>> lu(A);
+    return lu.solve(b);
+}
+
+Eigen::VectorXd solveDense(Eigen::Ref<Eigen::MatrixXd> A,
+                           const Eigen::VectorXd &b,
+                           const Eigen::MatrixXd &seeds,
+                           Eigen::MatrixXd &adjoints)
+{
+    Eigen::PartialPivLU<Eigen::Ref<Eigen::MatrixXd>> lu(A);
+    adjoints = lu.transpose().solve(seeds);
+    return lu.solve(b);
+}
+
+// Pivot growth and smallest pivot, from the largest entries of A and U and
+// the pivots of every unknown
+static void recordPivots(double amax, double umax,
+                         const Eigen::VectorXd &pivots, SolveReport &report)
+{
+    report.diagnosed = true;
+    report.growth = amax > 0.0 ? umax / amax : 0.0;
+    report.smallestPivot = HUGE_VAL;
+    report.pivotUnknown = -1;
+    for (int k = 0; k < pivots.size(); k++)
+        if (std::abs(pivots(k)) < report.smallestPivot) {
+            report.smallestPivot = std::abs(pivots(k));
+            report.pivotUnknown = k;
+        }
+}
+
+Eigen::VectorXd solveDense(Eigen::Ref<Eigen::MatrixXd> A,
+                           const Eigen::VectorXd &b, SolveReport &report)
+{
+    double amax = A.size() > 0 ? A.cwiseAbs().maxCoeff() : 0.0;
+    Eigen::PartialPivLU<Eigen::Ref<Eigen::MatrixXd>> lu(A);
+
+    // Rows are swapped but columns are not, so the pivot of unknown k is
+    // U(k, k)
+    double umax = 0.0;
+    for (int col = 0; col < A.cols(); col++)
+        umax = std::max(umax, A.col(col).head(col + 1).cwiseAbs().maxCoeff());
+    recordPivots(amax, umax, A.diagonal(), report);
+    report.rcond = lu.rcond();
+
+    return lu.solve(b);
+}
+
+// Refines x with double precision residuals of A and corrections from the
+// single precision factors lu, until ||b - Ax|| <= sqrt(n) ||A|| ||x|| eps
+template <class Matrix, class Factors>
+static bool refine(const Matrix &A, const Eigen::VectorXd &b,
+                   const Factors &lu, Eigen::VectorXd &x, SolveReport &report)
+{
+    const double eps = std::numeric_limits<double>::epsilon();
+    const double anorm =
+        (A.cwiseAbs() * Eigen::VectorXd::Ones(A.cols())).maxCoeff();
+    const double threshold = std::sqrt(double(A.rows())) * anorm * eps;
+
+    x = Eigen::VectorXf(lu.solve(b.cast<float>())).cast<double>();
+    for (;; report.refinements++) {
+        Eigen::VectorXd r = b - A * x;
+        double rnorm = r.lpNorm<Eigen::Infinity>();
+        double xnorm = x.lpNorm<Eigen::Infinity>();
+        if (!std::isfinite(rnorm)) return false;
+
+        report.residual = anorm * xnorm > 0.0 ? rnorm / (anorm * xnorm)
+                                              : rnorm;
+        if (rnorm <= threshold * xnorm) return true;
+        if (report.refinements == maxRefinements) return false;
+
+        x += Eigen::VectorXf(lu.solve(r.cast<float>())).cast<double>();
+    }
+}
+
+Eigen::VectorXd solveDenseMixed(const Eigen::Ref<const Eigen::MatrixXd> &A,
+                                const Eigen::VectorXd &b,
+                                SolveReport &report)
+{
+    report.refinements = 0;
+    report.fellBack = false;
+
+    // Entries beyond the float range would overflow in the factorization
+    Eigen::VectorXd x;
+    if (A.size() > 0 &&
+        A.cwiseAbs().maxCoeff() < std::numeric_limits<float>::max()) {
+        Eigen::PartialPivLU<Eigen::MatrixXf> lu(A.cast<float>());
+        if (refine(A, b, lu, x, report)) return x;
+    }
+
+    // Falls back to a double precision factorization of the same matrix
+    report.fellBack = true;
+    x = Eigen::PartialPivLU<Eigen::MatrixXd>(A).solve(b);
+    report.residual = scaledResidual(A, x, b);
+
+    return x;
+}
+
+Eigen::VectorXd solveSparseMixed(const Eigen::SparseMatrix<double> &A,
+                                 const Eigen::VectorXd &b,
+                                 SolveReport &report)
+{
+    report.refinements = 0;
+    report.fellBack = false;
+
+    // The single precision factors are released before a fallback, so the
+    // peak stays that of the double precision factors
+    Eigen::VectorXd x;
+    if (A.nonZeros() > 0 && A.coeffs().cwiseAbs().maxCoeff() <
+                                std::numeric_limits<float>::max()) {
+        Eigen::SparseLU<Eigen::SparseMatrix<float>> lu;
+        lu.compute(A.cast<float>());
+        if (lu.info() == Eigen::Success && refine(A, b, lu, x, report))
+            return x;
+    }
+
+    report.fellBack = true;
+    x = solveSparse(A, b);
+    report.residual = scaledResidual(A, x, b);
+
+    return x;
+}
+
+Eigen::VectorXd solveSparse(const Eigen::SparseMatrix<double> &A,
+                            const Eigen::VectorXd &b)
+{
+    Eigen::SparseLU<Eigen::SparseMatrix<double>> lu;
+    lu.compute(A);
+    if (lu.info() != Eigen::Success)
+        return Eigen::VectorXd::Constant(
+            b.size(), std::numeric_limits<double>::quiet_NaN());
+    return lu.solve(b);
+}
+
+// Estimate of ||A^-1|| in 1-norm from the solves of a factorization of A,
+// by Hager's method with Higham's extra test vector (as LAPACK's dlacon)
+static double inverseNormEstimate(
+    Eigen::SparseLU<Eigen::SparseMatrix<double>> &lu, int n)
+{
+    if (n == 0) return 0.0;
+    Eigen::VectorXd x = Eigen::VectorXd::Constant(n, 1.0 / n);
+    double estimate = 0.0;
+    for (int iteration = 0; iteration < 5; iteration++) {
+        Eigen::VectorXd y = lu.solve(x);
+        double norm = y.lpNorm<1>();
+        if (iteration > 0 && norm <= estimate) break;
+        estimate = norm;
+
+        Eigen::VectorXd sign =
+            y.unaryExpr([](double v) { return v < 0.0 ? -1.0 : 1.0; });
+        Eigen::VectorXd z = lu.transpose().solve(sign);
+        int j = 0;
+        z.cwiseAbs().maxCoeff(&j);
+        if (iteration > 0 && std::abs(z(j)) <= z.dot(x)) break;
+        x = Eigen::VectorXd::Unit(n, j);
+    }
+
+    for (int k = 0; k < n; k++)
+        x(k) = (k % 2 ? -1.0 : 1.0) * (1.0 + (n > 1 ? k / (n - 1.0) : 0.0));
+    return std::max(estimate, 2.0 * lu.solve(x).lpNorm<1>() / (3.0 * n));
+}
+
+// m_mapL holds the supernodes of L with the diagonal blocks of U, m_mapU the
+// rest of U. Neither is documented, so the reading is pinned to the vendored
+// Eigen and has to be checked again when it is updated.
+static_assert(EIGEN_VERSION_AT_LEAST(3, 4, 0) &&
+                  !EIGEN_VERSION_AT_LEAST(3, 4, 1),
+              "upperFactorPivots reads the SparseLU storage of Eigen 3.4.0");
+
+double upperFactorPivots(
+    const Eigen::SparseLU<Eigen::SparseMatrix<double>> &lu,
+    Eigen::VectorXd &pivots)
+{
+    const int n = int(lu.cols());
+    const auto &L = lu.matrixL().m_mapL;
+    const auto &U = lu.matrixU().m_mapU;
+    typedef typename std::decay<decltype(L)>::type Supernodal;
+    typedef typename std::decay<decltype(U)>::type Upper;
+
+    double umax = 0.0;
+    pivots = Eigen::VectorXd::Zero(n);
+    for (int col = 0; col < n; col++) {
+        for (typename Supernodal::InnerIterator it(L, col); it; ++it) {
+            if (it.row() > col) continue;
+            umax = std::max(umax, std::abs(it.value()));
+            if (it.row() == col) pivots(col) = it.value();
+        }
+        for (typename Upper::InnerIterator it(U, col); it; ++it)
+            umax = std::max(umax, std::abs(it.value()));
+    }
+    return umax;
+}
+
+// Condition estimate, pivot growth and smallest pivot of a sparse LU
+// factorization of A
+static void diagnoseSparse(
+    Eigen::SparseLU<Eigen::SparseMatrix<double>> &lu,
+    const Eigen::SparseMatrix<double> &A, SolveReport &report)
+{
+    const int n = int(A.cols());
+    double amax = 0.0, anorm = 0.0;
+    for (int col = 0; col < n; col++) {
+        double sum = 0.0;
+        for (Eigen::SparseMatrix<double>::InnerIterator it(A, col); it; ++it) {
+            amax = std::max(amax, std::abs(it.value()));
+            sum += std::abs(it.value());
+        }
+        anorm = std::max(anorm, sum);
+    }
+
+    // Column j of the factors is column perm_c^-1(j) of A
+    Eigen::VectorXd factorPivots;
+    double umax = upperFactorPivots(lu, factorPivots);
+    Eigen::VectorXd pivots(n);
+    for (int col = 0; col < n; col++)
+        pivots(col) = factorPivots(lu.colsPermutation().indices()(col));
+    recordPivots(amax, umax, pivots, report);
+    double inverse = inverseNormEstimate(lu, n);
+    report.rcond = anorm * inverse > 0.0 ? 1.0 / (anorm * inverse) : 0.0;
+}
+
+Eigen::VectorXd solveSparse(const Eigen::SparseMatrix<double> &A,
+                            const Eigen::VectorXd &b, bool equilibrate,
+                            SolveReport &report)
+{
+    Eigen::SparseLU<Eigen::SparseMatrix<double>> lu;
+    lu.compute(A);
+    if (lu.info() != Eigen::Success)
+        return Eigen::VectorXd::Constant(
+            b.size(), std::numeric_limits<double>::quiet_NaN());
+    diagnoseSparse(lu, A, report);
+    Eigen::VectorXd x = lu.solve(b);
+
+    if (equilibrate && report.rcond < illConditioned) {
+        Eigen::VectorXd rows, cols;
+        equilibrationScales(A, rows, cols);
+        Eigen::SparseMatrix<double> scaled =
+            rows.asDiagonal() * A * cols.asDiagonal();
+        lu.compute(scaled);
+        SolveReport equilibrated;
+        if (lu.info() == Eigen::Success) {
+            diagnoseSparse(lu, scaled, equilibrated);
+            if (equilibrated.rcond > report.rcond) {
+                report = equilibrated;
+                report.equilibrated = true;
+                x = cols.cwiseProduct(lu.solve(rows.cwiseProduct(b)));
+            }
+        }
+    }
+
+    report.residual = scaledResidual(A, x, b);
+    return x;
+}
+
+Eigen::VectorXd solveSparse(const Eigen::SparseMatrix<double> &A,
+                            const Eigen::VectorXd &b,
+                            const Eigen::MatrixXd &seeds,
+                            Eigen::MatrixXd &adjoints)
+{
+    Eigen::SparseLU<Eigen::SparseMatrix<double>> lu;
+    lu.compute(A);
+    if (lu.info() != Eigen::Success) {
+        adjoints = Eigen::MatrixXd::Constant(
+            seeds.rows(), seeds.cols(),
+            std::numeric_limits<double>::quiet_NaN());
+        return Eigen::VectorXd::Constant(
+            b.size(), std::numeric_limits<double>::quiet_NaN());
+    }
+    adjoints = lu.transpose().solve(seeds);
+    return lu.solve(b);
+}
+
+Eigen::MatrixXd solveDenseBlock(Eigen::Ref<Eigen::MatrixXd> A,
+                                const Eigen::Ref<const Eigen::MatrixXd> &B)
+{
+    Eigen::PartialPivLU<Eigen::Ref<Eigen::MatrixXd>> lu(A);
+    return lu.solve(B);
+}
+
+Eigen::MatrixXd solveSparseBlock(const Eigen::SparseMatrix<double> &A,
+                                 const Eigen::Ref<const Eigen::MatrixXd> &B)
+{
+    Eigen::SparseLU<Eigen::SparseMatrix<double>> lu;
+    lu.compute(A);
+    if (lu.info() != Eigen::Success)
+        return Eigen::MatrixXd::Constant(
+            B.rows(), B.cols(), std::numeric_limits<double>::quiet_NaN());
+    return lu.solve(B);
+}
+
+// Power of 2 closest to 1 / magnitude, 1 for an empty row or column
+static double inverseScale(double magnitude)
+{
+    return magnitude > 0.0 ? std::exp2(-std::round(std::log2(magnitude)))
+                           : 1.0;
+}
+
+void equilibrationScales(const Eigen::Ref<const Eigen::MatrixXd> &A,
+                         Eigen::VectorXd &rows, Eigen::VectorXd &cols)
+{
+    rows = A.cwiseAbs().rowwise().maxCoeff().unaryExpr(&inverseScale);
+    cols = (rows.asDiagonal() * A)
+               .cwiseAbs()
+               .colwise()
+               .maxCoeff()
+               .transpose()
+               .unaryExpr(&inverseScale);
+}
+
+void equilibrationScales(const Eigen::SparseMatrix<double> &A,
+                         Eigen::VectorXd &rows, Eigen::VectorXd &cols)
+{
+    Eigen::VectorXd largest = Eigen::VectorXd::Zero(A.rows());
+    for (int col = 0; col < A.outerSize(); col++)
+        for (Eigen::SparseMatrix<double>::InnerIterator it(A, col); it; ++it)
+            largest(it.row()) =
+                std::max(largest(it.row()), std::abs(it.value()));
+    rows = largest.unaryExpr(&inverseScale);
+
+    cols.resize(A.cols());
+    for (int col = 0; col < A.outerSize(); col++) {
+        double magnitude = 0.0;
+        for (Eigen::SparseMatrix<double>::InnerIterator it(A, col); it; ++it)
+            magnitude =
+                std::max(magnitude, std::abs(rows(it.row()) * it.value()));
+        cols(col) = inverseScale(magnitude);
+    }
+}
@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
+ * Reserved. Permission to use, copy, modify and distribute this software for
+ * educational, research, and not-for-profit purposes, without fee and without a
+ * signed license agreement, is hereby granted, provided that this paragraph and
+ * the following two paragraphs appear in all copies, modifications, and
+ * distributions.
+ *
+ * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
+ * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
+ * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
+ *
+ * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
+ * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+/**
+ * @file MatrixMarket.cpp
+ *
+ * @brief Contains the implementation of the Matrix Market export and import
+ */
+
+#include "../../include/MatrixMarket.hpp"
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+using std::cout, std::endl;
+
+int writeMatrixMarket(const std::string &base,
+                      const Eigen::SparseMatrix<double> &A,
+                      const Eigen::VectorXd &b,
+                      const std::vector<std::string> &names)
+{
+    std::ofstream matrix(base + ".mtx"), rhs(base + ".rhs.mtx"),
+        nameFile(base + ".names");
+    if (!matrix || !rhs || !nameFile) {
+        cout << "Error: Cannot write the Matrix Market files " + base + ".*"
+             << endl;
+        return 1;
+    }
+
+    matrix << std::setprecision(17);
+    matrix << "%%MatrixMarket matrix coordinate real general\n"
+           << "% SNU Spice MNA matrix, unknown names in " + base + ".names\n"
+           << A.rows() << " " << A.cols() << " " << A.nonZeros() << "\n";
+    for (int col = 0; col < A.outerSize(); col++)
+        for (Eigen::SparseMatrix<double>::InnerIterator entry(A, col); entry;
+             ++entry)
+            matrix << entry.row() + 1 << " " << entry.col() + 1 << " "
+                   << entry.value() << "\n";
+
+    rhs << std::setprecision(17);
+    rhs << "%%MatrixMarket matrix array real general\n"
+        << "% SNU Spice MNA right hand side\n"
+        << b.size() << " 1\n";
+    for (int row = 0; row < b.size(); row++) rhs << b(row) << "\n";
+
+    for (size_t k = 0; k < names.size(); k++)
+        nameFile << k + 1 << " " << names[k] << "\n";
+
+    matrix.close();
+    rhs.close();
+    nameFile.close();
+    if (matrix.fail() || rhs.fail() || nameFile.fail()) {
+        cout << "Error: Cannot write the Matrix Market files " + base + ".*"
+             << endl;
+        return 1;
+    }
+    return 0;
+}
+
+// Reads the banner and comments, returns the first data line. Only general
+// matrices are read, the symmetric ones store half of their entries.
+static bool readHeader(std::ifstream &file, const std::string &format,
+                       std::string &line)
+{
+    if (!getline(file, line)) return false;
+
+    std::stringstream banner(line);
+    std::string word, object, kind, field, symmetry;
+    banner >> word >> object >> kind >> field >> symmetry;
+    if (word != "%%MatrixMarket" || object != "matrix" || kind != format ||
+        field != "real" || symmetry != "general")
+        return false;
+
+    while (getline(file, line))
+        if (!line.empty() && line[0] != '%') return true;
+    return false;
+}
+
+int readMatrixMarket(const std::string &base, Eigen::SparseMatrix<double> &A,
+                     Eigen::VectorXd &b, std::vector<std::string> &names)
+{
+    std::ifstream matrix(base + ".mtx");
+    std::string line;
+    if (!matrix || !readHeader(matrix, "coordinate", line)) {
+        cout << "Error: " + base +
+                    ".mtx is not a real general coordinate Matrix Market file"
+             << endl;
+        return 1;
+    }
+
+    long rows = 0, cols = 0, nonZeros = 0;
+    std::stringstream(line) >> rows >> cols >> nonZeros;
+    if (rows <= 0 || rows != cols) {
+        cout << "Error: " + base + ".mtx must hold a square matrix" << endl;
+        return 1;
+    }
+
+    std::vector<Eigen::Triplet<double>> triplets;
+    triplets.reserve(nonZeros);
+    long row, col;
+    double value;
+    while (matrix >> row >> col >> value) {
+        if (row < 1 || row > rows || col < 1 || col > cols) {
+            cout << "Error: Entry (" << row << ", " << col
+                 << ") is outside the matrix in " + base + ".mtx" << endl;
+            return 1;
+        }
+        triplets.emplace_back(row - 1, col - 1, value);
+    }
+    if (long(triplets.size()) != nonZeros) {
+        cout << "Error: " + base + ".mtx declares " << nonZeros
+             << " entries but holds " << triplets.size() << endl;
+        return 1;
+    }
+
+    A.resize(rows, cols);
+    A.setFromTriplets(triplets.begin(), triplets.end());
+    A.makeCompressed();
+
+    b = Eigen::VectorXd::Ones(rows);
+    std::ifstream rhs(base + ".rhs.mtx");
+    if (rhs) {
+        long size = 0, columns = 0;
+        if (!readHeader(rhs, "array", line) ||
+            !(std::stringstream(line) >> size >> columns) || size != rows) {
+            cout << "Error: " + base + ".rhs.mtx does not match the matrix"
+                 << endl;
+            return 1;
+        }
+        for (long k = 0; k < rows; k++)
+            if (!(rhs >> b(k))) {
+                cout << "Error: " + base + ".rhs.mtx holds fewer than "
+                     << rows << " values" << endl;
+                return 1;
+            }
+    }
+
+    names.resize(rows);
+    for (long k = 0; k < rows; k++) names[k] = std::to_string(k + 1);
+    std::ifstream nameFile(base + ".names");
+    std::string name;
+    while (nameFile >> row >> name)
+        if (row >= 1 && row <= rows) names[row - 1] = name;
+
+    return 0;
+}
@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
+ * Reserved. Permission to use, copy, modify and distribute this software for
+ * educational, research, and not-for-profit purposes, without fee and without a
+ * signed license agreement, is hereby granted, provided that this paragraph and
+ * the following two paragraphs appear in all copies, modifications, and
+ * distributions.
+ *
+ * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
+ * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
+ * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
+ *
+ * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
+ * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ */
+/**
+ * @file Memory.cpp
+ *
+ * @brief Contains the implementation of the memory planning and measurement
+ */
+
+#include "../../include/Memory.hpp"
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include "../../include/Stamp.hpp"
+
+using std::cout, std::endl;
+
+std::string formatBytes(std::size_t bytes)
+{
+    const char *units[3] = {"KB", "MB", "GB"};
+    double value = double(bytes) / 1024.0;
+    int unit = 0;
+    for (; unit < 2 && value >= 1024.0; unit++) value /= 1024.0;
+
+    std::stringstream text;
+    text << std::fixed << std::setprecision(1) << value << " " << units[unit];
+    return text.str();
+}
+
+// Value of a "<key>: <n> kB" line of /proc/self/status, 0 if missing
+static std::size_t statusBytes(const std::string &key)
+{
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (getline(status, line)) {
+        if (line.compare(0, key.size(), key) != 0) continue;
+        std::stringstream ss(line.substr(key.size()));
+        std::size_t kilobytes = 0;
+        ss >> kilobytes;
+        return kilobytes * 1024;
+    }
+    return 0;
+}
+
+const char *solvePathName(SolvePath path)
+{
+    switch (path) {
+        case denseSolve:
+            return "dense LU";
+        case mixedSolve:
+            return "mixed precision LU";
+        case outOfCoreSolve:
+            return "out-of-core band LU";
+        default:
+            return "sparse LU";
+    }
+}
+
+std::size_t estimateSolveBytes(SolvePath path, std::size_t unknowns,
+                               std::size_t elements)
+{
+    // Sentinel row and column of ground included
+    std::size_t n = unknowns + 1;
+    std::size_t common = elements * sizeof(StampRecord) +
+                         4 * n * sizeof(double) + unknowns * sizeof(int);
+    std::size_t dense = n * n * sizeof(double);
+
+    if (path == denseSolve) return common + dense;
+    // The single precision factors, or the double precision copy that
+    // replaces them when the refinement does not converge
+    if (path == mixedSolve)
+        return common + dense + unknowns * unknowns * sizeof(double);
+
+    // Ordering, pivots and the permuted right hand side; the stamps and the
+    // factors are on disk
+    if (path == outOfCoreSolve)
+        return common + n * (2 * sizeof(int) + 2 * sizeof(std::size_t) +
+                             sizeof(double));
+
+    // Triplets, the compressed matrix, the factors and the workspace of the
+    // supernodal factorization
+    std::size_t nonZeros = elements * stampEntriesPerElement + unknowns;
+    std::size_t entry = sizeof(double) + sizeof(int);
+    return common + nonZeros * sizeof(Eigen::Triplet<double>) +
+           nonZeros * entry + nonZeros * sparseFillFactor * entry +
+           16 * n * sizeof(int);
+}
+
+MemoryPlan planMemory(const std::vector<Island> &islands,
+                      const std::map<std::string, int> &indexMap,
+                      std::size_t threadCount, SolvePath preferred,
+                      std::size_t limit, bool outOfCore)
+{
+    MemoryPlan plan;
+    plan.resident = residentBytes();
+
+    std::vector<SolvePath> order = {preferred};
+    for (SolvePath path : {sparseSolve, denseSolve, mixedSolve})
+        if (path != preferred) order.push_back(path);
+    if (outOfCore) order.push_back(outOfCoreSolve);
+
+    bool picked = false;
+    for (SolvePath path : order) {
+        std::vector<std::size_t> bytes;
+        for (const Island &island : islands) {
+            if (!island.valid) continue;
+            std::size_t unknowns = island.nodes.size();
+            for (const std::shared_ptr<CircuitElement> &element :
+                 island.elements)
+                unknowns += indexMap.count(element->name);
+            bytes.push_back(
+                estimateSolveBytes(path, unknowns, island.elements.size()));
+        }
+
+        // The largest islands may be solved at the same time
+        std::sort(bytes.begin(), bytes.end(), std::greater<std::size_t>());
+        bytes.resize(std::min(bytes.size(), std::max<std::size_t>(
+                                                  threadCount, 1)));
+        std::size_t peak = indexMap.size() * sizeof(double);
+        for (std::size_t island : bytes) peak += island;
+        plan.candidates.push_back({path, peak});
+
+        if (!picked && (limit == 0 || plan.resident + peak <= limit)) {
+            plan.path = path;
+            picked = true;
+        }
+    }
+    plan.fits = picked;
+    return plan;
+}
+
+void printMemoryPlan(const MemoryPlan &plan, std::size_t limit)
+{
+    cout << "\nMemory plan (limit " << formatBytes(limit) << ", "
+         << formatBytes(plan.resident) << " resident):" << endl;
+    for (const MemoryEstimate &estimate : plan.candidates) {
+        cout << "  " << std::left << std::setw(24)
+             << solvePathName(estimate.path) << std::right << std::setw(12)
+             << formatBytes(estimate.bytes);
+        if (plan.fits && estimate.path == plan.path) cout << "  picked";
+        cout << endl;
+    }
+}
+
+std::size_t peakResidentBytes()
+{
+    std::size_t peak = statusBytes("VmHWM:");
+    if (peak != 0) return peak;
+
+    // ru_maxrss is in kilobytes on Linux
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return std::size_t(usage.ru_maxrss) * 1024;
+}
+
+std::size_t residentBytes() { return statusBytes("VmRSS:"); }
+
+void resetPeakResident()
+{
+    // Writing 5 to clear_refs resets VmHWM (Linux 4.0 and later)
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    if (clearRefs) clearRefs << "5";
+}
+
+void PhaseMemory::record(const std::string &phase)
+{
+    phases.emplace_back(phase, peakResidentBytes());
+    resetPeakResident();
+}
+
+void PhaseMemory::print() const
+{
+    cout << "\nPeak memory:";
+    for (size_t k = 0; k < phases.size(); k++)
+        cout << (k == 0 ? " " : ", ") << phases[k].first << " "
+             << formatBytes(phases[k].second);
+    cout << endl;
+}
@@ -0,0 +1,370 @@
+/*
+ * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
+ * Reserved. Permission to use, copy, modify and distribute this software for
+ * educational, research, and not-for-profit purposes, without fee and without a
+ * signed license agreement, is hereby granted, provided that this paragraph and
+ * the following two paragraphs appear in all copies, modifications, and
+ * distributions.
+ *
+ * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
+ * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
+ * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
+ *
+ * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
+ * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+/**
+ * @file ModelReduction.cpp
+ *
+ * @brief Contains the implementation of the PRIMA model order reduction
+ */
+
+#include "../../include/ModelReduction.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <set>
+
+#include "../../lib/external/Eigen/Sparse"
+#include "../../lib/external/Eigen/SparseLU"
+
+using std::cout, std::endl;
+
+// Columns of W that are not in the span of the basis, orthonormalized
+// against it (modified Gram-Schmidt, twice) and appended to it
+static int appendOrthonormal(const Eigen::MatrixXd &W,
+                             std::vector<Eigen::VectorXd> &basis)
+{
+    int added = 0;
+    for (int col = 0; col < W.cols(); col++) {
+        Eigen::VectorXd w = W.col(col);
+        double norm = w.norm();
+        if (norm == 0) continue;
+        for (int pass = 0; pass < 2; pass++)
+            for (const Eigen::VectorXd &v : basis) w -= v.dot(w) * v;
+        // Columns already in the span are deflated
+        if (w.norm() <= 1e-10 * norm) continue;
+        basis.push_back(w / w.norm());
+        added++;
+    }
+    return added;
+}
+
+static int findRoot(std::vector<int> &parent, int k)
+{
+    while (parent[k] != k) k = parent[k] = parent[parent[k]];
+    return k;
+}
+
+// Builds the model of one subnetwork: its MNA matrices over [ports;
+// internal nodes; inductor currents], a Krylov basis of the internal
+// unknowns, and the congruence transform
+static int reduceSubnetwork(
+    const std::vector<std::shared_ptr<CircuitElement>> &elements,
+    const std::set<std::string> &ports, int moments, ReducedModel &model)
+{
+    std::map<std::string, int> index;
+    for (const std::shared_ptr<CircuitElement> &element : elements)
+        for (const std::string &node : {element->nodeA, element->nodeB})
+            if (node != "0" && ports.count(node)) index.emplace(node, 0);
+    int p = 0;
+    for (auto &entry : index) {
+        entry.second = p++;
+        model.ports.push_back(entry.first);
+    }
+    int n = p;
+    for (const std::shared_ptr<CircuitElement> &element : elements)
+        for (const std::string &node : {element->nodeA, element->nodeB})
+            if (node != "0" && index.emplace(node, n).second) n++;
+    for (const std::shared_ptr<CircuitElement> &element : elements)
+        if (element->type == L) index[element->name] = n++;
+
+    // G + G^T and C are positive semidefinite in this form, which the
+    // congruence transform preserves
+    std::vector<Eigen::Triplet<double>> g, c;
+    auto stamp = [&](std::vector<Eigen::Triplet<double>> &triplets,
+                     const CircuitElement &element, double value) {
+        int a = element.nodeA != "0" ? index.at(element.nodeA) : -1;
+        int b = element.nodeB != "0" ? index.at(element.nodeB) : -1;
+        if (a >= 0) triplets.emplace_back(a, a, value);
+        if (b >= 0) triplets.emplace_back(b, b, value);
+        if (a >= 0 && b >= 0) {
+            triplets.emplace_back(a, b, -value);
+            triplets.emplace_back(b, a, -value);
+        }
+    };
+    for (const std::shared_ptr<CircuitElement> &element : elements) {
+        if (element->type == R) stamp(g, *element, 1.0 / element->value);
+        if (element->type == C) stamp(c, *element, element->value);
+        if (element->type != L) continue;
+        int k = index.at(element->name);
+        for (int sign : {1, -1}) {
+            const std::string &node = sign > 0 ? element->nodeA
+                                               : element->nodeB;
+            if (node == "0") continue;
+            g.emplace_back(index.at(node), k, sign);
+            g.emplace_back(k, index.at(node), -sign);
+        }
+        c.emplace_back(k, k, element->value);
+    }
+    Eigen::SparseMatrix<double> Gfull(n, n), Cfull(n, n);
+    Gfull.setFromTriplets(g.begin(), g.end());
+    Cfull.setFromTriplets(c.begin(), c.end());
+
+    const int N = n - p;
+    model.internal = N;
+    model.elements = int(elements.size());
+    Eigen::SparseMatrix<double> Gii = Gfull.bottomRightCorner(N, N);
+    Eigen::SparseMatrix<double> Cii = Cfull.bottomRightCorner(N, N);
+    Eigen::MatrixXd Gip = Gfull.bottomLeftCorner(N, p);
+    Eigen::MatrixXd Cip = Cfull.bottomLeftCorner(N, p);
+
+    Eigen::SparseLU<Eigen::SparseMatrix<double>,
+                    Eigen::COLAMDOrdering<int>>
+        lu;
+    Gii.makeCompressed();
+    lu.compute(Gii);
+    if (lu.info() != Eigen::Success) {
+        cout << "Error: Passive subnetwork of " + elements.front()->name +
+                    " has no DC path to a port or ground"
+             << endl;
+        return 1;
+    }
+
+    // Block Arnoldi: the internal response to the port voltages is
+    // x(s) = -(Gii + s Cii)^-1 (Gip + s Cip) v, whose moments span the
+    // Krylov space of Gii^-1 Cii started from Gii^-1 [Gip Cip]
+    std::vector<Eigen::VectorXd> basis;
+    Eigen::MatrixXd start(N, 2 * p);
+    start << Gip, Cip;
+    size_t blockBegin = basis.size();
+    appendOrthonormal(lu.solve(start), basis);
+    for (int block = 1; block < moments; block++) {
+        size_t blockEnd = basis.size();
+        if (blockEnd == blockBegin) break;
+        Eigen::MatrixXd V(N, blockEnd - blockBegin);
+        for (size_t k = blockBegin; k < blockEnd; k++)
+            V.col(k - blockBegin) = basis[k];
+        blockBegin = blockEnd;
+        appendOrthonormal(lu.solve(Eigen::MatrixXd(Cii * V)), basis);
+    }
+
+    const int k = int(basis.size());
+    Eigen::MatrixXd V(N, k);
+    for (int col = 0; col < k; col++) V.col(col) = basis[col];
+
+    // Congruence transform with blockdiag(I, V): the ports stay as they are
+    auto project = [&](const Eigen::SparseMatrix<double> &full,
+                       Eigen::MatrixXd &reduced) {
+        Eigen::SparseMatrix<double> ii = full.bottomRightCorner(N, N);
+        Eigen::SparseMatrix<double> ip = full.bottomLeftCorner(N, p);
+        Eigen::SparseMatrix<double> pi = full.topRightCorner(p, N);
+        reduced.resize(p + k, p + k);
+        reduced.topLeftCorner(p, p) = full.topLeftCorner(p, p);
+        reduced.topRightCorner(p, k) = pi * V;
+        reduced.bottomLeftCorner(k, p) = V.transpose() * ip;
+        reduced.bottomRightCorner(k, k) = V.transpose() * (ii * V);
+    };
+    project(Gfull, model.G);
+    project(Cfull, model.C);
+    return 0;
+}
+
+int reduceNetworks(Parser &parser, int moments,
+                   std::vector<ReducedModel> &models)
+{
+    // Elements whose current or value is needed are not replaced
+    std::set<std::string> kept(parser.probes.begin(), parser.probes.end());
+    kept.insert(parser.sensitivities.begin(), parser.sensitivities.end());
+    for (std::shared_ptr<CircuitElement> element : parser.currentProbes)
+        kept.insert(element->name);
+    for (std::shared_ptr<CircuitElement> element : parser.circuitElements)
+        if (element->controlling_variable != none)
+            kept.insert(element->controlling_element->name);
+    auto passive = [&](const CircuitElement &element) {
+        return (element.type == L ||
+                ((element.type == R || element.type == C) &&
+                 element.group == G1)) &&
+               !kept.count(element.name);
+    };
+
+    // Ports: nodes of the other elements and probed nodes
+    std::set<std::string> ports(kept.begin(), kept.end());
+    for (std::shared_ptr<CircuitElement> element : parser.circuitElements)
+        if (!passive(*element)) {
+            ports.insert(element->nodeA);
+            ports.insert(element->nodeB);
+        }
+
+    // Subnetworks: connected sets of internal nodes
+    std::map<std::string, int> internal;
+    for (std::shared_ptr<CircuitElement> element : parser.circuitElements)
+        if (passive(*element))
+            for (const std::string &node : {element->nodeA, element->nodeB})
+                if (node != "0" && !ports.count(node))
+                    internal.emplace(node, int(internal.size()));
+    std::vector<int> parent(internal.size());
+    std::iota(parent.begin(), parent.end(), 0);
+    for (std::shared_ptr<CircuitElement> element : parser.circuitElements) {
+        if (!passive(*element) || !internal.count(element->nodeA) ||
+            !internal.count(element->nodeB))
+            continue;
+        parent[findRoot(parent, internal[element->nodeA])] =
+            findRoot(parent, internal[element->nodeB]);
+    }
+
+    // An element belongs to the subnetwork of its internal terminal; one
+    // between two ports is kept as it is
+    std::map<int, std::vector<std::shared_ptr<CircuitElement>>> subnetworks;
+    std::vector<std::shared_ptr<CircuitElement>> remaining;
+    for (std::shared_ptr<CircuitElement> element : parser.circuitElements) {
+        std::map<std::string, int>::iterator a = internal.find(element->nodeA);
+        std::map<std::string, int>::iterator b = internal.find(element->nodeB);
+        if (!passive(*element) || (a == internal.end() && b == internal.end()))
+            remaining.push_back(element);
+        else
+            subnetworks[findRoot(parent, (a != internal.end() ? a : b)->second)]
+                .push_back(element);
+    }
+
+    int errors = 0;
+    parser.circuitElements = remaining;
+    for (auto &subnetwork : subnetworks) {
+        ReducedModel model;
+        errors += reduceSubnetwork(subnetwork.second, ports, moments, model);
+        if (model.G.size() == 0) continue;
+        errors += stampReducedModel(parser, model,
+                                    "MOR" + std::to_string(models.size()));
+        models.push_back(model);
+    }
+
+    // Internal nodes and inductor currents are no longer unknowns
+    for (auto &entry : internal) parser.nodes_group2.erase(entry.first);
+    for (auto &subnetwork : subnetworks)
+        for (std::shared_ptr<CircuitElement> element : subnetwork.second)
+            if (element->type == L) parser.nodes_group2.erase(element->name);
+
+    return errors;
+}
+
+bool dcAdmittance(const ReducedModel &model, Eigen::MatrixXd &Y)
+{
+    const int p = int(model.ports.size());
+    const int k = int(model.G.rows()) - p;
+    Y = model.G.topLeftCorner(p, p);
+    if (k == 0) return true;
+    Eigen::FullPivLU<Eigen::MatrixXd> lu(model.G.bottomRightCorner(k, k));
+    if (!lu.isInvertible()) return false;
+    Y -= model.G.topRightCorner(p, k) *
+         lu.solve(model.G.bottomLeftCorner(k, p));
+    return true;
+}
+
+int stampReducedModel(Parser &parser, const ReducedModel &model,
+                      const std::string &name)
+{
+    Eigen::MatrixXd Y;
+    if (!dcAdmittance(model, Y)) {
+        cout << "Error: Reduced model " + name + " is singular at DC" << endl;
+        return 1;
+    }
+
+    // Couplings below rounding of the largest admittance are dropped
+    const int p = int(model.ports.size());
+    const double threshold = 1e-12 * Y.cwiseAbs().maxCoeff();
+    int count = 0;
+    auto add = [&](const std::string &nodeA, const std::string &nodeB,
+                   double conductance) {
+        if (std::abs(conductance) <= threshold) return;
+        std::shared_ptr<CircuitElement> element =
+            std::make_shared<CircuitElement>();
+        element->name = "R" + name + "_" + std::to_string(count++);
+        element->type = R;
+        element->nodeA = nodeA;
+        element->nodeB = nodeB;
+        element->group = G1;
+        element->value = 1.0 / conductance;
+        element->controlling_variable = none;
+        element->controlling_element = NULL;
+        element->processed = false;
+        parser.circuitElements.push_back(element);
+        parser.nodes_group2.insert(nodeA);
+        parser.nodes_group2.insert(nodeB);
+    };
+    for (int a = 0; a < p; a++) {
+        for (int b = a + 1; b < p; b++)
+            add(model.ports[a], model.ports[b],
+                -0.5 * (Y(a, b) + Y(b, a)));
+        add(model.ports[a], "0", Y.row(a).sum());
+    }
+    return 0;
+}
+
+int saveReducedModels(const std::string &file,
+                      const std::vector<ReducedModel> &models)
+{
+    std::ofstream stream(file);
+    if (!stream) {
+        cout << "Error: Cannot write the reduced models to " + file << endl;
+        return 1;
+    }
+    stream << "SNUROM1 " << models.size() << "\n" << std::setprecision(17);
+    for (const ReducedModel &model : models) {
+        stream << model.ports.size() << " " << model.G.rows() << " "
+               << model.internal << " " << model.elements << "\n";
+        for (const std::string &port : model.ports) stream << port << "\n";
+        for (const Eigen::MatrixXd *matrix : {&model.G, &model.C})
+            for (int row = 0; row < matrix->rows(); row++) {
+                for (int col = 0; col < matrix->cols(); col++)
+                    stream << (col > 0 ? " " : "") << (*matrix)(row, col);
+                stream << "\n";
+            }
+    }
+    return stream ? 0 : 1;
+}
+
+int loadReducedModels(const std::string &file,
+                      std::vector<ReducedModel> &models)
+{
+    std::ifstream stream(file);
+    if (!stream) {
+        cout << "Error: Reduced model file " + file + " not available" << endl;
+        return 1;
+    }
+    std::string magic;
+    size_t count = 0;
+    if (!(stream >> magic >> count) || magic != "SNUROM1") {
+        cout << "Error: " + file + " is not a reduced model file" << endl;
+        return 1;
+    }
+    for (size_t k = 0; k < count; k++) {
+        ReducedModel model;
+        size_t ports = 0;
+        int size = 0;
+        stream >> ports >> size >> model.internal >> model.elements;
+        model.ports.resize(ports);
+        for (std::string &port : model.ports) stream >> port;
+        model.G.resize(size, size);
+        model.C.resize(size, size);
+        for (Eigen::MatrixXd *matrix : {&model.G, &model.C})
+            for (int row = 0; row < size; row++)
+                for (int col = 0; col < size; col++)
+                    stream >> (*matrix)(row, col);
+        if (!stream || size < int(ports)) {
+            cout << "Error: Reduced model " << k << " of " + file +
+                        " is truncated"
+                 << endl;
+            return 1;
+        }
+        models.push_back(model);
+    }
+    return 0;
+}
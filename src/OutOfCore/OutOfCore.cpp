@@ -0,0 +1,273 @@
+/*
+ * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
+ * Reserved. Permission to use, copy, modify and distribute this software for
+ * educational, research, and not-for-profit purposes, without fee and without a
+ * signed license agreement, is hereby granted, provided that this paragraph and
+ * the following two paragraphs appear in all copies, modifications, and
+ * distributions.
+ *
+ * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
+ * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
+ * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
+ *
+ * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
+ * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+/**
+ * @file OutOfCore.cpp
+ *
+ * @brief Contains the implementation of the out-of-core solve
+ */
+
+#include "../../include/OutOfCore.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "../../include/Scratch.hpp"
+#include "../../include/Stamp.hpp"
+
+/** @struct SpilledEntry
+ *
+ * @brief One stamp of the matrix in a scratch file
+ * */
+struct SpilledEntry
+{
+    int row;      /**< Row of the entry */
+    int col;      /**< Column of the entry */
+    double value; /**< Value added */
+};
+
+/** @struct CountingSink
+ *
+ * @brief Counts the stamps of the matrix outside the sentinel
+ * */
+struct CountingSink
+{
+    int m;                 /**< Sentinel index */
+    std::size_t count = 0; /**< Stamps counted */
+
+    void add(int row, int col, double)
+    {
+        if (row < m && col < m) count++;
+    }
+    void addRhs(int, double) {}
+};
+
+/** @struct SpillSink
+ *
+ * @brief Writes the stamps of the matrix outside the sentinel to a mapped
+ * array
+ * */
+struct SpillSink
+{
+    int m;              /**< Sentinel index */
+    SpilledEntry *next; /**< Where the next stamp goes */
+
+    void add(int row, int col, double value)
+    {
+        if (row < m && col < m) *next++ = {row, col, value};
+    }
+    void addRhs(int, double) {}
+};
+
+// Reverse Cuthill-McKee order of the symmetrized pattern: position[k] is
+// the new index of unknown k
+static bool orderBand(MappedArray<SpilledEntry> &entries, int m,
+                      const std::string &scratch, std::vector<int> &position)
+{
+    std::vector<std::size_t> offsets(m + 1, 0);
+    for (const SpilledEntry &entry : entries)
+        if (entry.row != entry.col) {
+            offsets[entry.row + 1]++;
+            offsets[entry.col + 1]++;
+        }
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+    MappedArray<int> neighbors;
+    if (!neighbors.create(scratch, offsets[m])) return false;
+    std::vector<std::size_t> fill(offsets.begin(), offsets.end() - 1);
+    for (const SpilledEntry &entry : entries)
+        if (entry.row != entry.col) {
+            neighbors[fill[entry.row]++] = entry.col;
+            neighbors[fill[entry.col]++] = entry.row;
+        }
+    auto degree = [&](int k) { return offsets[k + 1] - offsets[k]; };
+
+    // Every component starts from its unknown of least degree
+    std::vector<int> starts(m), order;
+    std::iota(starts.begin(), starts.end(), 0);
+    std::stable_sort(starts.begin(), starts.end(),
+                     [&](int a, int b) { return degree(a) < degree(b); });
+    std::vector<bool> visited(m, false);
+    order.reserve(m);
+    std::vector<int> next;
+    for (int start : starts) {
+        if (visited[start]) continue;
+        visited[start] = true;
+        order.push_back(start);
+        for (size_t head = order.size() - 1; head < order.size(); head++) {
+            int k = order[head];
+            next.clear();
+            for (std::size_t n = offsets[k]; n < offsets[k + 1]; n++)
+                if (!visited[neighbors[n]]) {
+                    visited[neighbors[n]] = true;
+                    next.push_back(neighbors[n]);
+                }
+            std::stable_sort(next.begin(), next.end(), [&](int a, int b) {
+                return degree(a) < degree(b);
+            });
+            order.insert(order.end(), next.begin(), next.end());
+        }
+    }
+
+    position.resize(m);
+    for (int k = 0; k < m; k++) position[order[k]] = m - 1 - k;
+    return true;
+}
+
+bool solveOutOfCore(const std::vector<StampRecord> &records, int m,
+                    const Eigen::MatrixXd &B, const std::string &scratch,
+                    std::size_t budget, Eigen::MatrixXd &X,
+                    OutOfCoreReport &report)
+{
+    report = OutOfCoreReport();
+    auto fail = [&](const std::string &failure) {
+        report.failure = failure;
+        return false;
+    };
+
+    // Stamps spilled to disk
+    CountingSink counter{m};
+    stampRecords(records, counter);
+    MappedArray<SpilledEntry> entries;
+    if (!entries.create(scratch, counter.count))
+        return fail("cannot map a scratch file in " + scratch);
+    SpillSink spill{m, entries.begin()};
+    stampRecords(records, spill);
+
+    // Entries renumbered into the band and sorted by column
+    std::vector<int> position;
+    if (!orderBand(entries, m, scratch, position))
+        return fail("cannot map a scratch file in " + scratch);
+    int lower = 0, upper = 0;
+    for (SpilledEntry &entry : entries) {
+        entry.row = position[entry.row];
+        entry.col = position[entry.col];
+        lower = std::max(lower, entry.row - entry.col);
+        upper = std::max(upper, entry.col - entry.row);
+    }
+    std::sort(entries.begin(), entries.end(),
+              [](const SpilledEntry &a, const SpilledEntry &b) {
+                  return a.col != b.col ? a.col < b.col : a.row < b.row;
+              });
+
+    // Column j of the band holds rows j - span to j + lower; the pivoting
+    // may widen the upper band by the lower one
+    const int span = upper + lower;
+    const int height = span + lower + 1;
+    const std::size_t column = std::size_t(height) * sizeof(double);
+    report.lower = lower;
+    report.upper = upper;
+    report.window = std::size_t(span + 1) * column;
+    report.factors = std::size_t(m) * column;
+    if (report.window + column > budget)
+        return fail("its band window needs " +
+                    std::to_string(report.window + column) + " bytes");
+    report.panelColumns = int(std::min<std::size_t>(
+        (budget - report.window) / column, std::size_t(std::max(m, 1))));
+    const int width = report.panelColumns;
+
+    ScratchFile factors;
+    if (!factors.open(scratch))
+        return fail("cannot create a scratch file in " + scratch);
+
+    // Columns j to j + span, in a ring
+    std::vector<double> window(std::size_t(span + 1) * height);
+    std::vector<double> panel(std::size_t(width) * height);
+    auto at = [&](int row, int col) -> double & {
+        return window[std::size_t(col % (span + 1)) * height + row - col +
+                      span];
+    };
+    std::size_t nextEntry = 0;
+    int loaded = -1;
+    std::vector<int> pivots(m);
+    for (int j = 0; j < m; j++) {
+        int last = std::min(m - 1, j + span);
+        while (loaded < last) {
+            loaded++;
+            std::fill_n(&at(loaded - span, loaded), height, 0.0);
+            for (; nextEntry < entries.size() &&
+                   entries[nextEntry].col == loaded;
+                 nextEntry++)
+                at(entries[nextEntry].row, loaded) += entries[nextEntry].value;
+        }
+
+        int below = std::min(lower, m - 1 - j);
+        int pivot = j;
+        for (int i = j + 1; i <= j + below; i++)
+            if (std::abs(at(i, j)) > std::abs(at(pivot, j))) pivot = i;
+        if (at(pivot, j) == 0.0) return fail("it is singular");
+        pivots[j] = pivot;
+        if (pivot != j)
+            for (int c = j; c <= last; c++) std::swap(at(j, c), at(pivot, c));
+
+        for (int i = j + 1; i <= j + below; i++) at(i, j) /= at(j, j);
+        for (int c = j + 1; c <= last; c++) {
+            double factor = at(j, c);
+            if (factor == 0.0) continue;
+            for (int i = j + 1; i <= j + below; i++)
+                at(i, c) -= at(i, j) * factor;
+        }
+
+        // The column is final, panels go to disk when full
+        std::copy_n(&at(j - span, j), height,
+                    &panel[std::size_t(j % width) * height]);
+        if (j % width == width - 1 || j == m - 1) {
+            std::size_t bytes = std::size_t(j % width + 1) * column;
+            if (!factors.write(panel.data(), bytes,
+                               std::size_t(j / width) * width * column))
+                return fail("writing its factors failed");
+            report.panels++;
+        }
+    }
+    window = std::vector<double>();
+
+    // Forward substitution with L over the panels in order, then backward
+    // with U in reverse order
+    Eigen::MatrixXd Y(m, B.cols());
+    for (int k = 0; k < m; k++) Y.row(position[k]) = B.row(k);
+    auto load = [&](int p) {
+        int columns = std::min(width, m - p * width);
+        return factors.read(panel.data(), std::size_t(columns) * column,
+                            std::size_t(p) * width * column);
+    };
+    for (int p = 0; p < report.panels; p++) {
+        if (!load(p)) return fail("reading its factors failed");
+        for (int j = p * width; j < std::min(m, (p + 1) * width); j++) {
+            const double *factor = &panel[std::size_t(j % width) * height];
+            Y.row(j).swap(Y.row(pivots[j]));
+            for (int i = 1; i <= std::min(lower, m - 1 - j); i++)
+                Y.row(j + i) -= factor[span + i] * Y.row(j);
+        }
+    }
+    for (int p = report.panels - 1; p >= 0; p--) {
+        if (!load(p)) return fail("reading its factors failed");
+        for (int j = std::min(m, (p + 1) * width) - 1; j >= p * width; j--) {
+            const double *factor = &panel[std::size_t(j % width) * height];
+            Y.row(j) /= factor[span];
+            for (int r = std::max(0, j - span); r < j; r++)
+                Y.row(r) -= factor[r - j + span] * Y.row(j);
+        }
+    }
+
+    X.resize(m, B.cols());
+    for (int k = 0; k < m; k++) X.row(k) = Y.row(position[k]);
+    report.used = true;
+    return true;
+}
@@ -25,6 +25,7 @@
 #include "../../include/Parser.hpp"
 
 #include <algorithm>
+#include <cctype>
 #include <cmath>
 #include <fstream>
 #include <iostream>
@@ -32,9 +33,164 @@
 #include <memory>
 #include <ostream>
 #include <sstream>
+#include <thread>
+#include <unordered_map>
+
+#include "../../include/SpscQueue.hpp"
 
 using std::cout, std::endl;
 
+// Expression without the braces around it
+static std::string stripBraces(const std::string &token)
+{
+    if (token.size() >= 2 && token.front() == '{' && token.back() == '}')
+        return token.substr(1, token.size() - 2);
+    return token;
+}
+
+// Lines per batch passed between the pipeline stages, and batches a queue
+// holds
+constexpr size_t batchLines = 4096;
+constexpr size_t queueBatches = 16;
+
+// A netlist line and its tokens
+struct NetlistLine
+{
+    int number = 0;                  // Line number, from 1
+    std::string original;            // As written
+    std::string line;                // In upper case
+    std::vector<std::string> tokens; // Tokens of the upper case line
+};
+
+// Splits the upper case line into tokens at white space; an expression in
+// braces is one token, spaces and all
+static void tokenize(NetlistLine &netlistLine)
+{
+    std::string &line = netlistLine.line;
+    line = netlistLine.original;
+    std::transform(line.begin(), line.end(), line.begin(), ::toupper);
+
+    std::string joined;
+    int depth = 0;
+    for (char c : line) {
+        if (c == '{') depth++;
+        if (c == '}') depth = std::max(depth - 1, 0);
+        if (depth == 0 || !std::isspace((unsigned char)c)) joined += c;
+    }
+
+    size_t k = 0;
+    while (k < joined.size()) {
+        while (k < joined.size() && std::isspace((unsigned char)joined[k]))
+            k++;
+        size_t start = k;
+        while (k < joined.size() && !std::isspace((unsigned char)joined[k]))
+            k++;
+        if (k > start)
+            netlistLine.tokens.emplace_back(joined, start, k - start);
+    }
+}
+
+// Reads and tokenizes the lines of a netlist ahead of the parser. A reader
+// thread splits the file into batches of lines and a tokenizer thread splits
+// the lines into tokens, connected to each other and to the parser by
+// bounded lock-free queues, so reading, tokenizing and parsing overlap.
+// Without a second core the stages run in turn on the parser's thread.
+class LinePipeline
+{
+   public:
+    explicit LinePipeline(std::istream &stream)
+        : stream(stream),
+          threaded(std::thread::hardware_concurrency() > 1),
+          lines(queueBatches),
+          tokenized(queueBatches)
+    {
+        if (!threaded) return;
+        reader = std::thread([this] { read(); });
+        tokenizer = std::thread([this] { tokenizeLines(); });
+    }
+
+    ~LinePipeline()
+    {
+        if (!threaded) return;
+        NetlistLine line;
+        while (next(line)) continue;
+        reader.join();
+        tokenizer.join();
+    }
+
+    // Next line of the netlist, false after the last one
+    bool next(NetlistLine &line)
+    {
+        if (!threaded) {
+            if (!getline(stream, line.original)) return false;
+            line.number = ++number;
+            line.tokens.clear();
+            tokenize(line);
+            return true;
+        }
+        while (position == batch.size()) {
+            if (!tokenized.pop(batch)) return false;
+            position = 0;
+        }
+        line = std::move(batch[position++]);
+        return true;
+    }
+
+   private:
+    void read()
+    {
+        std::vector<NetlistLine> pending;
+        auto emit = [&](std::string text) {
+            pending.emplace_back();
+            pending.back().number = ++number;
+            pending.back().original = std::move(text);
+            if (pending.size() == batchLines) {
+                lines.push(std::move(pending));
+                pending.clear();
+            }
+        };
+
+        // Lines end at a newline, as with getline
+        std::vector<char> buffer(1 << 20);
+        std::string partial;
+        while (stream) {
+            stream.read(buffer.data(), std::streamsize(buffer.size()));
+            const char *begin = buffer.data();
+            const char *end = begin + stream.gcount();
+            for (const char *newline;
+                 (newline = std::find(begin, end, '\n')) != end;
+                 begin = newline + 1) {
+                partial.append(begin, newline);
+                emit(std::move(partial));
+                partial.clear();
+            }
+            partial.append(begin, end);
+        }
+        if (!partial.empty()) emit(std::move(partial));
+        if (!pending.empty()) lines.push(std::move(pending));
+        lines.close();
+    }
+
+    void tokenizeLines()
+    {
+        std::vector<NetlistLine> lineBatch;
+        while (lines.pop(lineBatch)) {
+            for (NetlistLine &line : lineBatch) tokenize(line);
+            tokenized.push(std::move(lineBatch));
+        }
+        tokenized.close();
+    }
+
+    std::istream &stream; // Netlist
+    bool threaded;        // The stages run on their own threads
+    int number = 0;       // Lines read
+    SpscQueue<std::vector<NetlistLine>> lines;     // Read lines
+    SpscQueue<std::vector<NetlistLine>> tokenized; // Tokenized lines
+    std::vector<NetlistLine> batch; // Batch the parser takes lines from
+    size_t position = 0;            // Next line of the batch
+    std::thread reader, tokenizer;
+};
+
 int Parser::parse(const std::string &fileName)
 {
     cout << "\nFile Name: " + fileName << endl;
@@ -44,46 +200,111 @@ int Parser::parse(const std::string &fileName)
         cout << "Error: Netlist not avialable in the project directory" << endl;
         return 1;
     }
-    std::string line;
-    int lineNumber = 1, v_count = 0, i_count = 0, r_count = 0, c_count = 0,
+    int v_count = 0, i_count = 0, r_count = 0, c_count = 0,
         vc_count = 0, ic_count = 0, error = 0, l_count = 0;
 
     // Stores pointer of all independent sources and resistors
     // for assigning to controlling_element variable later
-    std::map<std::string, std::shared_ptr<CircuitElement>> elementMap;
-
-    while (getline(fileStream, line)) {
-        lineNumber++;
-
-        std::transform(line.begin(), line.end(), line.begin(), ::toupper);
-
-        std::stringstream ss(line);
-        std::vector<std::string> tokens;
-        std::string buf;
-
-        while (ss >> buf) tokens.push_back(buf);
+    std::unordered_map<std::string, std::shared_ptr<CircuitElement>>
+        elementMap;
+
+    // Lines are read and tokenized by the pipeline while the ones before them
+    // are parsed here, in order
+    LinePipeline pipeline(fileStream);
+    NetlistLine netlistLine;
+    while (pipeline.next(netlistLine)) {
+        const int lineNumber = netlistLine.number;
+        const std::string &original = netlistLine.original;
+        const std::string &line = netlistLine.line;
+        const std::vector<std::string> &tokens = netlistLine.tokens;
 
         // Skips empty lines and comments
         if (tokens.size() == 0 || tokens.at(0).find("%") == 0) continue;
 
+        // Directives
+        if (tokens.at(0).find(".") == 0) {
+            if (tokens.at(0) == ".PROBE" || tokens.at(0) == ".PRINT") {
+                for (size_t k = 1; k < tokens.size(); k++)
+                    probes.push_back(probeName(tokens.at(k)));
+            } else if (tokens.at(0) == ".SENS") {
+                for (size_t k = 1; k < tokens.size(); k++)
+                    sensitivities.push_back(probeName(tokens.at(k)));
+            } else if (tokens.at(0) == ".PARAM") {
+                // name=value pairs, the value is an expression
+                for (size_t k = 1; k < tokens.size(); k++) {
+                    size_t equals = tokens.at(k).find('=');
+                    if (equals == 0 || equals == std::string::npos ||
+                        equals + 1 == tokens.at(k).size()) {
+                        cout << "Error: Illegal parameter definition at line "
+                                "number "
+                             << lineNumber << ": " + line << endl;
+                        error += 1;
+                        continue;
+                    }
+                    error += parameters.define(
+                        tokens.at(k).substr(0, equals),
+                        stripBraces(tokens.at(k).substr(equals + 1)),
+                        "at line number " + std::to_string(lineNumber) +
+                            ": " + line);
+                }
+            } else if (tokens.at(0) == ".ROM" && tokens.size() == 2) {
+                // The file name keeps its case
+                std::stringstream names(original);
+                std::string directive, file;
+                names >> directive >> file;
+                reducedModels.push_back(file);
+            } else if (tokens.at(0) == ".DC" && tokens.size() == 5) {
+                double range[3];
+                bool valid = true;
+                for (int k = 0; k < 3; k++)
+                    valid = parseEngineering(tokens.at(k + 2), range[k]) &&
+                            valid;
+                // The step has to lead from start to stop
+                if (!valid || range[2] == 0 ||
+                    (range[1] - range[0]) * range[2] < 0) {
+                    cout << "Error: Illegal sweep range at line number "
+                         << lineNumber << ": " + line << endl;
+                    error += 1;
+                } else
+                    sweep = {tokens.at(1), range[0], range[1], range[2]};
+            } else {
+                cout << "Error: Unknown directive at line number "
+                     << lineNumber << ": " + line << endl;
+                error += 1;
+            }
+            continue;
+        }
+
+        // Every element needs a name, two nodes and a value
+        if (tokens.size() < 4) {
+            cout << "Error: Unknown element at line number " << lineNumber
+                 << ": " + line << endl;
+            error += 1;
+            continue;
+        }
+
         // Both nodes can't be same
         if (tokens.at(1) == tokens.at(2)) {
             cout << "Warning: Two nodes of a element can't be same. Line "
                     "number: "
-                 << (lineNumber - 1) << ": " + line << endl;
+                 << lineNumber << ": " + line << endl;
             continue;
         }
 
-        // Checks whether the value is actual double and not zero
-        char *end = 0;
-        double value = strtod(tokens.at(3).c_str(), &end);
-        if (end == tokens.at(3).c_str() || *end != '\0' || value == HUGE_VAL ||
-            value == 0) {
+        // Checks whether the value is a number and not zero; anything else
+        // is an expression, computed once every parameter is known
+        double value;
+        std::string expression;
+        if (!parseEngineering(tokens.at(3), value)) {
+            expression = stripBraces(tokens.at(3));
+            value = 1;
+        } else if (value == 0) {
             cout << "Error: Illegal argument for value at line number "
-                 << (lineNumber - 1) << ": " + line << end;
+                 << lineNumber << ": " + line << endl;
             error += 1;
             value = 1;
         }
+        size_t elementCount = circuitElements.size();
 
         // Dependent Current Source (contains two data validation condidtions)
         if ((tokens.at(0).find("IC") == 0) && (tokens.size() >= 6)) {
@@ -93,7 +314,8 @@ int Parser::parse(const std::string &fileName)
             temp->type = Ic;
             temp->nodeA = tokens.at(1);
             temp->nodeB = tokens.at(2);
-            temp->group = G1;
+            temp->group =
+                (tokens.size() >= 7 && tokens.at(6) == "G2") ? G2 : G1;
             temp->value = value;
             temp->controlling_variable = (tokens.at(4) == "V") ? v : i;
 
@@ -101,7 +323,7 @@ int Parser::parse(const std::string &fileName)
             if (tokens.at(4) != "V" && tokens.at(4) != "I") {
                 cout << "Error: Illegal controlling variable argument at line "
                         "number "
-                     << (lineNumber - 1) << ": " + line << end;
+                     << lineNumber << ": " + line << endl;
                 error += 1;
             }
 
@@ -109,7 +331,7 @@ int Parser::parse(const std::string &fileName)
             if (tokens.at(5).find("IC") == 0 || tokens.at(5).find("VC") == 0) {
                 cout << "Error: Controlled source " + tokens.at(0) +
                             " cannot be cascaded at line number "
-                     << (lineNumber - 1) << ": " + line << end;
+                     << lineNumber << ": " + line << endl;
                 error += 1;
 
                 temp->controlling_variable = none;
@@ -145,7 +367,7 @@ int Parser::parse(const std::string &fileName)
             if (tokens.at(4) != "V" && tokens.at(4) != "I") {
                 cout << "Error: Illegal controlling variable argument at line "
                         "number "
-                     << (lineNumber - 1) << ": " + line << end;
+                     << lineNumber << ": " + line << endl;
                 error += 1;
             }
 
@@ -153,7 +375,7 @@ int Parser::parse(const std::string &fileName)
             if (tokens.at(5).find("IC") == 0 || tokens.at(5).find("VC") == 0) {
                 cout << "Error: Controlled source " + tokens.at(0) +
                             " cannot be cascaded"
-                     << end;
+                     << endl;
                 error += 1;
 
                 temp->controlling_variable = none;
@@ -206,14 +428,12 @@ int Parser::parse(const std::string &fileName)
             temp->type = I;
             temp->nodeA = tokens.at(1);
             temp->nodeB = tokens.at(2);
-            if (tokens.size() >= 5 && tokens.at(4) == "G2") {
+            if (tokens.size() >= 5 && tokens.at(4) == "G2")
                 temp->group = G2;
-                nodes_group2.insert(temp->name);
-            }
             // Data Validation: Correct group declaration
             else if (tokens.size() >= 5 && tokens.at(4) != "G1") {
                 cout << "Warning: Mention correct group at line number "
-                     << (lineNumber - 1) << ": " + line << end;
+                     << lineNumber << ": " + line << endl;
                 temp->group = G1;
             } else
                 temp->group = G1;
@@ -239,14 +459,12 @@ int Parser::parse(const std::string &fileName)
             temp->type = R;
             temp->nodeA = tokens.at(1);
             temp->nodeB = tokens.at(2);
-            if (tokens.size() >= 5 && tokens.at(4) == "G2") {
+            if (tokens.size() >= 5 && tokens.at(4) == "G2")
                 temp->group = G2;
-                nodes_group2.insert(temp->name);
-            }
             // Data Validation: Correct group declaration
             else if (tokens.size() >= 5 && tokens.at(4) != "G1") {
                 cout << "Warning: Mention correct group at line number "
-                     << (lineNumber - 1) << ": " + line << endl;
+                     << lineNumber << ": " + line << endl;
                 temp->group = G1;
             } else
                 temp->group = G1;
@@ -271,14 +489,12 @@ int Parser::parse(const std::string &fileName)
             temp->type = C;
             temp->nodeA = tokens.at(1);
             temp->nodeB = tokens.at(2);
-            if (tokens.size() >= 5 && tokens.at(4) == "G2") {
+            if (tokens.size() >= 5 && tokens.at(4) == "G2")
                 temp->group = G2;
-                nodes_group2.insert(temp->name);
-            }
             // Data Validation: Correct group declaration
             else if (tokens.size() >= 5 && tokens.at(4) != "G1") {
                 cout << "Warning: Mention correct group at line number "
-                     << (lineNumber - 1) << ": " + line << endl;
+                     << lineNumber << ": " + line << endl;
                 temp->group = G1;
             } else
                 temp->group = G1;
@@ -319,10 +535,43 @@ int Parser::parse(const std::string &fileName)
         }
         // Unknown Element
         else {
-            cout << "Error: Unknown element at line number " << (lineNumber - 1)
+            cout << "Error: Unknown element at line number " << lineNumber
                  << ": " + line << endl;
             error += 1;
         }
+
+        if (!expression.empty() && circuitElements.size() > elementCount)
+            parameters.bind(circuitElements.back(), expression,
+                            "at line number " +
+                                std::to_string(lineNumber) + ": " + line);
+    }
+
+    // Values given as expressions of the parameters
+    int parameterErrors = parameters.compile();
+    error += parameterErrors;
+    if (parameterErrors == 0) error += parameters.apply();
+
+    // Only independent sources can be swept
+    if (!sweep.source.empty()) {
+        auto swept = elementMap.find(sweep.source);
+        if (swept == elementMap.end() ||
+            (swept->second->type != V && swept->second->type != I)) {
+            cout << "Error: Swept source " + sweep.source +
+                        " is not an independent source of the netlist"
+                 << endl;
+            error += 1;
+        }
+    }
+
+    // Probed resistors, current sources, capacitors and dependent current
+    // sources are treated like group 2 ones, their current is wanted
+    std::set<std::string> probed(probes.begin(), probes.end());
+    probed.insert(sensitivities.begin(), sensitivities.end());
+    for (std::shared_ptr<CircuitElement> circuitElement : circuitElements) {
+        Component type = circuitElement->type;
+        if (probed.count(circuitElement->name) &&
+            (type == R || type == I || type == C || type == Ic))
+            circuitElement->group = G2;
     }
 
     // Assign controlling_element variable using the pointers stored in the map
@@ -345,9 +594,10 @@ int Parser::parse(const std::string &fileName)
                                 circuitElement->name
                          << endl;
                     circuitElement->controlling_element->group = G2;
+                }
+                if (circuitElement->controlling_variable == i)
                     nodes_group2.insert(
                         circuitElement->controlling_element->name);
-                }
             } else {
                 cout << "Error: Referencing element " +
                             circuitElement->controlling_element->name +
@@ -359,6 +609,19 @@ int Parser::parse(const std::string &fileName)
         }
     }
 
+    // Group 2 resistors, current sources, capacitors and dependent current
+    // sources only need a branch unknown when a current controlled source
+    // refers to them. Otherwise they are stamped as group 1 and their current
+    // is computed from the solution.
+    for (std::shared_ptr<CircuitElement> circuitElement : circuitElements) {
+        Component type = circuitElement->type;
+        if (circuitElement->group != G2 || type == V || type == Vc ||
+            type == L || nodes_group2.count(circuitElement->name))
+            continue;
+        circuitElement->group = G1;
+        currentProbes.push_back(circuitElement);
+    }
+
     // Checks if the circuit contains ground (reference node)
     if (nodes_group2.find("0") == nodes_group2.end()) {
         cout << "Error: Circuit must contain ground (0)" << endl;
@@ -382,6 +645,14 @@ int Parser::parse(const std::string &fileName)
     return error;
 }
 
+std::string probeName(const std::string &token)
+{
+    if (token.size() > 3 && (token[0] == 'V' || token[0] == 'I') &&
+        token[1] == '(' && token.back() == ')')
+        return token.substr(2, token.size() - 3);
+    return token;
+}
+
 void Parser::printParser()
 {
     for (std::shared_ptr<CircuitElement> circuitElement : circuitElements)
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
+ * Reserved. Permission to use, copy, modify and distribute this software for
+ * educational, research, and not-for-profit purposes, without fee and without a
+ * signed license agreement, is hereby granted, provided that this paragraph and
+ * the following two paragraphs appear in all copies, modifications, and
+ * distributions.
+ *
+ * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
+ * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
+ * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
+ *
+ * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
+ * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+/**
+ * @file Probe.cpp
+ *
+ * @brief Contains the implementation of the post-solve branch current probes
+ */
+
+#include "../../include/Probe.hpp"
+
+CurrentProbes makeCurrentProbes(
+    const std::vector<std::shared_ptr<CircuitElement>> &elements,
+    const std::map<std::string, int> &indexMap, int ground)
+{
+    bool found;
+    auto index = [&](const std::string &name) {
+        if (name.compare("0") == 0) return ground;
+        std::map<std::string, int>::const_iterator iter = indexMap.find(name);
+        if (iter == indexMap.end()) {
+            found = false;
+            return ground;
+        }
+        return iter->second;
+    };
+
+    size_t n = elements.size();
+    CurrentProbes probes;
+    probes.a.resize(n);
+    probes.b.resize(n);
+    probes.branch.resize(n);
+    probes.gain.resize(n);
+    probes.branchGain.resize(n);
+    probes.offset.resize(n);
+
+    int k = 0;
+    for (const std::shared_ptr<CircuitElement> &element : elements) {
+        found = true;
+        int a = ground, b = ground, branch = ground;
+        double gain = 0.0, branchGain = 0.0, offset = 0.0;
+
+        // Resistor: (Va - Vb) / R
+        if (element->type == R) {
+            a = index(element->nodeA);
+            b = index(element->nodeB);
+            gain = 1.0 / element->value;
+        }
+        // Independent Current Source: its value
+        else if (element->type == I)
+            offset = element->value;
+        // Voltage Controlled Current Source: factor * (Vx+ - Vx-)
+        else if (element->type == Ic && element->controlling_variable == v) {
+            a = index(element->controlling_element->nodeA);
+            b = index(element->controlling_element->nodeB);
+            gain = element->value;
+        }
+        // Current Controlled Current Source: factor * Ix
+        else if (element->type == Ic && element->controlling_variable == i) {
+            branch = index(element->controlling_element->name);
+            branchGain = element->value;
+        }
+        // Capacitor: open circuit, no current
+
+        if (!found) continue;
+        probes.names.push_back(element->name);
+        probes.a(k) = a;
+        probes.b(k) = b;
+        probes.branch(k) = branch;
+        probes.gain(k) = gain;
+        probes.branchGain(k) = branchGain;
+        probes.offset(k) = offset;
+        k++;
+    }
+
+    probes.a.conservativeResize(k);
+    probes.b.conservativeResize(k);
+    probes.branch.conservativeResize(k);
+    probes.gain.conservativeResize(k);
+    probes.branchGain.conservativeResize(k);
+    probes.offset.conservativeResize(k);
+
+    return probes;
+}
+
+void appendProbeCurrents(const CurrentProbes &probes,
+                         std::map<std::string, int> &indexMap,
+                         Eigen::MatrixXd &X)
+{
+    // Solution extended with the zero voltage of ground, one solution per
+    // column
+    int m = int(X.rows());
+    Eigen::MatrixXd x(m + 1, X.cols());
+    x << X, Eigen::RowVectorXd::Zero(X.cols());
+
+    Eigen::MatrixXd current =
+        probes.gain.asDiagonal() *
+            (x(probes.a, Eigen::all) - x(probes.b, Eigen::all)) +
+        probes.branchGain.asDiagonal() * x(probes.branch, Eigen::all);
+    current.colwise() += probes.offset;
+
+    X.conservativeResize(m + current.rows(), X.cols());
+    X.bottomRows(current.rows()) = current;
+    for (size_t k = 0; k < probes.names.size(); k++)
+        indexMap[probes.names[k]] = m + int(k);
+}
@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
+ * Reserved. Permission to use, copy, modify and distribute this software for
+ * educational, research, and not-for-profit purposes, without fee and without a
+ * signed license agreement, is hereby granted, provided that this paragraph and
+ * the following two paragraphs appear in all copies, modifications, and
+ * distributions.
+ *
+ * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
+ * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
+ * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
+ *
+ * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
+ * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+/**
+ * @file Reduction.cpp
+ *
+ * @brief Contains the implementation of the topological circuit reduction
+ */
+
+#include "../../include/Reduction.hpp"
+
+#include <set>
+#include <utility>
+
+// Only group 1 resistors and current sources whose current is not probed
+// take part in the reduction
+typedef std::set<const CircuitElement *> ProbedSet;
+
+static bool isReducibleResistor(const CircuitElement &element,
+                                const ProbedSet &probed)
+{
+    return element.type == R && element.group == G1 && !probed.count(&element);
+}
+
+static bool isReducibleSource(const CircuitElement &element,
+                              const ProbedSet &probed)
+{
+    return element.type == I && element.group == G1 && !probed.count(&element);
+}
+
+static std::pair<std::string, std::string> nodePair(
+    const CircuitElement &element)
+{
+    return element.nodeA < element.nodeB
+               ? std::make_pair(element.nodeA, element.nodeB)
+               : std::make_pair(element.nodeB, element.nodeA);
+}
+
+Reduction reduceCircuit(Parser &parser, const std::set<std::string> &variable)
+{
+    Reduction reduction;
+    std::vector<std::shared_ptr<CircuitElement>> &elements =
+        parser.circuitElements;
+    std::vector<bool> alive(elements.size(), true);
+
+    ProbedSet probed;
+    for (std::shared_ptr<CircuitElement> element : parser.currentProbes)
+        probed.insert(element.get());
+    for (std::shared_ptr<CircuitElement> element : parser.circuitElements)
+        if (variable.count(element->name)) probed.insert(element.get());
+
+    // Controlling voltages must stay available as unknowns
+    std::set<std::string> keep = {"0"};
+    for (std::shared_ptr<CircuitElement> element : elements)
+        if (element->controlling_variable == v) {
+            keep.insert(element->controlling_element->nodeA);
+            keep.insert(element->controlling_element->nodeB);
+        }
+
+    // Merges parallel resistors and parallel current sources into the first
+    // element between the same pair of nodes
+    std::map<std::pair<std::string, std::string>, size_t> resistorAt, sourceAt;
+    auto mergeParallel = [&](size_t k) {
+        CircuitElement &element = *elements[k];
+        if (isReducibleResistor(element, probed)) {
+            auto inserted = resistorAt.insert({nodePair(element), k});
+            if (inserted.second) return;
+            CircuitElement &first = *elements[inserted.first->second];
+            first.value = 1.0 / (1.0 / first.value + 1.0 / element.value);
+            reduction.parallel++;
+        } else if (isReducibleSource(element, probed)) {
+            auto inserted = sourceAt.insert({nodePair(element), k});
+            if (inserted.second) return;
+            CircuitElement &first = *elements[inserted.first->second];
+            first.value += first.nodeA == element.nodeA ? element.value
+                                                        : -element.value;
+            reduction.sources++;
+        } else
+            return;
+        alive[k] = false;
+    };
+    for (size_t k = 0; k < elements.size(); k++) mergeParallel(k);
+
+    // Elements incident to every node, dead ones are skipped lazily
+    std::map<std::string, std::vector<size_t>> incident;
+    for (size_t k = 0; k < elements.size(); k++) {
+        if (!alive[k]) continue;
+        incident[elements[k]->nodeA].push_back(k);
+        incident[elements[k]->nodeB].push_back(k);
+    }
+
+    std::vector<std::string> worklist;
+    for (auto &entry : incident) worklist.push_back(entry.first);
+
+    while (!worklist.empty()) {
+        std::string node = worklist.back();
+        worklist.pop_back();
+        if (keep.count(node)) continue;
+
+        std::vector<size_t> live;
+        for (size_t k : incident[node])
+            if (alive[k]) live.push_back(k);
+        incident[node] = live;
+
+        if (live.size() > 2 || live.empty()) continue;
+        if (!isReducibleResistor(*elements[live[0]], probed)) continue;
+        if (live.size() == 2 &&
+            !isReducibleResistor(*elements[live[1]], probed))
+            continue;
+
+        CircuitElement &first = *elements[live[0]];
+        const std::string &p = first.nodeA == node ? first.nodeB : first.nodeA;
+
+        // A dangling resistor carries no current, the node follows p
+        if (live.size() == 1) {
+            alive[live[0]] = false;
+            resistorAt.erase(nodePair(first));
+            reduction.eliminated.push_back({node, p, p, 0.0});
+            reduction.dangling++;
+            worklist.push_back(p);
+            continue;
+        }
+
+        CircuitElement &second = *elements[live[1]];
+        const std::string &q =
+            second.nodeA == node ? second.nodeB : second.nodeA;
+
+        alive[live[0]] = alive[live[1]] = false;
+        resistorAt.erase(nodePair(first));
+        resistorAt.erase(nodePair(second));
+
+        reduction.eliminated.push_back(
+            {node, p, q, first.value / (first.value + second.value)});
+        reduction.series++;
+
+        std::shared_ptr<CircuitElement> merged =
+            std::make_shared<CircuitElement>(first);
+        merged->nodeA = p;
+        merged->nodeB = q;
+        merged->value = first.value + second.value;
+        elements.push_back(merged);
+        alive.push_back(true);
+        incident[p].push_back(elements.size() - 1);
+        incident[q].push_back(elements.size() - 1);
+        mergeParallel(elements.size() - 1);
+
+        worklist.push_back(p);
+        worklist.push_back(q);
+    }
+
+    std::vector<std::shared_ptr<CircuitElement>> reduced;
+    for (size_t k = 0; k < elements.size(); k++)
+        if (alive[k]) reduced.push_back(elements[k]);
+    elements.swap(reduced);
+
+    for (EliminatedNode &eliminated : reduction.eliminated)
+        parser.nodes_group2.erase(eliminated.node);
+
+    return reduction;
+}
+
+void recoverEliminated(const Reduction &reduction,
+                       std::map<std::string, int> &indexMap,
+                       Eigen::MatrixXd &X)
+{
+    int m = int(X.rows());
+    X.conservativeResize(m + int(reduction.eliminated.size()), X.cols());
+
+    // Later removals may have taken the neighbours of earlier ones. Nodes
+    // whose neighbours have no value (invalid island) are left out too.
+    // Every column of X is a separate solution.
+    for (auto iter = reduction.eliminated.rbegin();
+         iter != reduction.eliminated.rend(); iter++) {
+        Eigen::RowVectorXd voltage[2] = {Eigen::RowVectorXd::Zero(X.cols()),
+                                         Eigen::RowVectorXd::Zero(X.cols())};
+        bool known = true;
+        const std::string *neighbours[2] = {&iter->nodeA, &iter->nodeB};
+        for (int k = 0; k < 2; k++) {
+            if (neighbours[k]->compare("0") == 0) continue;
+            std::map<std::string, int>::iterator found =
+                indexMap.find(*neighbours[k]);
+            if (found == indexMap.end())
+                known = false;
+            else
+                voltage[k] = X.row(found->second);
+        }
+        if (!known) continue;
+
+        indexMap[iter->node] = m;
+        X.row(m++) = voltage[0] + iter->ratio * (voltage[1] - voltage[0]);
+    }
+    X.conservativeResize(m, X.cols());
+}
@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
+ * Reserved. Permission to use, copy, modify and distribute this software for
+ * educational, research, and not-for-profit purposes, without fee and without a
+ * signed license agreement, is hereby granted, provided that this paragraph and
+ * the following two paragraphs appear in all copies, modifications, and
+ * distributions.
+ *
+ * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
+ * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
+ * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
+ *
+ * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
+ * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+/**
+ * @file Relaxation.cpp
+ *
+ * @brief Contains the implementation of the block relaxation
+ */
+
+#include "../../include/Relaxation.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <numeric>
+#include <thread>
+
+#include "../../include/Stamp.hpp"
+#include "../../lib/external/Eigen/SparseLU"
+
+static int findRoot(std::vector<int> &parent, int k)
+{
+    while (parent[k] != k) k = parent[k] = parent[parent[k]];
+    return k;
+}
+
+std::vector<int> partitionUnknowns(const std::vector<StampRecord> &records,
+                                   int m, double cut)
+{
+    // The sentinel (ground) joins nothing
+    std::vector<int> parent(m + 1);
+    std::iota(parent.begin(), parent.end(), 0);
+    auto join = [&](int a, int b) {
+        if (a < m && b < m) parent[findRoot(parent, a)] = findRoot(parent, b);
+    };
+
+    const int resistor = kernelIndex(R, G1, none);
+    for (const StampRecord &record : records) {
+        if (record.kernel == resistor && std::abs(record.value) >= cut)
+            continue;
+        join(record.a, record.b);
+        join(record.a, record.branch);
+        join(record.b, record.branch);
+    }
+
+    std::vector<int> partition(m, -1), label(m, -1);
+    int count = 0;
+    for (int k = 0; k < m; k++) {
+        int root = findRoot(parent, k);
+        if (label[root] < 0) label[root] = count++;
+        partition[k] = label[root];
+    }
+    return partition;
+}
+
+// Milliseconds since start
+static double elapsed(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+Eigen::VectorXd solveRelaxed(const Eigen::SparseMatrix<double> &A,
+                             const Eigen::VectorXd &b,
+                             const std::vector<int> &partition, int threads,
+                             RelaxationReport &report)
+{
+    typedef Eigen::SparseLU<Eigen::SparseMatrix<double>,
+                            Eigen::COLAMDOrdering<int>>
+        LU;
+    const int m = int(A.rows());
+    const int count =
+        m == 0 ? 0 : *std::max_element(partition.begin(), partition.end()) + 1;
+
+    // Local position of every unknown inside its partition
+    std::vector<std::vector<int>> unknowns(count);
+    std::vector<int> local(m);
+    for (int k = 0; k < m; k++) {
+        local[k] = int(unknowns[partition[k]].size());
+        unknowns[partition[k]].push_back(k);
+    }
+
+    // Diagonal blocks, and the couplings of every partition to the others
+    std::vector<std::vector<Eigen::Triplet<double>>> inside(count),
+        outside(count);
+    for (int col = 0; col < A.outerSize(); col++)
+        for (Eigen::SparseMatrix<double>::InnerIterator it(A, col); it; ++it) {
+            int p = partition[it.row()];
+            if (partition[col] == p)
+                inside[p].emplace_back(local[it.row()], local[col],
+                                       it.value());
+            else
+                outside[p].emplace_back(local[it.row()], col, it.value());
+        }
+
+    std::vector<LU> lu(count);
+    std::vector<Eigen::SparseMatrix<double>> coupling(count);
+    report = RelaxationReport();
+    report.partitions.resize(count);
+    threads = std::max(1, std::min(threads, count));
+    auto parallel = [&](auto function) {
+        std::atomic<int> next(0);
+        auto worker = [&]() {
+            for (int p = next++; p < count; p = next++) function(p);
+        };
+        std::vector<std::thread> pool;
+        for (int t = 1; t < threads; t++) pool.emplace_back(worker);
+        worker();
+        for (std::thread &thread : pool) thread.join();
+    };
+
+    std::atomic<bool> singular(false);
+    parallel([&](int p) {
+        std::chrono::steady_clock::time_point start =
+            std::chrono::steady_clock::now();
+        int size = int(unknowns[p].size());
+        Eigen::SparseMatrix<double> block(size, size);
+        block.setFromTriplets(inside[p].begin(), inside[p].end());
+        coupling[p].resize(size, m);
+        coupling[p].setFromTriplets(outside[p].begin(), outside[p].end());
+        lu[p].compute(block);
+        if (lu[p].info() != Eigen::Success) singular = true;
+        report.partitions[p].unknowns = size;
+        report.partitions[p].factorization = elapsed(start);
+    });
+
+    Eigen::VectorXd x = Eigen::VectorXd::Zero(m), next = x;
+    if (singular) {
+        report.change = HUGE_VAL;
+        return x;
+    }
+
+    // Block Jacobi sweeps: each partition against the previous sweep
+    while (report.iterations < relaxationIterations) {
+        parallel([&](int p) {
+            std::chrono::steady_clock::time_point start =
+                std::chrono::steady_clock::now();
+            // Solved into a plain vector, the solver works in place on
+            // its destination
+            Eigen::VectorXd rhs = b(unknowns[p]) - coupling[p] * x;
+            Eigen::VectorXd solution = lu[p].solve(rhs);
+            next(unknowns[p]) = solution;
+            report.partitions[p].solves += elapsed(start);
+        });
+        report.iterations++;
+        report.change = (next - x).lpNorm<Eigen::Infinity>() /
+                        std::max(1.0, next.lpNorm<Eigen::Infinity>());
+        x.swap(next);
+
+        // A single partition is solved exactly by its first sweep
+        if (count == 1) report.change = 0.0;
+        if (!std::isfinite(report.change)) break;
+        if (report.change <= relaxationTolerance) {
+            report.converged = true;
+            break;
+        }
+    }
+    return x;
+}
@@ -0,0 +1,278 @@
+/*
+ * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
+ * Reserved. Permission to use, copy, modify and distribute this software for
+ * educational, research, and not-for-profit purposes, without fee and without a
+ * signed license agreement, is hereby granted, provided that this paragraph and
+ * the following two paragraphs appear in all copies, modifications, and
+ * distributions.
+ *
+ * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
+ * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
+ * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
+ *
+ * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
+ * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+/**
+ * @file ResultCache.cpp
+ *
+ * @brief Contains the implementation of the operating point result cache
+ */
+
+#include "../../include/ResultCache.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include <unistd.h>
+
+using std::cout, std::endl;
+namespace fs = std::filesystem;
+
+static const char cacheMagic[8] = {'S', 'N', 'U', 'C', 'A', 'C', 'H', '1'};
+
+// Exact text of a double, so that equal descriptions mean equal values
+static std::string exact(double value)
+{
+    std::ostringstream stream;
+    stream << std::hexfloat << value;
+    return stream.str();
+}
+
+// FNV-1a
+static std::uint64_t hashText(const std::string &text)
+{
+    std::uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : text) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+std::string describeCircuit(const Parser &parser, const SourceTable &table,
+                            const std::string &analysis)
+{
+    static const char *types[] = {"V", "I", "R", "IC", "VC", "C", "L"};
+    std::vector<std::string> lines;
+    for (const std::shared_ptr<CircuitElement> &element :
+         parser.circuitElements) {
+        std::string line = element->name + " " + types[element->type] + " " +
+                           element->nodeA + " " + element->nodeB + " G" +
+                           std::to_string(int(element->group) + 1) + " " +
+                           exact(element->value);
+        if (element->controlling_variable != none)
+            line += std::string(element->controlling_variable == v ? " V "
+                                                                   : " I ") +
+                    element->controlling_element->name;
+        lines.push_back(line);
+    }
+    std::sort(lines.begin(), lines.end());
+
+    // Currents computed after the solve, not part of the elements' groups
+    std::vector<std::string> computed;
+    for (const std::shared_ptr<CircuitElement> &element :
+         parser.currentProbes)
+        computed.push_back(element->name);
+    std::sort(computed.begin(), computed.end());
+
+    std::string description;
+    for (const std::string &line : lines) description += line + "\n";
+    description += "CURRENTS";
+    for (const std::string &name : computed) description += " " + name;
+    // The probes give the order of the outputs
+    description += "\nPROBES";
+    for (const std::string &probe : parser.probes) description += " " + probe;
+    description += "\nTABLE";
+    for (const std::string &source : table.sources)
+        description += " " + source;
+    for (int row = 0; row < table.values.rows(); row++)
+        for (int col = 0; col < table.values.cols(); col++)
+            description += (col == 0 ? "\n" : " ") +
+                           exact(table.values(row, col));
+    // Reduced models are loaded after the lookup, so their files are
+    // described by their contents
+    for (const std::string &file : parser.reducedModels) {
+        std::ifstream stream(file, std::ios::binary);
+        std::ostringstream contents;
+        contents << stream.rdbuf();
+        std::ostringstream hash;
+        hash << std::hex << hashText(contents.str());
+        description += "\nROM " + file + " " +
+                       (stream ? hash.str() : std::string("unreadable"));
+    }
+    return description + "\nANALYSIS " + analysis + "\n";
+}
+
+int ResultCache::open(const std::string &path, std::uintmax_t sizeLimit)
+{
+    directory = path;
+    limit = sizeLimit;
+    std::error_code error;
+    fs::create_directories(directory, error);
+    if (!fs::is_directory(directory, error)) {
+        cout << "Error: Cannot use " + directory + " as the result cache"
+             << endl;
+        return 1;
+    }
+    std::ifstream stream(fs::path(directory) / "statistics");
+    stream >> hits >> misses >> evictions;
+    return 0;
+}
+
+std::string ResultCache::entryPath(const std::string &description) const
+{
+    std::ostringstream name;
+    name << std::hex << std::setw(16) << std::setfill('0')
+         << hashText(description) << ".op";
+    return (fs::path(directory) / name.str()).string();
+}
+
+bool ResultCache::lookup(const std::string &description,
+                         std::vector<std::string> &names,
+                         Eigen::MatrixXd &values)
+{
+    std::string path = entryPath(description);
+    std::ifstream stream(path, std::ios::binary);
+    char magic[8] = {};
+    std::uint64_t length = 0, outputs = 0, cases = 0;
+    std::string stored;
+    bool hit = false;
+    if (stream.read(magic, 8) && std::equal(magic, magic + 8, cacheMagic) &&
+        stream.read(reinterpret_cast<char *>(&length), sizeof(length)) &&
+        length == description.size()) {
+        stored.resize(length);
+        hit = stream.read(&stored[0], std::streamsize(length)) &&
+              stored == description;
+    }
+    if (hit && stream.read(reinterpret_cast<char *>(&outputs),
+                           sizeof(outputs)) &&
+        stream.read(reinterpret_cast<char *>(&cases), sizeof(cases))) {
+        names.resize(outputs);
+        for (std::string &name : names) {
+            std::uint32_t size = 0;
+            stream.read(reinterpret_cast<char *>(&size), sizeof(size));
+            name.resize(size);
+            if (size != 0) stream.read(&name[0], size);
+        }
+        values.resize(Eigen::Index(outputs), Eigen::Index(cases));
+        stream.read(reinterpret_cast<char *>(values.data()),
+                    std::streamsize(values.size() * sizeof(double)));
+        hit = bool(stream);
+    } else
+        hit = false;
+    stream.close();
+
+    if (hit) {
+        // Most recently used
+        std::error_code error;
+        fs::last_write_time(path, fs::file_time_type::clock::now(), error);
+        hits++;
+    } else
+        misses++;
+    saveStatistics();
+    return hit;
+}
+
+int ResultCache::store(const std::string &description,
+                       const std::vector<std::string> &names,
+                       const Eigen::MatrixXd &values)
+{
+    // Written under a temporary name and renamed, so that concurrent runs
+    // never read a partial entry
+    std::string path = entryPath(description);
+    std::string temporary = path + ".tmp" + std::to_string(::getpid());
+    {
+        std::ofstream stream(temporary, std::ios::binary);
+        std::uint64_t length = description.size(), outputs = names.size(),
+                      cases = std::uint64_t(values.cols());
+        stream.write(cacheMagic, 8);
+        stream.write(reinterpret_cast<const char *>(&length), sizeof(length));
+        stream.write(description.data(), std::streamsize(length));
+        stream.write(reinterpret_cast<const char *>(&outputs),
+                     sizeof(outputs));
+        stream.write(reinterpret_cast<const char *>(&cases), sizeof(cases));
+        for (const std::string &name : names) {
+            std::uint32_t size = std::uint32_t(name.size());
+            stream.write(reinterpret_cast<const char *>(&size), sizeof(size));
+            stream.write(name.data(), size);
+        }
+        stream.write(reinterpret_cast<const char *>(values.data()),
+                     std::streamsize(values.size() * sizeof(double)));
+        if (!stream) {
+            cout << "Warning: Cannot write to the result cache " + directory
+                 << endl;
+            std::remove(temporary.c_str());
+            return 1;
+        }
+    }
+    std::error_code error;
+    fs::rename(temporary, path, error);
+    if (error) {
+        std::remove(temporary.c_str());
+        return 1;
+    }
+
+    // Least recently used entries first
+    std::vector<std::pair<fs::file_time_type, fs::path>> entries;
+    std::uintmax_t total = 0;
+    for (const fs::directory_entry &entry :
+         fs::directory_iterator(directory, error)) {
+        if (entry.path().extension() != ".op") continue;
+        entries.emplace_back(entry.last_write_time(error), entry.path());
+        total += entry.file_size(error);
+    }
+    std::sort(entries.begin(), entries.end());
+    for (const std::pair<fs::file_time_type, fs::path> &entry : entries) {
+        if (total <= limit) break;
+        // The new entry is kept even when it is larger than the limit
+        if (entry.second == fs::path(path)) continue;
+        total -= fs::file_size(entry.second, error);
+        fs::remove(entry.second, error);
+        evictions++;
+    }
+    saveStatistics();
+    return 0;
+}
+
+void ResultCache::saveStatistics() const
+{
+    fs::path path = fs::path(directory) / "statistics";
+    std::string temporary =
+        path.string() + ".tmp" + std::to_string(::getpid());
+    {
+        std::ofstream stream(temporary);
+        stream << hits << " " << misses << " " << evictions << "\n";
+    }
+    std::error_code error;
+    fs::rename(temporary, path, error);
+    if (error) std::remove(temporary.c_str());
+}
+
+void ResultCache::printStatistics()
+{
+    std::error_code error;
+    std::uintmax_t total = 0, entries = 0;
+    for (const fs::directory_entry &entry :
+         fs::directory_iterator(directory, error))
+        if (entry.path().extension() == ".op") {
+            entries++;
+            total += entry.file_size(error);
+        }
+    std::uint64_t lookups = hits + misses;
+    cout << std::fixed << std::setprecision(1) << "\nResult cache "
+         << directory << ": " << entries << " entr"
+         << (entries == 1 ? "y" : "ies") << ", " << total << " of " << limit
+         << " bytes, " << hits << " hit(s), " << misses << " miss(es) ("
+         << (lookups != 0 ? 100.0 * double(hits) / double(lookups) : 0.0)
+         << "% hit rate), " << evictions << " eviction(s)" << endl;
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
+ * Reserved. Permission to use, copy, modify and distribute this software for
+ * educational, research, and not-for-profit purposes, without fee and without a
+ * signed license agreement, is hereby granted, provided that this paragraph and
+ * the following two paragraphs appear in all copies, modifications, and
+ * distributions.
+ *
+ * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
+ * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
+ * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
+ *
+ * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
+ * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+/**
+ * @file Scratch.cpp
+ *
+ * @brief Contains the implementation of the scratch files
+ */
+
+#include "../../include/Scratch.hpp"
+
+#include <cerrno>
+#include <cstdlib>
+#include <vector>
+
+bool ScratchFile::open(const std::string &directory)
+{
+    close();
+    std::string name = directory + "/SNU_Spice.XXXXXX";
+    std::vector<char> path(name.begin(), name.end());
+    path.push_back('\0');
+    file = mkstemp(path.data());
+    if (file < 0) return false;
+    unlink(path.data());
+    return true;
+}
+
+void ScratchFile::close()
+{
+    if (file >= 0) ::close(file);
+    file = -1;
+}
+
+bool ScratchFile::write(const void *data, std::size_t bytes,
+                        std::size_t offset)
+{
+    const char *next = static_cast<const char *>(data);
+    while (bytes > 0) {
+        ssize_t written = pwrite(file, next, bytes, off_t(offset));
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) return false;
+        next += written;
+        bytes -= std::size_t(written);
+        offset += std::size_t(written);
+    }
+    return true;
+}
+
+bool ScratchFile::read(void *data, std::size_t bytes, std::size_t offset)
+{
+    char *next = static_cast<char *>(data);
+    while (bytes > 0) {
+        ssize_t count = pread(file, next, bytes, off_t(offset));
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) return false;
+        next += count;
+        bytes -= std::size_t(count);
+        offset += std::size_t(count);
+    }
+    return true;
+}
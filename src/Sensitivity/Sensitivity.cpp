@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
+ * Reserved. Permission to use, copy, modify and distribute this software for
+ * educational, research, and not-for-profit purposes, without fee and without a
+ * signed license agreement, is hereby granted, provided that this paragraph and
+ * the following two paragraphs appear in all copies, modifications, and
+ * distributions.
+ *
+ * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
+ * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
+ * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
+ *
+ * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
+ * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ */
+/**
+ * @file Sensitivity.cpp
+ *
+ * @brief Contains the implementation of the adjoint sensitivity analysis
+ */
+
+#include "../../include/Sensitivity.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include "../../include/Probe.hpp"
+#include "../../include/Stamp.hpp"
+
+using std::cout, std::endl;
+
+int makeSensitivitySeeds(
+    const std::vector<std::string> &outputs,
+    const std::map<std::string, int> &indexMap,
+    const std::vector<std::shared_ptr<CircuitElement>> &currentProbes,
+    Eigen::MatrixXd &seeds)
+{
+    // One extra row absorbs the ground terms of current probes
+    int m = int(indexMap.size());
+    seeds = Eigen::MatrixXd::Zero(m + 1, outputs.size());
+
+    int error = 0;
+    for (size_t k = 0; k < outputs.size(); k++) {
+        std::map<std::string, int>::const_iterator unknown =
+            indexMap.find(outputs[k]);
+        if (unknown != indexMap.end()) {
+            seeds(unknown->second, k) = 1.0;
+            continue;
+        }
+
+        std::vector<std::shared_ptr<CircuitElement>> element;
+        for (const std::shared_ptr<CircuitElement> &probe : currentProbes)
+            if (probe->name == outputs[k]) element.push_back(probe);
+        CurrentProbes probe = makeCurrentProbes(element, indexMap, m);
+        if (probe.names.empty()) {
+            cout << "Error: Sensitivity output " + outputs[k] +
+                        " is not a node or a group 2 element"
+                 << endl;
+            error += 1;
+            continue;
+        }
+        seeds(probe.a(0), k) += probe.gain(0);
+        seeds(probe.b(0), k) -= probe.gain(0);
+        seeds(probe.branch(0), k) += probe.branchGain(0);
+    }
+
+    seeds.conservativeResize(m, Eigen::NoChange);
+    return error;
+}
+
+std::vector<Sensitivity> computeSensitivities(
+    const std::vector<std::shared_ptr<CircuitElement>> &elements,
+    const std::map<std::string, int> &indexMap, const Eigen::VectorXd &x,
+    const Eigen::VectorXd &adjoint, const std::string &output,
+    double outputValue,
+    const std::vector<std::shared_ptr<CircuitElement>> &currentProbes)
+{
+    // Zero at the sentinel index of ground
+    Eigen::VectorXd xs(x.size() + 1), ws(adjoint.size() + 1);
+    xs << x, 0.0;
+    ws << adjoint, 0.0;
+
+    std::map<std::string, double> derivatives;
+    for (const std::shared_ptr<CircuitElement> &element : elements) {
+        if (element->type == C || element->type == L) continue;
+
+        StampRecord record = makeStampRecord(*element, indexMap);
+        SensitivitySink sink{ws, xs};
+        kernelTable<SensitivitySink>[record.kernel](&record, &record + 1,
+                                                     sink);
+
+        // Stamps scale with 1/R for group 1 resistors; every other stamp is
+        // affine in the value, its constant part is stamped with value 0
+        double slope;
+        if (element->type == R && element->group == G1)
+            slope = -sink.total / record.value;
+        else {
+            double total = sink.total;
+            record.value = 0.0;
+            sink.total = 0.0;
+            kernelTable<SensitivitySink>[record.kernel](&record, &record + 1,
+                                                         sink);
+            slope = (total - sink.total) / element->value;
+        }
+        derivatives[element->name] -= slope;
+    }
+
+    // A computed current also depends on the value of its own element
+    if (!indexMap.count(output))
+        for (const std::shared_ptr<CircuitElement> &probe : currentProbes)
+            if (probe->name == output)
+                derivatives[output] += probe->type == R
+                                           ? -outputValue / probe->value
+                                           : outputValue / probe->value;
+
+    std::vector<Sensitivity> sensitivities;
+    for (const std::pair<const std::string, double> &entry : derivatives)
+        sensitivities.push_back({entry.first, entry.second});
+    std::stable_sort(sensitivities.begin(), sensitivities.end(),
+                     [](const Sensitivity &a, const Sensitivity &b) {
+                         return std::abs(a.derivative) >
+                                std::abs(b.derivative);
+                     });
+    return sensitivities;
+}
@@ -25,8 +25,178 @@
 
 #include "../../include/Solver.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
 #include <iomanip>
 #include <iostream>
+#include <numeric>
+#include <set>
+#include <sstream>
+#include <thread>
+
+#include "../../include/Transport.hpp"
+
+// Whole string must be a finite number
+static bool parseNumber(const std::string &text, double &value)
+{
+    char *end = 0;
+    value = strtod(text.c_str(), &end);
+    return end != text.c_str() && *end == '\0' && std::isfinite(value);
+}
+
+// Size in bytes, with an optional K, M or G (binary) suffix
+static bool parseSize(std::string text, std::size_t &bytes)
+{
+    double scale = 1.0;
+    size_t suffix = std::string("KMG").find(
+        char(toupper(text.empty() ? ' ' : text.back())));
+    if (suffix != std::string::npos) {
+        scale = std::pow(1024.0, double(suffix + 1));
+        text.pop_back();
+    }
+    double value = 0;
+    if (!parseNumber(text, value) || value <= 0) return false;
+    bytes = std::size_t(value * scale);
+    return true;
+}
+
+int parseArguments(int argc, char *argv[], SolverOptions &options)
+{
+    bool netlistGiven = false;
+    for (int k = 1; k < argc; k++) {
+        std::string argument = argv[k];
+        if (argument == "--reduce")
+            options.reduce = true;
+        else if (argument == "--mixed-precision")
+            options.mixedPrecision = true;
+        else if (argument == "--export-mtx" && k + 1 < argc)
+            options.exportBase = argv[++k];
+        else if (argument == "--replay" && k + 1 < argc)
+            options.replayBase = argv[++k];
+        else if (argument == "--probe" && k + 1 < argc) {
+            std::string list = argv[++k];
+            std::transform(list.begin(), list.end(), list.begin(), ::toupper);
+            std::stringstream ss(list);
+            std::string probe;
+            while (getline(ss, probe, ','))
+                if (!probe.empty()) options.probes.push_back(probeName(probe));
+        } else if (argument == "--wave" && k + 1 < argc)
+            options.waveFile = argv[++k];
+        else if (argument == "--wave-tol" && k + 1 < argc &&
+                 parseNumber(argv[k + 1], options.waveTolerance) &&
+                 options.waveTolerance >= 0)
+            k++;
+        else if (argument == "--read-wave" && k + 1 < argc)
+            options.readWave = argv[++k];
+        else if (argument == "--window" && k + 1 < argc) {
+            std::string window = argv[++k];
+            size_t comma = window.find(',');
+            if (comma == std::string::npos ||
+                !parseNumber(window.substr(0, comma), options.windowFrom) ||
+                !parseNumber(window.substr(comma + 1), options.windowTo)) {
+                std::cout << "Error: Illegal window " + window << std::endl;
+                return 1;
+            }
+        } else if (argument == "--threads" && k + 1 < argc) {
+            double threads = 0;
+            if (!parseNumber(argv[++k], threads) || threads < 0 ||
+                threads != std::floor(threads)) {
+                std::cout << "Error: Illegal thread count " << argv[k]
+                          << std::endl;
+                return 1;
+            }
+            options.threads = int(threads);
+        } else if (argument == "--param" && k + 1 < argc) {
+            std::string list = argv[++k];
+            std::transform(list.begin(), list.end(), list.begin(), ::toupper);
+            std::stringstream ss(list);
+            std::string assignment;
+            while (getline(ss, assignment, ',')) {
+                size_t equals = assignment.find('=');
+                double value = 0;
+                if (equals == 0 || equals == std::string::npos ||
+                    !parseEngineering(assignment.substr(equals + 1), value)) {
+                    std::cout << "Error: Illegal parameter " + assignment
+                              << std::endl;
+                    return 1;
+                }
+                options.parameters.emplace_back(assignment.substr(0, equals),
+                                                value);
+            }
+        } else if (argument == "--mor" && k + 1 < argc) {
+            double moments = 0;
+            if (!parseNumber(argv[++k], moments) || moments < 1 ||
+                moments != std::floor(moments)) {
+                std::cout << "Error: Illegal moment count " << argv[k]
+                          << std::endl;
+                return 1;
+            }
+            options.morMoments = int(moments);
+        } else if (argument == "--mor-save" && k + 1 < argc)
+            options.morSave = argv[++k];
+        else if (argument == "--source-table" && k + 1 < argc)
+            options.sourceTable = argv[++k];
+        else if (argument == "--sparse")
+            options.sparse = true;
+        else if (argument == "--mem-limit" && k + 1 < argc) {
+            if (!parseSize(argv[++k], options.memLimit)) {
+                std::cout << "Error: Illegal memory limit " << argv[k]
+                          << std::endl;
+                return 1;
+            }
+        } else if (argument == "--cache" && k + 1 < argc)
+            options.cacheDir = argv[++k];
+        else if (argument == "--cache-limit" && k + 1 < argc) {
+            std::size_t limit = 0;
+            if (!parseSize(argv[++k], limit)) {
+                std::cout << "Error: Illegal cache limit " << argv[k]
+                          << std::endl;
+                return 1;
+            }
+            options.cacheLimit = limit;
+        } else if (argument == "--cache-stats")
+            options.cacheStats = true;
+        else if (argument == "--equilibrate")
+            options.equilibrate = true;
+        else if (argument == "--health")
+            options.health = true;
+        else if (argument == "--relax" && k + 1 < argc) {
+            if (!parseEngineering(argv[++k], options.relaxCut) ||
+                !(options.relaxCut > 0)) {
+                std::cout << "Error: Illegal relaxation cut " << argv[k]
+                          << std::endl;
+                return 1;
+            }
+        } else if (argument == "--batch" && k + 1 < argc)
+            options.batchTable = argv[++k];
+        else if (argument == "--codegen" && k + 1 < argc)
+            options.codegenFile = argv[++k];
+        else if (argument == "--scratch" && k + 1 < argc)
+            options.scratchDir = argv[++k];
+        else if (argument == "--domains" && k + 1 < argc) {
+            double domains = 0;
+            if (!parseNumber(argv[++k], domains) || domains < 1 ||
+                domains != std::floor(domains)) {
+                std::cout << "Error: Illegal domain count " << argv[k]
+                          << std::endl;
+                return 1;
+            }
+            options.domains = int(domains);
+        } else if (argument.find("--") != 0 && !netlistGiven) {
+            options.netlist = argument;
+            netlistGiven = true;
+        } else {
+            std::cout << "Error: Unknown command line argument " + argument
+                      << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
+
 void makeIndexMap(std::map<std::string, int> &indexMap, Parser &parser)
 {
     int i = 0;
@@ -55,126 +225,1122 @@ void printMNAandRHS(std::vector<std::vector<double>> &mna,
     }
 }
 
-void makeGraph(std::map<std::string, std::shared_ptr<Node>> &nodeMap,
-               Parser &parser)
+void printxX(std::map<std::string, int> &indexMap, Eigen::MatrixXd &X)
 {
-    for (std::shared_ptr<CircuitElement> circuitElement :
-         parser.circuitElements) {
-        // Creates/retrieves start node
-        std::shared_ptr<Node> nodeStart;
-        std::map<std::string, std::shared_ptr<Node>>::iterator startNodeIter =
-            nodeMap.find(circuitElement->nodeA);
-        if (startNodeIter != nodeMap.end())
-            nodeStart = startNodeIter->second;
-        else {
-            nodeStart = std::make_shared<Node>();
-            nodeStart->name = circuitElement->nodeA;
-            nodeMap[circuitElement->nodeA] = nodeStart;
-        }
+    std::cout << std::fixed;
+    std::cout << std::setprecision(5);
 
-        // Creates/retrieves end node
-        std::shared_ptr<Node> nodeEnd;
-        std::map<std::string, std::shared_ptr<Node>>::iterator endNodeIter =
-            nodeMap.find(circuitElement->nodeB);
-        if (endNodeIter != nodeMap.end())
-            nodeEnd = endNodeIter->second;
-        else {
-            nodeEnd = std::make_shared<Node>();
-            nodeEnd->name = circuitElement->nodeB;
-            nodeMap[circuitElement->nodeB] = nodeEnd;
-        }
+    std::map<std::string, int>::iterator k = indexMap.begin();
 
-        // Edge from start node to end node for nodeStart
-        std::shared_ptr<Edge> edgeStartEnd = std::make_shared<Edge>();
-        edgeStartEnd->source = nodeStart;
-        edgeStartEnd->target = nodeEnd;
-        edgeStartEnd->circuitElement = circuitElement;
-        nodeStart->edges.push_back(edgeStartEnd);
+    std::cout << "\n";
+    for (; k != indexMap.end(); k++)
+        std::cout << k->first << "\t\t" << X(k->second) << std::endl;
+}
+
+int selectOutputs(const std::map<std::string, int> &indexMap,
+                  const std::vector<std::string> &probes,
+                  std::vector<std::pair<std::string, int>> &outputs)
+{
+    outputs.clear();
+    if (probes.empty()) {
+        outputs.assign(indexMap.begin(), indexMap.end());
+        return 0;
+    }
 
-        // Edge from end node to start node for nodeEnd
-        std::shared_ptr<Edge> edgeEndStart = std::make_shared<Edge>();
-        edgeEndStart->source = nodeEnd;
-        edgeEndStart->target = nodeStart;
-        edgeEndStart->circuitElement = circuitElement;
-        nodeEnd->edges.push_back(edgeEndStart);
+    int error = 0;
+    std::set<std::string> selected;
+    for (const std::string &probe : probes) {
+        if (!selected.insert(probe).second) continue;
+        std::map<std::string, int>::const_iterator iter = indexMap.find(probe);
+        if (iter != indexMap.end()) {
+            outputs.push_back(*iter);
+        } else {
+            std::cout << "Error: Probe " + probe +
+                             " has no value in the solution"
+                      << std::endl;
+            error += 1;
+        }
     }
+    return error;
 }
 
-void printxX(std::map<std::string, int> &indexMap, Eigen::MatrixXd &X)
+void printxX(const std::vector<std::pair<std::string, int>> &outputs,
+             Eigen::MatrixXd &X)
 {
     std::cout << std::fixed;
     std::cout << std::setprecision(5);
 
-    std::map<std::string, int>::iterator k = indexMap.begin();
+    std::cout << "\n";
+    for (const std::pair<std::string, int> &output : outputs)
+        std::cout << output.first << "\t\t" << X(output.second) << std::endl;
+}
 
+// Iterations of the relaxed islands and the cost of each partition
+static void printRelaxation(const std::vector<Island> &islands,
+                            const std::vector<SolveReport> &reports)
+{
     std::cout << "\n";
-    for (size_t i = 0; i < indexMap.size(); i++, k++)
-        std::cout << k->first << "\t\t" << X(i) << std::endl;
+    for (size_t k = 0; k < islands.size(); k++) {
+        const RelaxationReport &relaxation = reports[k].relaxation;
+        if (!islands[k].valid || relaxation.partitions.empty()) continue;
+        std::cout << std::scientific << std::setprecision(3) << "Island "
+                  << k << ": " << relaxation.partitions.size()
+                  << " partition(s), " << relaxation.iterations
+                  << " iteration(s), change " << relaxation.change
+                  << (relaxation.converged
+                          ? ""
+                          : ", did not converge, solved directly")
+                  << std::endl;
+        std::cout << std::fixed;
+        for (size_t p = 0; p < relaxation.partitions.size(); p++)
+            std::cout << "  Partition " << p << ": "
+                      << relaxation.partitions[p].unknowns
+                      << " unknown(s), factorization "
+                      << relaxation.partitions[p].factorization
+                      << " ms, solves " << relaxation.partitions[p].solves
+                      << " ms" << std::endl;
+    }
 }
 
-int runSolver(int argc, char *argv[])
+// Instances of every batched island and how they were solved
+static void printBatch(const std::vector<Island> &islands,
+                       const std::vector<SolveReport> &reports)
+{
+    std::cout << "\n";
+    for (size_t k = 0; k < islands.size(); k++) {
+        const BatchReport &batch = reports[k].batch;
+        if (!islands[k].valid) continue;
+        std::cout << std::fixed << std::setprecision(3) << "Island " << k
+                  << ": " << batch.instances << " instance(s) "
+                  << (batch.fixedSize
+                          ? "in lanes of " + std::to_string(batchLanes) +
+                                ", " + std::to_string(batch.repivoted) +
+                                " solved again with partial pivoting"
+                          : "solved one at a time")
+                  << ", " << batch.time << " ms" << std::endl;
+    }
+}
+
+// Band and panels of every island solved out of core, and the islands that
+// were solved in memory instead
+static void printOutOfCore(const std::vector<Island> &islands,
+                           const std::vector<SolveReport> &reports)
+{
+    std::cout << "\n";
+    for (size_t k = 0; k < islands.size(); k++) {
+        const OutOfCoreReport &outOfCore = reports[k].outOfCore;
+        if (!islands[k].valid) continue;
+        if (!outOfCore.used) {
+            if (!outOfCore.failure.empty())
+                std::cout << "Warning: Island " << k
+                          << " was solved in memory, "
+                          << outOfCore.failure << std::endl;
+            continue;
+        }
+        std::cout << "Island " << k << ": out of core, bandwidth "
+                  << outOfCore.lower << "/" << outOfCore.upper << ", "
+                  << outOfCore.panels << " panel(s) of "
+                  << outOfCore.panelColumns << " column(s), window "
+                  << formatBytes(outOfCore.window) << ", factors "
+                  << formatBytes(outOfCore.factors) << " on disk"
+                  << std::endl;
+    }
+}
+
+// Domains of every island solved by domain decomposition, and the islands
+// that were solved directly instead
+static void printDomains(const std::vector<Island> &islands,
+                         const std::vector<SolveReport> &reports)
+{
+    std::cout << "\n";
+    for (size_t k = 0; k < islands.size(); k++) {
+        const DomainReport &domains = reports[k].domains;
+        if (!islands[k].valid) continue;
+        if (!domains.used) {
+            if (!domains.failure.empty())
+                std::cout << "Warning: Island " << k
+                          << " was solved directly, " << domains.failure
+                          << std::endl;
+            continue;
+        }
+        std::cout << "Island " << k << ": " << domains.interiors.size()
+                  << " domain(s), interface of " << domains.interface
+                  << " unknown(s), interiors of";
+        for (size_t p = 0; p < domains.interiors.size(); p++)
+            std::cout << (p > 0 ? ", " : " ") << domains.interiors[p];
+        std::cout << ", " << domains.time << " ms" << std::endl;
+    }
+}
+
+// Health of the factorization of every island with --health, and a warning
+// for the ill conditioned ones in any case
+static void printHealth(const std::vector<Island> &islands,
+                        const std::vector<SolveReport> &reports, bool health)
+{
+    bool first = true;
+    for (size_t k = 0; k < islands.size(); k++) {
+        const SolveReport &report = reports[k];
+        if (!islands[k].valid || !report.diagnosed) continue;
+        bool ill = !(report.rcond >= illConditioned);
+        if (!health && !ill) continue;
+        if (first) std::cout << "\n";
+        first = false;
+
+        std::cout << std::scientific << std::setprecision(3);
+        if (ill)
+            std::cout << "Warning: Island " << k
+                      << " is ill conditioned (rcond " << report.rcond
+                      << "), its results may be inaccurate" << std::endl;
+        if (health)
+            std::cout << "Island " << k << ": rcond " << report.rcond
+                      << ", pivot growth " << report.growth
+                      << ", smallest pivot " << report.smallestPivot << " ("
+                      << report.pivotName << "), scaled residual "
+                      << report.residual
+                      << (report.equilibrated ? ", equilibrated" : "")
+                      << std::endl;
+    }
+}
+
+// Threads of the run, one per core unless given
+static int solverThreads(const SolverOptions &options)
+{
+    return options.threads > 0
+               ? options.threads
+               : int(std::max(1u, std::thread::hardware_concurrency()));
+}
+
+// Threads solving the islands, at most one per island. Islands solved by
+// domains fork their workers, which is only safe with no other island thread
+// running, and the workers are the parallelism then.
+static size_t islandThreads(size_t islandCount, const SolverOptions &options)
+{
+    if (options.domains > 1) return std::min<size_t>(1, islandCount);
+    return std::min<size_t>(solverThreads(options), islandCount);
+}
+
+// Solves a stamped dense system and reports its health. The matrix is
+// factorized in place, so the residual is accumulated from the records, and
+// an ill conditioned system is stamped again to be equilibrated.
+static Eigen::VectorXd solveDenseChecked(
+    const std::vector<StampRecord> &records, int m, bool equilibrate,
+    Eigen::MatrixXd &mna, Eigen::VectorXd &rhs, SolveReport &report)
 {
-    // Default filename if not provided as command line argument.
-    std::string filename = "circuit.sns";
-    if (argc > 1) {
-        filename = argv[1];
+    double anorm = m > 0 ? mna.topLeftCorner(m, m)
+                               .cwiseAbs()
+                               .rowwise()
+                               .sum()
+                               .maxCoeff()
+                         : 0.0;
+    Eigen::VectorXd x = solveDense(mna.topLeftCorner(m, m), rhs.head(m),
+                                   report);
+
+    if (equilibrate && report.rcond < illConditioned) {
+        mna.setZero();
+        rhs.setZero();
+        DenseSink sink{mna, rhs};
+        stampRecords(records, sink);
+
+        Eigen::VectorXd rows, cols;
+        equilibrationScales(mna.topLeftCorner(m, m), rows, cols);
+        mna.topLeftCorner(m, m) =
+            rows.asDiagonal() * mna.topLeftCorner(m, m) * cols.asDiagonal();
+        SolveReport equilibrated;
+        Eigen::VectorXd y =
+            solveDense(mna.topLeftCorner(m, m),
+                       rows.cwiseProduct(rhs.head(m)), equilibrated);
+        if (equilibrated.rcond > report.rcond) {
+            report = equilibrated;
+            report.equilibrated = true;
+            x = cols.cwiseProduct(y);
+        }
+    }
+
+    Eigen::VectorXd solution = Eigen::VectorXd::Zero(m + 1);
+    solution.head(m) = x;
+    Eigen::VectorXd residual = Eigen::VectorXd::Zero(m + 1);
+    ResidualSink sink{solution, residual};
+    stampRecords(records, sink);
+    double rnorm = residual.head(m).lpNorm<Eigen::Infinity>();
+    double scale = anorm * x.lpNorm<Eigen::Infinity>();
+    report.residual = scale > 0.0 ? rnorm / scale : rnorm;
+
+    return x;
+}
+
+SolveReport solveIsland(Island &island,
+                        const std::map<std::string, int> &indexMap,
+                        const SolverOptions &options, Eigen::MatrixXd &X,
+                        const Eigen::MatrixXd *seeds,
+                        Eigen::MatrixXd *adjoints, const SourceTable *table)
+{
+    // Island's own index map: its nodes and branch currents, in sorted order
+    std::map<std::string, int> localIndexMap;
+    for (std::string &node : island.nodes) localIndexMap[node] = 0;
+    for (std::shared_ptr<CircuitElement> element : island.elements)
+        if (indexMap.count(element->name)) localIndexMap[element->name] = 0;
+
+    int m = 0;
+    for (auto &entry : localIndexMap) entry.second = m++;
+
+    // One extra row and column absorb the stamps of ground
+    Eigen::VectorXd rhs = Eigen::VectorXd::Zero(m + 1);
+    std::vector<StampRecord> records =
+        makeStampRecords(island.circuit, localIndexMap);
+
+    // Adjoint right hand sides restricted to the island, solved only if
+    // they touch it
+    Eigen::MatrixXd localSeeds, localAdjoints;
+    bool adjoint = false;
+    if (seeds != nullptr) {
+        localSeeds.resize(m, seeds->cols());
+        for (auto &entry : localIndexMap)
+            localSeeds.row(entry.second) =
+                seeds->row(indexMap.at(entry.first));
+        adjoint = !localSeeds.isZero(0.0);
+    }
+
+    // One solution per column, one column per case of a source table
+    SolveReport report;
+    Eigen::MatrixXd x;
+    if (table != nullptr && !options.batchTable.empty()) {
+        // Elements of the table are stamped for every instance, the others
+        // once
+        std::vector<std::shared_ptr<CircuitElement>> fixed;
+        std::vector<StampRecord> varying;
+        std::vector<int> columns;
+        for (std::shared_ptr<CircuitElement> element : island.elements) {
+            std::vector<std::string>::const_iterator column = std::find(
+                table->sources.begin(), table->sources.end(), element->name);
+            if (column == table->sources.end()) {
+                fixed.push_back(element);
+                continue;
+            }
+            varying.push_back(makeStampRecord(*element, localIndexMap));
+            columns.push_back(int(column - table->sources.begin()));
+        }
+        x = solveBatch(makeStampRecords(fixed, localIndexMap), varying,
+                       columns, table->values, m, options.assemblyThreads,
+                       report.batch);
+    } else if (options.outOfCore && !adjoint) {
+        // Factors on disk, or in memory if the band does not fit
+        RhsSink sink{rhs};
+        stampRecords(records, sink);
+        Eigen::MatrixXd B =
+            table != nullptr
+                ? makeTableRhs(*table, island.elements, localIndexMap, rhs)
+                      .topRows(m)
+                : Eigen::MatrixXd(rhs.head(m));
+        if (!solveOutOfCore(records, m, B, options.scratchDir,
+                            options.outOfCoreBudget, x, report.outOfCore)) {
+            Eigen::SparseMatrix<double> A;
+            assembleSparse(records, m, options.assemblyThreads, A, rhs);
+            x = solveSparseBlock(A, B);
+        }
+    } else if (options.domains > 1 && table == nullptr && !adjoint) {
+        // Interiors factorized by worker processes, the interface by this
+        // one; solved directly if the split fails
+        Eigen::SparseMatrix<double> A;
+        assembleSparse(records, m, options.assemblyThreads, A, rhs);
+        LocalTransport transport;
+        Eigen::VectorXd solution;
+        if (solveDomains(A, rhs.head(m), options.domains, transport, solution,
+                         report.domains))
+            x = solution;
+        else
+            x = solveSparse(A, rhs.head(m));
+    } else if (options.relaxCut > 0 && table == nullptr && !adjoint) {
+        // Partitions coupled only through the cut resistors and controlling
+        // unknowns, relaxed against each other; solved directly if that
+        // does not converge
+        Eigen::SparseMatrix<double> A;
+        assembleSparse(records, m, options.assemblyThreads, A, rhs);
+        x = solveRelaxed(A, rhs.head(m),
+                         partitionUnknowns(records, m, options.relaxCut),
+                         options.assemblyThreads, report.relaxation);
+        if (!report.relaxation.converged) x = solveSparse(A, rhs.head(m));
+    } else if (options.sparse) {
+        Eigen::SparseMatrix<double> A;
+        assembleSparse(records, m, options.assemblyThreads, A, rhs);
+        if (table != nullptr)
+            x = solveSparseBlock(
+                A, makeTableRhs(*table, island.elements, localIndexMap, rhs)
+                       .topRows(m));
+        else if (adjoint)
+            x = solveSparse(A, rhs.head(m), localSeeds, localAdjoints);
+        else if (options.mixedPrecision)
+            x = solveSparseMixed(A, rhs.head(m), report);
+        else
+            x = solveSparse(A, rhs.head(m), options.equilibrate, report);
+    } else {
+        Eigen::MatrixXd mna = Eigen::MatrixXd::Zero(m + 1, m + 1);
+        DenseSink sink{mna, rhs};
+        stampRecords(records, sink);
+
+        if (table != nullptr)
+            x = solveDenseBlock(
+                mna.topLeftCorner(m, m),
+                makeTableRhs(*table, island.elements, localIndexMap, rhs)
+                    .topRows(m));
+        else if (adjoint)
+            x = solveDense(mna.topLeftCorner(m, m), rhs.head(m), localSeeds,
+                           localAdjoints);
+        else if (options.mixedPrecision)
+            x = solveDenseMixed(mna.topLeftCorner(m, m), rhs.head(m), report);
+        else
+            x = solveDenseChecked(records, m, options.equilibrate, mna, rhs,
+                                  report);
+    }
+
+    for (auto &entry : localIndexMap)
+        if (entry.second == report.pivotUnknown)
+            report.pivotName = entry.first;
+
+    for (auto &entry : localIndexMap) {
+        X.row(indexMap.at(entry.first)) = x.row(entry.second);
+        if (adjoint)
+            adjoints->row(indexMap.at(entry.first)) =
+                localAdjoints.row(entry.second);
     }
 
+    return report;
+}
+
+std::vector<SolveReport> solveIslands(
+    std::vector<Island> &islands, const std::map<std::string, int> &indexMap,
+    const SolverOptions &options, Eigen::MatrixXd &X,
+    const Eigen::MatrixXd *seeds, Eigen::MatrixXd *adjoints,
+    const SourceTable *table)
+{
+    std::vector<SolveReport> reports(islands.size());
+
+    // Largest islands first so that the threads finish close together
+    std::vector<size_t> order(islands.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return islands[a].nodes.size() > islands[b].nodes.size();
+    });
+
+    // Threads left over by the islands assemble the systems of each island
+    size_t threadCount = islandThreads(islands.size(), options);
+    SolverOptions islandOptions = options;
+    islandOptions.assemblyThreads =
+        std::max(1, solverThreads(options) / int(std::max<size_t>(
+                                                 threadCount, 1)));
+
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t k = next++; k < order.size(); k = next++)
+            if (islands[order[k]].valid)
+                reports[order[k]] =
+                    solveIsland(islands[order[k]], indexMap, islandOptions, X,
+                                seeds, adjoints, table);
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < threadCount; t++) threads.emplace_back(worker);
+    worker();
+    for (std::thread &thread : threads) thread.join();
+
+    return reports;
+}
+
+int exportSystem(Parser &parser, const std::map<std::string, int> &indexMap,
+                 const std::string &base, int threads)
+{
+    int m = int(indexMap.size());
+    Eigen::SparseMatrix<double> A;
+    Eigen::VectorXd rhs;
+    assembleSparse(makeStampRecords(parser.circuitElements, indexMap), m,
+                   threads, A, rhs);
+
+    std::vector<std::string> names(m);
+    for (auto &entry : indexMap) names[entry.second] = entry.first;
+
+    if (writeMatrixMarket(base, A, rhs.head(m), names) != 0) return 1;
+    std::cout << "MNA system (" << m << " unknowns, " << A.nonZeros()
+              << " non-zeros) written to " + base + ".mtx" << std::endl;
+    return 0;
+}
+
+typedef std::chrono::steady_clock Clock;
+
+static double milliseconds(Clock::time_point from, Clock::time_point to)
+{
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+static void printReplayRow(const std::string &backend, double factorTime,
+                           double solveTime, double residual,
+                           const std::string &note)
+{
+    std::cout << std::left << std::setw(32) << backend << std::right
+              << std::fixed << std::setprecision(3) << std::setw(14)
+              << factorTime << std::setw(14) << solveTime << std::scientific
+              << std::setw(14) << residual << (note.empty() ? "" : "  " + note)
+              << std::endl;
+}
+
+template <class Ordering>
+static void replaySparse(const std::string &backend,
+                         const Eigen::SparseMatrix<double> &A,
+                         const Eigen::VectorXd &b)
+{
+    Clock::time_point start = Clock::now();
+    Eigen::SparseLU<Eigen::SparseMatrix<double>, Ordering> lu;
+    lu.compute(A);
+    Clock::time_point factored = Clock::now();
+    if (lu.info() != Eigen::Success) {
+        std::cout << std::left << std::setw(32) << backend
+                  << "failed: " + lu.lastErrorMessage() << std::endl;
+        return;
+    }
+    Eigen::VectorXd x = lu.solve(b);
+    Clock::time_point solved = Clock::now();
+
+    printReplayRow(backend, milliseconds(start, factored),
+                   milliseconds(factored, solved), scaledResidual(A, x, b),
+                   "fill " + std::to_string(lu.nnzL() + lu.nnzU()));
+}
+
+// Dense backends are skipped above this many unknowns
+static const int denseReplayLimit = 5000;
+
+int runReplay(const std::string &base)
+{
+    Eigen::SparseMatrix<double> A;
+    Eigen::VectorXd b;
+    std::vector<std::string> names;
+    if (readMatrixMarket(base, A, b, names) != 0) return 1;
+
+    std::cout << "\nReplaying " + base + ".mtx: " << A.rows()
+              << " unknowns, " << A.nonZeros() << " non-zeros\n"
+              << std::endl;
+    std::cout << std::left << std::setw(32) << "Backend" << std::right
+              << std::setw(14) << "Factor (ms)" << std::setw(14)
+              << "Solve (ms)" << std::setw(14) << "Residual" << std::endl;
+
+    if (A.rows() <= denseReplayLimit) {
+        Eigen::MatrixXd dense = A;
+
+        Clock::time_point start = Clock::now();
+        Eigen::PartialPivLU<Eigen::MatrixXd> lu(dense);
+        Clock::time_point factored = Clock::now();
+        Eigen::VectorXd x = lu.solve(b);
+        Clock::time_point solved = Clock::now();
+        printReplayRow("dense LU", milliseconds(start, factored),
+                       milliseconds(factored, solved),
+                       scaledResidual(dense, x, b), "");
+
+        // Factorization and refinement are a single step here
+        SolveReport report;
+        start = Clock::now();
+        x = solveDenseMixed(dense, b, report);
+        solved = Clock::now();
+        printReplayRow("dense LU, mixed precision",
+                       milliseconds(start, solved), 0.0, report.residual,
+                       std::to_string(report.refinements) + " refinement(s)" +
+                           (report.fellBack ? ", fell back to double" : ""));
+    } else
+        std::cout << std::left << std::setw(32) << "dense LU"
+                  << "skipped, more than " << denseReplayLimit << " unknowns"
+                  << std::endl;
+
+    replaySparse<Eigen::COLAMDOrdering<int>>("sparse LU, COLAMD ordering", A,
+                                             b);
+    replaySparse<Eigen::AMDOrdering<int>>("sparse LU, AMD ordering", A, b);
+    replaySparse<Eigen::NaturalOrdering<int>>("sparse LU, natural ordering",
+                                              A, b);
+
+    SolveReport report;
+    Clock::time_point start = Clock::now();
+    Eigen::VectorXd x = solveSparseMixed(A, b, report);
+    Clock::time_point solved = Clock::now();
+    printReplayRow("sparse LU, mixed precision", milliseconds(start, solved),
+                   0.0, report.residual,
+                   std::to_string(report.refinements) + " refinement(s)" +
+                       (report.fellBack ? ", fell back to double" : ""));
+    return 0;
+}
+
+// Voltages of the nodes removed by the reduction and currents of the group 2
+// elements that have no branch unknown
+static void completeSolution(
+    const Reduction &reduction,
+    const std::vector<std::shared_ptr<CircuitElement>> &currentProbes,
+    std::map<std::string, int> &indexMap, Eigen::MatrixXd &X)
+{
+    recoverEliminated(reduction, indexMap, X);
+    appendProbeCurrents(
+        makeCurrentProbes(currentProbes, indexMap, int(X.rows())), indexMap,
+        X);
+}
+
+// Computed currents of the tabulated elements, which follow their value in
+// every case
+static void tabulatedCurrents(
+    const SourceTable &table,
+    const std::vector<std::shared_ptr<CircuitElement>> &currentProbes,
+    const std::map<std::string, int> &indexMap, Eigen::MatrixXd &X)
+{
+    int ground = int(X.rows());
+    auto at = [&](int row, int column) {
+        return row == ground ? 0.0 : X(row, column);
+    };
+    for (std::shared_ptr<CircuitElement> element : currentProbes) {
+        std::vector<std::string>::const_iterator column = std::find(
+            table.sources.begin(), table.sources.end(), element->name);
+        if (column == table.sources.end() || !indexMap.count(element->name))
+            continue;
+        int row = indexMap.at(element->name);
+        double value = element->value;
+        for (int c = 0; c < X.cols(); c++) {
+            element->value = table.values(c, column - table.sources.begin());
+            CurrentProbes probe =
+                makeCurrentProbes({element}, indexMap, ground);
+            X(row, c) =
+                probe.gain(0) * (at(probe.a(0), c) - at(probe.b(0), c)) +
+                probe.branchGain(0) * at(probe.branch(0), c) +
+                probe.offset(0);
+        }
+        element->value = value;
+    }
+}
+
+int runSweep(const Sweep &sweep, std::vector<Island> &islands,
+             const std::map<std::string, int> &indexMap,
+             const Reduction &reduction,
+             const std::vector<std::shared_ptr<CircuitElement>> &currentProbes,
+             const SolverOptions &options,
+             const std::vector<std::pair<std::string, int>> &outputs,
+             const Eigen::MatrixXd &X)
+{
+    // Islands hold one row per island of a source bridging two of them
+    const CircuitElement *source = nullptr;
+    for (Island &island : islands)
+        for (std::shared_ptr<CircuitElement> element : island.elements)
+            if (element->name == sweep.source) source = element.get();
+    std::vector<std::shared_ptr<CircuitElement>> copies;
+    for (std::shared_ptr<CircuitElement> element : currentProbes)
+        if (element->name == sweep.source) copies.push_back(element);
+    if (source == nullptr && copies.empty()) {
+        std::cout << "Error: Swept source " + sweep.source +
+                         " is not part of the solved circuit"
+                  << std::endl;
+        return 1;
+    }
+
+    // Response to a change of the source by delta
+    double base = source != nullptr ? source->value : copies[0]->value;
+    double delta = std::max(std::abs(base), 1.0);
+    for (Island &island : islands)
+        setValue(island.circuit, sweep.source, base + delta);
+    for (std::shared_ptr<CircuitElement> element : copies)
+        element->value = base + delta;
+    // Unknowns of invalid islands are missing from the map, not the indices
+    int m = 0;
+    for (const std::pair<const std::string, int> &entry : indexMap)
+        m = std::max(m, entry.second + 1);
+    std::map<std::string, int> shiftedMap = indexMap;
+    Eigen::MatrixXd shifted = Eigen::MatrixXd::Zero(m, 1);
+    solveIslands(islands, indexMap, options, shifted);
+    completeSolution(reduction, currentProbes, shiftedMap, shifted);
+    for (Island &island : islands)
+        setValue(island.circuit, sweep.source, base);
+    for (std::shared_ptr<CircuitElement> element : copies)
+        element->value = base;
+
+    std::vector<std::string> names;
+    Eigen::VectorXd origin(outputs.size()), slope(outputs.size());
+    for (size_t k = 0; k < outputs.size(); k++) {
+        names.push_back(outputs[k].first);
+        origin(k) = X(outputs[k].second);
+        slope(k) = (shifted(shiftedMap.at(outputs[k].first)) - origin(k)) /
+                   delta;
+    }
+
+    std::string file = options.waveFile;
+    if (file.empty()) {
+        size_t dot = options.netlist.find_last_of('.');
+        size_t slash = options.netlist.find_last_of('/');
+        file = (dot != std::string::npos &&
+                        (slash == std::string::npos || dot > slash)
+                    ? options.netlist.substr(0, dot)
+                    : options.netlist) +
+               ".wave";
+    }
+
+    WaveformWriter writer;
+    if (writer.open(file, sweep.source, names, options.waveTolerance) != 0)
+        return 1;
+    long points = long(std::floor((sweep.stop - sweep.start) / sweep.step +
+                                  1e-9)) +
+                  1;
+    for (long k = 0; k < points; k++) {
+        double value = sweep.start + double(k) * sweep.step;
+        writer.append(value, origin + (value - base) * slope);
+    }
+    if (writer.close() != 0) return 1;
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "\nDC sweep of " + sweep.source + ": " << writer.points()
+              << " point(s) of " << names.size() << " signal(s) written to " +
+                                                        file + " ("
+              << writer.bytes() << " bytes, "
+              << double(writer.bytes()) /
+                     double(std::max<std::uint64_t>(
+                         writer.points() * (names.size() + 1), 1))
+              << " bytes per value)" << std::endl;
+    return 0;
+}
+
+int runWaveRead(const SolverOptions &options)
+{
+    WaveformReader reader;
+    if (reader.open(options.readWave) != 0) return 1;
+
+    std::vector<std::string> names =
+        options.probes.empty() ? reader.names : options.probes;
+    std::vector<double> axis;
+    std::vector<std::vector<double>> values(names.size());
+    for (size_t k = 0; k < names.size(); k++)
+        if (reader.read(names[k], options.windowFrom, options.windowTo, axis,
+                        values[k]) != 0)
+            return 1;
+
+    std::cout << std::fixed << std::setprecision(5) << "\n" << reader.axis;
+    for (std::string &name : names) std::cout << "\t\t" << name;
+    std::cout << "\n";
+    for (size_t point = 0; point < axis.size(); point++) {
+        std::cout << axis[point];
+        for (std::vector<double> &signal : values)
+            std::cout << "\t\t" << signal[point];
+        std::cout << "\n";
+    }
+    std::cout << std::flush;
+    return 0;
+}
+
+void printSensitivities(
+    const std::vector<std::string> &outputs, std::vector<Island> &islands,
+    const std::map<std::string, int> &solveMap,
+    const std::map<std::string, int> &indexMap,
+    const std::vector<std::shared_ptr<CircuitElement>> &currentProbes,
+    const Eigen::MatrixXd &X, const Eigen::MatrixXd &adjoints)
+{
+    std::vector<std::shared_ptr<CircuitElement>> elements;
+    for (Island &island : islands)
+        if (island.valid)
+            elements.insert(elements.end(), island.elements.begin(),
+                            island.elements.end());
+
+    int m = int(solveMap.size());
+    for (size_t k = 0; k < outputs.size(); k++) {
+        std::map<std::string, int>::const_iterator output =
+            indexMap.find(outputs[k]);
+        if (output == indexMap.end()) {
+            std::cout << "Warning: Sensitivity output " + outputs[k] +
+                             " has no value in the solution"
+                      << std::endl;
+            continue;
+        }
+
+        std::vector<Sensitivity> sensitivities = computeSensitivities(
+            elements, solveMap, X.col(0).head(m), adjoints.col(k),
+            outputs[k], X(output->second), currentProbes);
+
+        std::cout << std::scientific << std::setprecision(5);
+        std::cout << "\nSensitivity of " + outputs[k] + " ("
+                  << X(output->second) << ")" << std::endl;
+        for (Sensitivity &sensitivity : sensitivities)
+            std::cout << sensitivity.element << "\t\t"
+                      << sensitivity.derivative << std::endl;
+    }
+}
+
+int loadSourceTable(SolverOptions &options, const Parser &parser,
+                    SourceTable &table)
+{
+    bool batch = !options.batchTable.empty();
+    std::string option = batch ? "--batch" : "--source-table";
+    if (batch && !options.sourceTable.empty()) {
+        std::cout << "Error: --batch cannot be combined with --source-table"
+                  << std::endl;
+        return 1;
+    }
+    int error =
+        parseSourceTable(batch ? options.batchTable : options.sourceTable,
+                         table);
+
+    std::map<std::string, Component> types;
+    for (const std::shared_ptr<CircuitElement> &element :
+         parser.circuitElements)
+        types[element->name] = element->type;
+    for (const std::string &source : table.sources) {
+        std::map<std::string, Component>::iterator type = types.find(source);
+        if (type != types.end() &&
+            (type->second == V || type->second == I ||
+             (batch && (type->second == R || type->second == Ic ||
+                        type->second == Vc))))
+            continue;
+        std::cout << (batch ? "Error: Batch element " + source +
+                                  " is not a resistor or source of the "
+                                  "netlist"
+                            : "Error: Tabulated source " + source +
+                                  " is not an independent source of the "
+                                  "netlist")
+                  << std::endl;
+        error += 1;
+    }
+
+    if (!parser.sweep.source.empty() || !parser.sensitivities.empty()) {
+        std::cout << "Error: " + option + " cannot be combined with .DC or "
+                                          ".SENS"
+                  << std::endl;
+        error += 1;
+    }
+    if (options.mixedPrecision) {
+        std::cout << "Warning: --mixed-precision is ignored with " + option
+                  << std::endl;
+        options.mixedPrecision = false;
+    }
+    if (batch && options.sparse) {
+        std::cout << "Warning: --sparse is ignored with --batch" << std::endl;
+        options.sparse = false;
+    }
+    return error;
+}
+
+void printCases(const std::vector<std::pair<std::string, int>> &outputs,
+                Eigen::MatrixXd &X)
+{
+    std::cout << std::fixed << std::setprecision(5) << "\nCASE";
+    for (const std::pair<std::string, int> &output : outputs)
+        std::cout << "\t\t" << output.first;
+    std::cout << "\n";
+    for (int column = 0; column < X.cols(); column++) {
+        std::cout << column + 1;
+        for (const std::pair<std::string, int> &output : outputs)
+            std::cout << "\t\t" << X(output.second, column);
+        std::cout << "\n";
+    }
+    std::cout << std::flush;
+}
+
+int runSolver(int argc, char *argv[])
+{
+    // Netlist name (circuit.sns by default) and options
+    SolverOptions options;
+    if (parseArguments(argc, argv, options) != 0) return 1;
+
+    // Only the solver backends run on a previously exported system
+    if (!options.replayBase.empty()) return runReplay(options.replayBase);
+
+    // Only prints signals of a previously written sweep
+    if (!options.readWave.empty()) return runWaveRead(options);
+
+    // Peak resident memory of every phase
+    PhaseMemory phases;
+    resetPeakResident();
+
     // Creates a parser to store the circuit in form of vector
     Parser parser;
-    if (parser.parse(filename) != 0) return 1;
+    parser.probes = options.probes;
+    if (parser.parse(options.netlist) != 0) return 1;
+
+    // Parameters given on the command line; the element values are computed
+    // again from the compiled expressions, without parsing the netlist again
+    if (!options.parameters.empty()) {
+        for (std::pair<std::string, double> &parameter : options.parameters)
+            if (!parser.parameters.set(parameter.first, parameter.second)) {
+                std::cout << "Error: Unknown parameter " + parameter.first +
+                                 " given on the command line"
+                          << std::endl;
+                return 1;
+            }
+        if (parser.parameters.apply() != 0) return 1;
+    }
+
+    // Source values of several cases, solved together
+    SourceTable table;
+    bool tabulated =
+        !options.sourceTable.empty() || !options.batchTable.empty();
+    if (tabulated && loadSourceTable(options, parser, table) != 0) return 1;
+
+    // Operating points solved before are printed from the cache. Sweeps,
+    // sensitivities, exports, generated code, saved models and health
+    // reports need more than the printed results.
+    ResultCache cache;
+    if (!options.cacheDir.empty() &&
+        cache.open(options.cacheDir, options.cacheLimit) != 0)
+        return 1;
+    bool cached = !options.cacheDir.empty() && parser.sweep.source.empty() &&
+                  parser.sensitivities.empty() && options.exportBase.empty() &&
+                  options.codegenFile.empty() && options.morSave.empty() &&
+                  !options.health;
+    std::string description;
+    if (cached) {
+        std::ostringstream analysis;
+        analysis << "reduce=" << options.reduce
+                 << " mixed=" << options.mixedPrecision
+                 << " sparse=" << options.sparse
+                 << " mem-limit=" << options.memLimit
+                 << " mor=" << options.morMoments
+                 << " relax=" << options.relaxCut
+                 << " domains=" << options.domains
+                 << " equilibrate=" << options.equilibrate;
+        description = describeCircuit(parser, table, analysis.str());
+
+        std::vector<std::string> names;
+        Eigen::MatrixXd values;
+        if (cache.lookup(description, names, values)) {
+            std::cout << "\nResult cache hit" << std::endl;
+            std::vector<std::pair<std::string, int>> outputs;
+            for (size_t k = 0; k < names.size(); k++)
+                outputs.emplace_back(names[k], int(k));
+            if (tabulated)
+                printCases(outputs, values);
+            else
+                printxX(outputs, values);
+            if (options.cacheStats) cache.printStatistics();
+            return 0;
+        }
+    }
+
+    // Reduced models of .ROM files are stamped in place of the subnetworks
+    // they were made from, then the passive subnetworks left are reduced
+    int loadedModels = 0;
+    for (const std::string &file : parser.reducedModels) {
+        std::vector<ReducedModel> loaded;
+        if (loadReducedModels(file, loaded) != 0) return 1;
+        for (ReducedModel &model : loaded) {
+            std::string name = "ROM" + std::to_string(loadedModels++);
+            if (stampReducedModel(parser, model, name) != 0) return 1;
+        }
+    }
+    if (options.morMoments > 0) {
+        std::vector<ReducedModel> models;
+        if (reduceNetworks(parser, options.morMoments, models) != 0)
+            return 1;
+        for (size_t k = 0; k < models.size(); k++)
+            std::cout << "Reduced model MOR" << k << ": "
+                      << models[k].elements << " element(s), "
+                      << models[k].internal << " internal unknown(s) -> "
+                      << models[k].ports.size() << " port(s) and "
+                      << models[k].G.rows() - models[k].ports.size()
+                      << " state(s)" << std::endl;
+        if (!options.morSave.empty() &&
+            saveReducedModels(options.morSave, models) != 0)
+            return 1;
+    }
+
+    // Collapses series/parallel resistors before any unknown is numbered
+    Reduction reduction;
+    if (options.reduce && !parser.sensitivities.empty()) {
+        std::cout << "Warning: --reduce is ignored, .SENS needs every element"
+                  << std::endl;
+        options.reduce = false;
+    }
+    if (options.reduce) {
+        size_t unknowns = parser.nodes_group2.size();
+        std::set<std::string> variable(table.sources.begin(),
+                                       table.sources.end());
+        if (!parser.sweep.source.empty()) variable.insert(parser.sweep.source);
+        reduction = reduceCircuit(parser, variable);
+        std::cout << "\nReduction: " << reduction.series
+                  << " series pair(s), " << reduction.parallel
+                  << " parallel resistor(s), " << reduction.sources
+                  << " parallel current source(s), " << reduction.dangling
+                  << " dangling resistor(s) removed" << std::endl;
+        std::cout << "Unknowns reduced from " << unknowns - 1 << " to "
+                  << parser.nodes_group2.size() - 1 << std::endl;
+    }
+
+    phases.record("parse");
 
     // Map to store all nodes' and group_2 elements' index position in MNA and
     // RHS matrix
     std::map<std::string, int> indexMap;
     makeIndexMap(indexMap, parser);
 
-    // Creates MNA and RHS matrix and initializes to 0.0
     int m = int(indexMap.size());
-    std::vector<std::vector<double>> mna(m, std::vector<double>(m, 0.0));
-    std::vector<double> rhs(m, 0.0);
 
-    // Map to store the graph of the circuit
-    std::map<std::string, std::shared_ptr<Node>> nodeMap;
-    makeGraph(nodeMap, parser);
+    // Adjacency of the circuit graph
+    Graph graph = makeGraph(parser.circuitElements);
 
-    // Picks the first node from nodeMap
-    std::map<std::string, std::shared_ptr<Node>>::iterator startNodeIter =
-        nodeMap.begin();
-    advance(startNodeIter, 1);
+    // Splits the circuit into islands that can be solved independently
+    std::vector<Island> islands;
+    int invalid = findIslands(graph, indexMap, islands);
+    std::cout << "Total Independent Island(s) in the Circuit: "
+              << islands.size() << std::endl;
 
-    // Traverses the whole graph and populates the MNA and RHS matrices
-    if (startNodeIter != nodeMap.end())
-        startNodeIter->second->traverse(indexMap, mna, rhs);
+    // Picks a solve path whose systems fit the memory limit before any of
+    // them is allocated
+    if (options.memLimit != 0) {
+        SolvePath preferred = options.sparse           ? sparseSolve
+                              : options.mixedPrecision ? mixedSolve
+                                                       : denseSolve;
+        MemoryPlan plan = planMemory(
+            islands, indexMap, islandThreads(islands.size(), options),
+            preferred, options.memLimit, !options.scratchDir.empty());
+        printMemoryPlan(plan, options.memLimit);
+        if (!plan.fits) {
+            std::cout << "Error: No solve path fits the memory limit"
+                      << std::endl;
+            return 1;
+        }
+        // Adjoint solves of an out-of-core plan stay in memory, sparse
+        options.sparse =
+            plan.path == sparseSolve || plan.path == outOfCoreSolve;
+        // Single precision sparse factors are smaller than the double
+        // ones the sparse estimate counts
+        options.mixedPrecision =
+            plan.path == mixedSolve ||
+            (plan.path == sparseSolve && options.mixedPrecision);
+        options.outOfCore = plan.path == outOfCoreSolve;
 
-    // Code to solve using Eigen Library
-    std::vector<double> v;
-    for (int i = 0; i < m; i++)
-        for (int j = 0; j < m; j++) v.push_back(mna[i][j]);
+        // What the limit leaves is shared by the islands solved at once
+        for (const MemoryEstimate &estimate : plan.candidates)
+            if (options.outOfCore && estimate.path == outOfCoreSolve)
+                options.outOfCoreBudget =
+                    (options.memLimit - plan.resident - estimate.bytes) /
+                    islandThreads(islands.size(), options);
+    } else if (!options.scratchDir.empty()) {
+        std::cout << "Warning: --scratch is ignored without --mem-limit"
+                  << std::endl;
+    }
+    phases.record("topology");
 
-    Eigen::MatrixXd MNA;
-    MNA.resize(m, m);
-    MNA = Eigen::MatrixXd::Map(&v[0], m, m).transpose();
+    if (!options.exportBase.empty() &&
+        exportSystem(parser, indexMap, options.exportBase,
+                     solverThreads(options)) != 0)
+        return 1;
 
-    Eigen::MatrixXd RHS;
-    RHS.resize(m, 1);
-    RHS = Eigen::MatrixXd::Map(&rhs[0], m, 1);
+    // Straight line solve of this topology, checked against the solver below
+    StaticSolve generated;
+    if (!options.codegenFile.empty()) {
+        if (invalid != 0) {
+            std::cout << "Error: No code is generated for a circuit with "
+                         "invalid islands"
+                      << std::endl;
+            return 1;
+        }
+        if (makeStaticSolve(parser.circuitElements, indexMap, generated) !=
+                0 ||
+            writeStaticSolve(options.codegenFile, generated,
+                             options.netlist) != 0)
+            return 1;
+        std::cout << "Solve of " << m << " unknown(s) in "
+                  << generated.ops.size()
+                  << " operation(s) written to " + options.codegenFile
+                  << std::endl;
+    }
 
     // De-allocating previously allocated
     // memory for solve method to use
     parser.circuitElements.clear();
-    for (std::map<std::string, std::shared_ptr<Node>>::iterator i =
-             nodeMap.begin();
-         i != nodeMap.end(); i++) {
-        i->second->edges.clear();
+    graph = Graph();
+
+    // Adjoint right hand sides of the .SENS outputs, solved with the same
+    // factorizations as the circuit
+    Eigen::MatrixXd seeds, adjoints;
+    if (makeSensitivitySeeds(parser.sensitivities, indexMap,
+                             parser.currentProbes, seeds) != 0)
+        return 1;
+    adjoints = Eigen::MatrixXd::Zero(m, seeds.cols());
+    bool sensitivity = !parser.sensitivities.empty();
+
+    // One column per case of the source table
+    Eigen::MatrixXd X =
+        Eigen::MatrixXd::Zero(m, tabulated ? table.values.rows() : 1);
+    std::vector<SolveReport> reports = solveIslands(
+        islands, indexMap, options, X, sensitivity ? &seeds : nullptr,
+        &adjoints, tabulated ? &table : nullptr);
+    phases.record("solve");
+
+    if (options.mixedPrecision) {
+        std::cout << std::scientific << std::setprecision(3) << "\n";
+        for (size_t k = 0; k < islands.size(); k++) {
+            if (!islands[k].valid) continue;
+            std::cout << "Island " << k << ": " << reports[k].refinements
+                      << " refinement step(s), scaled residual "
+                      << reports[k].residual
+                      << (reports[k].fellBack
+                              ? ", did not converge, solved in double"
+                              : "")
+                      << std::endl;
+        }
+    }
+    if (!options.codegenFile.empty() && !tabulated) {
+        Eigen::VectorXd x;
+        if (runStaticSolve(generated, generated.defaults, x))
+            std::cout << std::scientific << std::setprecision(3)
+                      << "Generated solve differs from the solver by "
+                      << (x - X.col(0)).lpNorm<Eigen::Infinity>() /
+                             std::max(1.0, X.col(0).lpNorm<Eigen::Infinity>())
+                      << std::endl;
     }
-    nodeMap.clear();
-    mna.clear();
-    rhs.clear();
-    v.clear();
+    if (options.relaxCut > 0) printRelaxation(islands, reports);
+    if (!options.batchTable.empty()) printBatch(islands, reports);
+    if (options.outOfCore) printOutOfCore(islands, reports);
+    if (options.domains > 1) printDomains(islands, reports);
+    printHealth(islands, reports, options.health);
 
-    Eigen::MatrixXd X = MNA.lu().solve(RHS);
+    // Unknowns of invalid islands have no meaningful value
+    std::map<std::string, int> fullMap = indexMap;
+    for (Island &island : islands) {
+        if (island.valid) continue;
+        for (std::string &node : island.nodes) indexMap.erase(node);
+        for (std::shared_ptr<CircuitElement> element : island.elements)
+            indexMap.erase(element->name);
+    }
 
-    printxX(indexMap, X);
-    return 0;
+    // Currents are computed for the group 2 elements that have no branch
+    // unknown, only the probed ones when probes are given
+    std::vector<std::shared_ptr<CircuitElement>> currentProbes;
+    std::set<std::string> probed(parser.probes.begin(), parser.probes.end());
+    if (!probed.empty())
+        probed.insert(parser.sensitivities.begin(),
+                      parser.sensitivities.end());
+    for (std::shared_ptr<CircuitElement> element : parser.currentProbes)
+        if (probed.empty() || probed.count(element->name))
+            currentProbes.push_back(element);
+
+    std::map<std::string, int> solvedMap = indexMap;
+    completeSolution(reduction, currentProbes, indexMap, X);
+
+    if (tabulated)
+        tabulatedCurrents(table, currentProbes, indexMap, X);
+
+    std::vector<std::pair<std::string, int>> outputs;
+    int unknownProbes = selectOutputs(indexMap, parser.probes, outputs);
+    if (tabulated)
+        printCases(outputs, X);
+    else
+        printxX(outputs, X);
+
+    if (cached && invalid == 0 && unknownProbes == 0) {
+        std::vector<std::string> names;
+        Eigen::MatrixXd values(outputs.size(), X.cols());
+        for (size_t k = 0; k < outputs.size(); k++) {
+            names.push_back(outputs[k].first);
+            values.row(int(k)) = X.row(outputs[k].second);
+        }
+        cache.store(description, names, values);
+    }
+
+    if (sensitivity)
+        printSensitivities(parser.sensitivities, islands, fullMap, indexMap,
+                           currentProbes, X, adjoints);
+
+    if (!parser.sweep.source.empty() &&
+        runSweep(parser.sweep, islands, solvedMap, reduction, currentProbes,
+                 options, outputs, X) != 0)
+        return 1;
+
+    phases.record("output");
+    if (options.memLimit != 0) phases.print();
+    if (options.cacheStats && !options.cacheDir.empty())
+        cache.printStatistics();
+    return invalid == 0 && unknownProbes == 0 ? 0 : 1;
 }
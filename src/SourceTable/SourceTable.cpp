@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
+ * Reserved. Permission to use, copy, modify and distribute this software for
+ * educational, research, and not-for-profit purposes, without fee and without a
+ * signed license agreement, is hereby granted, provided that this paragraph and
+ * the following two paragraphs appear in all copies, modifications, and
+ * distributions.
+ *
+ * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
+ * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
+ * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
+ *
+ * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
+ * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ */
+/**
+ * @file SourceTable.cpp
+ *
+ * @brief Contains the implementation of the source value tables
+ */
+
+#include "../../include/SourceTable.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "../../include/Expression.hpp"
+#include "../../include/Stamp.hpp"
+
+using std::cout, std::endl;
+
+int parseSourceTable(const std::string &file, SourceTable &table)
+{
+    std::ifstream fileStream(file);
+    if (!fileStream) {
+        cout << "Error: Source table " + file + " not available" << endl;
+        return 1;
+    }
+
+    std::string line;
+    std::vector<double> values;
+    int lineNumber = 0, error = 0, cases = 0;
+    table.sources.clear();
+    while (getline(fileStream, line)) {
+        lineNumber++;
+        std::transform(line.begin(), line.end(), line.begin(), ::toupper);
+        std::replace(line.begin(), line.end(), ',', ' ');
+
+        std::stringstream ss(line);
+        std::vector<std::string> tokens;
+        std::string buf;
+        while (ss >> buf) tokens.push_back(buf);
+        if (tokens.size() == 0 || tokens.at(0).find("%") == 0) continue;
+
+        // Header
+        if (table.sources.empty()) {
+            for (size_t k = 0; k < tokens.size(); k++)
+                if (std::find(tokens.begin(), tokens.begin() + k,
+                              tokens[k]) != tokens.begin() + k) {
+                    cout << "Error: " + tokens[k] +
+                                " is named twice in the header of the "
+                                "source table"
+                         << endl;
+                    error += 1;
+                }
+            table.sources = tokens;
+            continue;
+        }
+
+        if (tokens.size() != table.sources.size()) {
+            cout << "Error: Expected " << table.sources.size()
+                 << " values at line number " << lineNumber
+                 << " of the source table: " + line << endl;
+            error += 1;
+            continue;
+        }
+        for (const std::string &token : tokens) {
+            double value = 0.0;
+            if (!parseEngineering(token, value)) {
+                cout << "Error: Illegal value at line number " << lineNumber
+                     << " of the source table: " + line << endl;
+                error += 1;
+                value = 0.0;
+            }
+            values.push_back(value);
+        }
+        cases++;
+    }
+
+    if (cases == 0) {
+        cout << "Error: Source table " + file + " has no cases" << endl;
+        error += 1;
+    }
+
+    // Values were read case by case
+    table.values = Eigen::Map<Eigen::Matrix<double, Eigen::Dynamic,
+                                            Eigen::Dynamic, Eigen::RowMajor>>(
+        values.data(), cases, Eigen::Index(table.sources.size()));
+    return error;
+}
+
+Eigen::MatrixXd makeTableRhs(
+    const SourceTable &table,
+    const std::vector<std::shared_ptr<CircuitElement>> &elements,
+    const std::map<std::string, int> &indexMap, const Eigen::VectorXd &rhs)
+{
+    int sources = int(table.sources.size());
+    Eigen::MatrixXd units = Eigen::MatrixXd::Zero(rhs.size(), sources);
+    Eigen::RowVectorXd netlist = Eigen::RowVectorXd::Zero(sources);
+
+    // Unit RHS of every tabulated source in the system; an element bridging
+    // two islands appears here as its half
+    for (const std::shared_ptr<CircuitElement> &element : elements) {
+        std::vector<std::string>::const_iterator found = std::find(
+            table.sources.begin(), table.sources.end(), element->name);
+        if (found == table.sources.end()) continue;
+
+        int column = int(found - table.sources.begin());
+        StampRecord record = makeStampRecord(*element, indexMap);
+        record.value = 1.0;
+        RhsSink sink{units.col(column)};
+        kernelTable<RhsSink>[record.kernel](&record, &record + 1, sink);
+        netlist(column) = element->value;
+    }
+
+    Eigen::MatrixXd change = table.values;
+    change.rowwise() -= netlist;
+
+    Eigen::MatrixXd B = rhs.replicate(1, table.values.rows());
+    B.noalias() += units * change.transpose();
+    return B;
+}
@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
+ * Reserved. Permission to use, copy, modify and distribute this software for
+ * educational, research, and not-for-profit purposes, without fee and without a
+ * signed license agreement, is hereby granted, provided that this paragraph and
+ * the following two paragraphs appear in all copies, modifications, and
+ * distributions.
+ *
+ * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
+ * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
+ * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
+ *
+ * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
+ * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+/**
+ * @file Stamp.cpp
+ *
+ * @brief Contains the implementation of the stamp record creation
+ */
+
+#include "../../include/Stamp.hpp"
+
+#include <algorithm>
+#include <thread>
+
+StampRecord makeStampRecord(const CircuitElement &element,
+                            const std::map<std::string, int> &indexMap)
+{
+    const int sentinel = int(indexMap.size());
+    auto index = [&](const std::string &name) {
+        std::map<std::string, int>::const_iterator iter = indexMap.find(name);
+        return iter != indexMap.end() ? iter->second : sentinel;
+    };
+
+    StampRecord record;
+    record.kernel = kernelIndex(element.type, element.group,
+                                element.controlling_variable);
+    record.a = index(element.nodeA);
+    record.b = index(element.nodeB);
+    record.branch = index(element.name);
+    record.value = element.value;
+    record.ca = record.cb = record.cbranch = sentinel;
+    if (element.controlling_variable != none) {
+        record.ca = index(element.controlling_element->nodeA);
+        record.cb = index(element.controlling_element->nodeB);
+        record.cbranch = index(element.controlling_element->name);
+    }
+    return record;
+}
+
+std::vector<StampRecord> makeStampRecords(
+    const std::vector<std::shared_ptr<CircuitElement>> &circuitElements,
+    const std::map<std::string, int> &indexMap)
+{
+    // Counting sort by kernel so that each batch is contiguous
+    std::array<int, kernelCount + 1> offset{};
+    for (const std::shared_ptr<CircuitElement> &element : circuitElements)
+        offset[kernelIndex(element->type, element->group,
+                           element->controlling_variable) +
+               1]++;
+    for (int k = 0; k < kernelCount; k++) offset[k + 1] += offset[k];
+
+    std::vector<StampRecord> records(circuitElements.size());
+    for (const std::shared_ptr<CircuitElement> &element : circuitElements) {
+        StampRecord record = makeStampRecord(*element, indexMap);
+        records[offset[record.kernel]++] = record;
+    }
+
+    return records;
+}
+
+// Runs function(t) for t in [0, threads), on threads - 1 new threads and the
+// calling one
+template <class Function>
+static void parallelFor(int threads, Function function)
+{
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; t++) pool.emplace_back(function, t);
+    function(0);
+    for (std::thread &thread : pool) thread.join();
+}
+
+// Part t of [0, count) split into threads contiguous parts
+static size_t partBegin(size_t count, int threads, int t)
+{
+    return count * size_t(t) / size_t(threads);
+}
+
+void assembleSparse(const std::vector<StampRecord> &records, int m,
+                    int threads, Eigen::SparseMatrix<double> &A,
+                    Eigen::VectorXd &rhs)
+{
+    threads = int(std::max<size_t>(
+        1, std::min<size_t>(threads, records.size() / assemblyGrain)));
+
+    // Stamping: one triplet buffer and RHS per thread
+    std::vector<std::vector<Eigen::Triplet<double>>> triplets(threads);
+    std::vector<Eigen::VectorXd> rhsParts(threads);
+    parallelFor(threads, [&](int t) {
+        rhsParts[t] = Eigen::VectorXd::Zero(m + 1);
+        TripletSink sink{triplets[t], rhsParts[t]};
+        const StampRecord *first = records.data();
+        stampRecords(first + partBegin(records.size(), threads, t),
+                     first + partBegin(records.size(), threads, t + 1),
+                     sink);
+    });
+
+    // Entries of every column per thread, the sentinel row and column are
+    // dropped
+    std::vector<std::vector<int>> offsets(threads, std::vector<int>(m, 0));
+    parallelFor(threads, [&](int t) {
+        for (const Eigen::Triplet<double> &entry : triplets[t])
+            if (entry.row() < m && entry.col() < m) offsets[t][entry.col()]++;
+    });
+
+    // Column starts, then the position of every thread inside each column
+    std::vector<int> columnStart(m + 1, 0);
+    for (int col = 0; col < m; col++) {
+        int total = 0;
+        for (int t = 0; t < threads; t++) total += offsets[t][col];
+        columnStart[col + 1] = columnStart[col] + total;
+    }
+    parallelFor(threads, [&](int t) {
+        for (int col = int(partBegin(m, threads, t));
+             col < int(partBegin(m, threads, t + 1)); col++) {
+            int position = columnStart[col];
+            for (int part = 0; part < threads; part++) {
+                int count = offsets[part][col];
+                offsets[part][col] = position;
+                position += count;
+            }
+        }
+    });
+
+    // Scatter into columns, in thread order inside each column
+    std::vector<std::pair<int, double>> entries(columnStart[m]);
+    parallelFor(threads, [&](int t) {
+        for (const Eigen::Triplet<double> &entry : triplets[t])
+            if (entry.row() < m && entry.col() < m)
+                entries[offsets[t][entry.col()]++] = {entry.row(),
+                                                      entry.value()};
+        std::vector<Eigen::Triplet<double>>().swap(triplets[t]);
+        std::vector<int>().swap(offsets[t]);
+    });
+
+    // Sort every column by row and sum the duplicates in place; the stable
+    // sort keeps the summation order independent of scheduling
+    std::vector<int> columnSize(m, 0);
+    parallelFor(threads, [&](int t) {
+        auto byRow = [](const std::pair<int, double> &a,
+                        const std::pair<int, double> &b) {
+            return a.first < b.first;
+        };
+        for (int col = int(partBegin(m, threads, t));
+             col < int(partBegin(m, threads, t + 1)); col++) {
+            std::pair<int, double> *begin = entries.data() + columnStart[col];
+            std::pair<int, double> *end =
+                entries.data() + columnStart[col + 1];
+            std::stable_sort(begin, end, byRow);
+            std::pair<int, double> *last = begin;
+            for (std::pair<int, double> *entry = begin; entry != end;
+                 entry++) {
+                if (entry != begin && entry->first == (last - 1)->first)
+                    (last - 1)->second += entry->second;
+                else
+                    *last++ = *entry;
+            }
+            columnSize[col] = int(last - begin);
+        }
+    });
+
+    // Compressed column storage written in place
+    A.resize(m, m);
+    int *outer = A.outerIndexPtr();
+    outer[0] = 0;
+    for (int col = 0; col < m; col++)
+        outer[col + 1] = outer[col] + columnSize[col];
+    A.resizeNonZeros(outer[m]);
+    parallelFor(threads, [&](int t) {
+        for (int col = int(partBegin(m, threads, t));
+             col < int(partBegin(m, threads, t + 1)); col++)
+            for (int k = 0; k < columnSize[col]; k++) {
+                A.innerIndexPtr()[outer[col] + k] =
+                    entries[columnStart[col] + k].first;
+                A.valuePtr()[outer[col] + k] =
+                    entries[columnStart[col] + k].second;
+            }
+    });
+
+    rhs = Eigen::VectorXd::Zero(m + 1);
+    parallelFor(threads, [&](int t) {
+        size_t begin = partBegin(m + 1, threads, t);
+        size_t size = partBegin(m + 1, threads, t + 1) - begin;
+        for (const Eigen::VectorXd &part : rhsParts)
+            rhs.segment(begin, size) += part.segment(begin, size);
+    });
+}
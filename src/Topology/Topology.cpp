@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
+ * Reserved. Permission to use, copy, modify and distribute this software for
+ * educational, research, and not-for-profit purposes, without fee and without a
+ * signed license agreement, is hereby granted, provided that this paragraph and
+ * the following two paragraphs appear in all copies, modifications, and
+ * distributions.
+ *
+ * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
+ * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
+ * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
+ *
+ * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
+ * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+/**
+ * @file Topology.cpp
+ *
+ * @brief Contains the implementation of the topology pass
+ */
+
+#include "../../include/Topology.hpp"
+
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+
+using std::cout, std::endl;
+
+// Elements that only add to the RHS, or only to their own branch row, do not
+// tie the rows of their two terminals together
+static bool couplesTerminals(const CircuitElement &element)
+{
+    return !(element.type == C || (element.type == I && element.group == G1));
+}
+
+// Elements that fix the voltage across their terminals in DC
+static bool definesVoltage(const CircuitElement &element)
+{
+    return element.type == V || element.type == Vc || element.type == L;
+}
+
+// Elements that provide a DC path between their terminals
+static bool conducts(const CircuitElement &element)
+{
+    return element.type == R || definesVoltage(element);
+}
+
+// Any terminal of the element that is not ground
+static const std::string &terminal(const CircuitElement &element)
+{
+    return element.nodeA.compare("0") != 0 ? element.nodeA : element.nodeB;
+}
+
+static int findRoot(std::vector<int> &parent, int x)
+{
+    while (parent[x] != x) x = parent[x] = parent[parent[x]];
+    return x;
+}
+
+int findIslands(const Graph &graph, std::map<std::string, int> &indexMap,
+                std::vector<Island> &islands)
+{
+    const int n = graph.nodeCount();
+    const size_t elementCount = graph.elements.size();
+
+    // Properties of every element, looked up once instead of per incidence
+    std::vector<uint8_t> couples(elementCount), conducting(elementCount);
+    for (size_t e = 0; e < elementCount; e++) {
+        couples[e] = couplesTerminals(*graph.elements[e]);
+        conducting[e] = conducts(*graph.elements[e]);
+    }
+
+    // Labels the non ground nodes reachable through coupling elements with
+    // the same number, without crossing ground
+    std::vector<int> label(n, -1);
+    std::vector<int> queue;
+    queue.reserve(n);
+    int count = 0;
+    for (int start = 0; start < n; start++) {
+        if (start == graph.ground || label[start] >= 0) continue;
+
+        label[start] = count;
+        queue.assign(1, start);
+        for (size_t head = 0; head < queue.size(); head++) {
+            int node = queue[head];
+            for (int k = graph.offsets[node]; k < graph.offsets[node + 1];
+                 k++) {
+                int target = graph.neighbors[k];
+                if (!couples[graph.elementIds[k]] || target == graph.ground ||
+                    label[target] >= 0)
+                    continue;
+                label[target] = count;
+                queue.push_back(target);
+            }
+        }
+        count++;
+    }
+
+    // A controlled source needs the unknowns of its controlling element in
+    // the same system, both terminals of it, so that a controlling element
+    // is never split
+    std::vector<int> parent(count);
+    std::iota(parent.begin(), parent.end(), 0);
+    for (const std::shared_ptr<CircuitElement> &element : graph.elements) {
+        if (element->controlling_variable == none) continue;
+        const CircuitElement &controller = *element->controlling_element;
+        for (const std::string *node : {&controller.nodeA, &controller.nodeB}) {
+            int id = graph.ids.at(*node);
+            if (id == graph.ground) continue;
+            int own =
+                findRoot(parent, label[graph.ids.at(terminal(*element))]);
+            parent[own] = findRoot(parent, label[id]);
+        }
+    }
+
+    std::vector<int> islandOf(count, -1);
+    islands.clear();
+    for (int node = 0; node < n; node++) {
+        if (node == graph.ground) continue;
+        int root = findRoot(parent, label[node]);
+        if (islandOf[root] < 0) {
+            islandOf[root] = int(islands.size());
+            islands.push_back(Island());
+            islands.back().valid = true;
+        }
+        label[node] = islandOf[root];
+        islands[label[node]].nodes.push_back(graph.names[node]);
+    }
+
+    // Assigns the elements; one that bridges two islands without coupling
+    // them is split into one half per island, with the far terminal replaced
+    // by ground. Only the first half keeps the branch unknown.
+    for (size_t e = 0; e < elementCount; e++) {
+        const std::shared_ptr<CircuitElement> &element = graph.elements[e];
+        int a = graph.nodeA[e] != graph.ground ? label[graph.nodeA[e]] : -1;
+        int b = graph.nodeB[e] != graph.ground ? label[graph.nodeB[e]] : -1;
+        if (a < 0 || b < 0 || a == b) {
+            islands[a >= 0 ? a : b].elements.push_back(element);
+            continue;
+        }
+
+        std::shared_ptr<CircuitElement> half =
+            std::make_shared<CircuitElement>(*element);
+        half->nodeB = "0";
+        islands[a].elements.push_back(half);
+
+        if (indexMap.count(element->name)) continue;
+        half = std::make_shared<CircuitElement>(*element);
+        half->nodeA = "0";
+        islands[b].elements.push_back(half);
+    }
+    for (Island &island : islands)
+        island.circuit = makeCircuitTable(island.elements);
+
+    // Nodes that ground cannot reach through conducting elements are floating
+    std::vector<uint8_t> grounded(n, 0);
+    queue.clear();
+    if (graph.ground >= 0) {
+        grounded[graph.ground] = 1;
+        queue.push_back(graph.ground);
+    }
+    for (size_t head = 0; head < queue.size(); head++) {
+        int node = queue[head];
+        for (int k = graph.offsets[node]; k < graph.offsets[node + 1]; k++) {
+            int target = graph.neighbors[k];
+            if (!conducting[graph.elementIds[k]] || grounded[target]) continue;
+            grounded[target] = 1;
+            queue.push_back(target);
+        }
+    }
+
+    std::vector<std::string> floating(islands.size());
+    for (int node = 0; node < n; node++)
+        if (!grounded[node]) floating[label[node]] += " " + graph.names[node];
+    for (size_t k = 0; k < islands.size(); k++)
+        if (!floating[k].empty()) {
+            cout << "Error: Node(s)" + floating[k] +
+                        " have no DC path to ground (floating)"
+                 << endl;
+            islands[k].valid = false;
+        }
+
+    // A voltage defining element whose terminals are already joined by other
+    // voltage defining elements closes a loop
+    std::vector<int> loopParent(n);
+    std::iota(loopParent.begin(), loopParent.end(), 0);
+    for (size_t e = 0; e < elementCount; e++) {
+        const CircuitElement &element = *graph.elements[e];
+        if (!definesVoltage(element)) continue;
+        int a = findRoot(loopParent, graph.nodeA[e]);
+        int b = findRoot(loopParent, graph.nodeB[e]);
+        if (a == b) {
+            cout << "Error: " + element.name +
+                        " closes a loop of voltage sources and inductors"
+                 << endl;
+            islands[label[graph.ids.at(terminal(element))]].valid = false;
+        } else
+            loopParent[a] = b;
+    }
+
+    int invalid = 0;
+    for (Island &island : islands)
+        if (!island.valid) invalid++;
+
+    return invalid;
+}
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
+ * Reserved. Permission to use, copy, modify and distribute this software for
+ * educational, research, and not-for-profit purposes, without fee and without a
+ * signed license agreement, is hereby granted, provided that this paragraph and
+ * the following two paragraphs appear in all copies, modifications, and
+ * distributions.
+ *
+ * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
+ * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
+ * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
+ *
+ * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
+ * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+/**
+ * @file Transport.cpp
+ *
+ * @brief Contains the implementation of the local transport
+ */
+
+#include "../../include/Transport.hpp"
+
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+
+// Sends all bytes, without a SIGPIPE if the peer is gone
+static bool sendBytes(int socket, const void *data, std::size_t bytes)
+{
+    const char *next = static_cast<const char *>(data);
+    while (bytes > 0) {
+        ssize_t sent = ::send(socket, next, bytes, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0) return false;
+        next += sent;
+        bytes -= std::size_t(sent);
+    }
+    return true;
+}
+
+static bool receiveBytes(int socket, void *data, std::size_t bytes)
+{
+    char *next = static_cast<char *>(data);
+    while (bytes > 0) {
+        ssize_t received = ::recv(socket, next, bytes, 0);
+        if (received < 0 && errno == EINTR) continue;
+        if (received <= 0) return false;
+        next += received;
+        bytes -= std::size_t(received);
+    }
+    return true;
+}
+
+LocalTransport::~LocalTransport()
+{
+    // Workers still running when the coordinator gives up are stopped
+    for (pid_t pid : pids) kill(pid, SIGKILL);
+    finish();
+    if (shared != nullptr) munmap(shared, sharedSize * sizeof(double));
+}
+
+bool LocalTransport::start(int workers, std::size_t windowSize,
+                           const std::function<int(int)> &work)
+{
+    sharedSize = windowSize;
+    if (sharedSize > 0) {
+        void *memory = mmap(nullptr, sharedSize * sizeof(double),
+                            PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS,
+                            -1, 0);
+        if (memory == MAP_FAILED) return false;
+        shared = static_cast<double *>(memory);
+    }
+
+    sockets.assign(workers + 1, -1);
+    for (int rank = 1; rank <= workers; rank++) {
+        int pair[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0) return false;
+        pid_t pid = fork();
+        if (pid < 0) {
+            close(pair[0]);
+            close(pair[1]);
+            return false;
+        }
+        if (pid == 0) {
+            // The worker only keeps its own socket, to the coordinator
+            close(pair[0]);
+            for (int socket : sockets)
+                if (socket >= 0) close(socket);
+            sockets.assign(1, pair[1]);
+            pids.clear();
+            _exit(work(rank));
+        }
+        close(pair[1]);
+        sockets[rank] = pair[0];
+        pids.push_back(pid);
+    }
+    return true;
+}
+
+bool LocalTransport::send(int rank, const std::vector<double> &message)
+{
+    std::uint64_t count = message.size();
+    return rank < int(sockets.size()) && sockets[rank] >= 0 &&
+           sendBytes(sockets[rank], &count, sizeof(count)) &&
+           sendBytes(sockets[rank], message.data(),
+                     message.size() * sizeof(double));
+}
+
+bool LocalTransport::receive(int rank, std::vector<double> &message)
+{
+    std::uint64_t count = 0;
+    if (rank >= int(sockets.size()) || sockets[rank] < 0 ||
+        !receiveBytes(sockets[rank], &count, sizeof(count)))
+        return false;
+    message.resize(count);
+    return receiveBytes(sockets[rank], message.data(),
+                        message.size() * sizeof(double));
+}
+
+bool LocalTransport::finish()
+{
+    for (int &socket : sockets) {
+        if (socket >= 0) close(socket);
+        socket = -1;
+    }
+    bool succeeded = true;
+    for (pid_t pid : pids) {
+        int status = 0;
+        while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+        }
+        succeeded = succeeded && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+    pids.clear();
+    return succeeded;
+}
@@ -0,0 +1,334 @@
+/*
+ * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
+ * Reserved. Permission to use, copy, modify and distribute this software for
+ * educational, research, and not-for-profit purposes, without fee and without a
+ * signed license agreement, is hereby granted, provided that this paragraph and
+ * the following two paragraphs appear in all copies, modifications, and
+ * distributions.
+ *
+ * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
+ * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
+ * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
+ *
+ * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
+ * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ */
+/**
+ * @file Waveform.cpp
+ *
+ * @brief Contains the implementation of the waveform file writer and reader
+ */
+
+#include "../../include/Waveform.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+using std::cout, std::endl;
+
+static const char headerMagic[8] = {'S', 'N', 'U', 'W', 'A', 'V', 'E', '1'};
+static const char trailerMagic[8] = {'S', 'N', 'U', 'W', 'I', 'D', 'X', '1'};
+
+// Size of the trailer: index offset, number of points and magic
+constexpr int trailerBytes = 24;
+
+// Column modes, stored as the first byte of every column
+enum ColumnMode : char
+{
+    lossless = 0,
+    quantized = 1
+};
+
+// Quantized values must stay exactly representable in a double
+constexpr double largestLevel = 4503599627370496.0;  // 2^52
+
+template <class T>
+static void writeRaw(std::ostream &stream, const T &value)
+{
+    stream.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <class T>
+static bool readRaw(std::istream &stream, T &value)
+{
+    return bool(stream.read(reinterpret_cast<char *>(&value), sizeof(T)));
+}
+
+static void writeString(std::ostream &stream, const std::string &text)
+{
+    writeRaw(stream, std::uint32_t(text.size()));
+    stream.write(text.data(), std::streamsize(text.size()));
+}
+
+static bool readString(std::istream &stream, std::string &text)
+{
+    std::uint32_t size = 0;
+    if (!readRaw(stream, size)) return false;
+    text.resize(size);
+    return bool(stream.read(&text[0], size));
+}
+
+// Zigzag varint of a difference, small magnitudes take few bytes
+static void putDelta(std::string &out, std::int64_t delta)
+{
+    std::uint64_t bits = (std::uint64_t(delta) << 1) ^
+                         std::uint64_t(delta < 0 ? -1 : 0);
+    while (bits >= 0x80) {
+        out.push_back(char(bits | 0x80));
+        bits >>= 7;
+    }
+    out.push_back(char(bits));
+}
+
+static bool getDelta(const char *&data, const char *end, std::int64_t &delta)
+{
+    std::uint64_t bits = 0;
+    for (int shift = 0; data != end && shift < 64; shift += 7) {
+        std::uint64_t byte = std::uint8_t(*data++);
+        bits |= (byte & 0x7f) << shift;
+        if (byte < 0x80) {
+            delta = std::int64_t(bits >> 1) ^ -std::int64_t(bits & 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Linear extrapolation of the two previous values (wrapping arithmetic),
+// smooth sweeps leave differences of a few units
+static std::uint64_t predict(const std::uint64_t history[2], int k)
+{
+    if (k == 0) return 0;
+    if (k == 1) return history[0];
+    return 2 * history[0] - history[1];
+}
+
+static std::string encodeColumn(const double *values, int points,
+                                double tolerance)
+{
+    double step = 2.0 * tolerance;
+    bool quantize = tolerance > 0.0;
+    for (int k = 0; quantize && k < points; k++)
+        quantize = std::abs(values[k] / step) < largestLevel;
+
+    std::string out(1, quantize ? quantized : lossless);
+    std::uint64_t history[2] = {0, 0};
+    for (int k = 0; k < points; k++) {
+        std::int64_t current;
+        if (quantize)
+            current = std::llround(values[k] / step);
+        else
+            std::memcpy(&current, &values[k], sizeof(double));
+        putDelta(out, std::int64_t(std::uint64_t(current) -
+                                   predict(history, k)));
+        history[1] = history[0];
+        history[0] = std::uint64_t(current);
+    }
+    return out;
+}
+
+static bool decodeColumn(const std::string &data, int points,
+                         double tolerance, std::vector<double> &values)
+{
+    if (data.empty()) return false;
+    const char *next = data.data() + 1, *end = data.data() + data.size();
+    bool quantize = data[0] == quantized;
+
+    values.resize(points);
+    std::uint64_t history[2] = {0, 0};
+    std::int64_t current, delta;
+    for (int k = 0; k < points; k++) {
+        if (!getDelta(next, end, delta)) return false;
+        current = std::int64_t(predict(history, k) + std::uint64_t(delta));
+        history[1] = history[0];
+        history[0] = std::uint64_t(current);
+        if (quantize)
+            values[k] = double(current) * 2.0 * tolerance;
+        else
+            std::memcpy(&values[k], &current, sizeof(double));
+    }
+    return true;
+}
+
+int WaveformWriter::open(const std::string &file, const std::string &axis,
+                         const std::vector<std::string> &names,
+                         double tolerance, int chunkPoints)
+{
+    stream.open(file, std::ios::binary | std::ios::trunc);
+    if (!stream) {
+        cout << "Error: Cannot write the waveform file " + file << endl;
+        return 1;
+    }
+
+    signals = int(names.size());
+    this->chunkPoints = std::max(chunkPoints, 1);
+    this->tolerance = std::max(tolerance, 0.0);
+    buffer.resize(this->chunkPoints, signals + 1);
+    buffered = 0;
+    total = 0;
+    index.clear();
+
+    stream.write(headerMagic, sizeof(headerMagic));
+    writeRaw(stream, std::uint32_t(this->chunkPoints));
+    writeRaw(stream, this->tolerance);
+    writeString(stream, axis);
+    writeRaw(stream, std::uint32_t(signals));
+    for (const std::string &name : names) writeString(stream, name);
+    return 0;
+}
+
+void WaveformWriter::append(double axisValue, const Eigen::VectorXd &values)
+{
+    buffer(buffered, 0) = axisValue;
+    buffer.row(buffered).tail(signals) = values.transpose();
+    total++;
+    if (++buffered == chunkPoints) flush();
+}
+
+void WaveformWriter::flush()
+{
+    if (buffered == 0) return;
+
+    WaveformChunk chunk;
+    chunk.firstPoint = total - buffered;
+    chunk.points = std::uint32_t(buffered);
+    chunk.axisMin = buffer.col(0).head(buffered).minCoeff();
+    chunk.axisMax = buffer.col(0).head(buffered).maxCoeff();
+
+    // The axis is kept lossless, windows are looked up on it
+    for (int column = 0; column <= signals; column++) {
+        std::string encoded = encodeColumn(buffer.col(column).data(),
+                                           buffered,
+                                           column == 0 ? 0.0 : tolerance);
+        chunk.offset.push_back(std::uint64_t(stream.tellp()));
+        chunk.bytes.push_back(std::uint32_t(encoded.size()));
+        stream.write(encoded.data(), std::streamsize(encoded.size()));
+    }
+    index.push_back(chunk);
+    buffered = 0;
+}
+
+int WaveformWriter::close()
+{
+    flush();
+
+    std::uint64_t indexOffset = std::uint64_t(stream.tellp());
+    writeRaw(stream, std::uint64_t(index.size()));
+    for (const WaveformChunk &chunk : index) {
+        writeRaw(stream, chunk.firstPoint);
+        writeRaw(stream, chunk.points);
+        writeRaw(stream, chunk.axisMin);
+        writeRaw(stream, chunk.axisMax);
+        for (int column = 0; column <= signals; column++) {
+            writeRaw(stream, chunk.offset[column]);
+            writeRaw(stream, chunk.bytes[column]);
+        }
+    }
+    writeRaw(stream, indexOffset);
+    writeRaw(stream, total);
+    stream.write(trailerMagic, sizeof(trailerMagic));
+
+    written = std::uint64_t(stream.tellp());
+    stream.close();
+    if (!stream) {
+        cout << "Error: Cannot finish the waveform file" << endl;
+        return 1;
+    }
+    return 0;
+}
+
+int WaveformReader::open(const std::string &file)
+{
+    stream.open(file, std::ios::binary);
+    if (!stream) {
+        cout << "Error: Cannot read the waveform file " + file << endl;
+        return 1;
+    }
+
+    char magic[8];
+    std::uint32_t chunkPoints = 0, signals = 0;
+    bool valid = stream.read(magic, sizeof(magic)) &&
+                 std::equal(magic, magic + 8, headerMagic) &&
+                 readRaw(stream, chunkPoints) && readRaw(stream, tolerance) &&
+                 readString(stream, axis) && readRaw(stream, signals);
+    names.resize(valid ? signals : 0);
+    for (std::string &name : names) valid = valid && readString(stream, name);
+
+    std::uint64_t indexOffset = 0, chunks = 0;
+    valid = valid && stream.seekg(-trailerBytes, std::ios::end) &&
+            readRaw(stream, indexOffset) && readRaw(stream, points) &&
+            stream.read(magic, sizeof(magic)) &&
+            std::equal(magic, magic + 8, trailerMagic) &&
+            stream.seekg(std::streamoff(indexOffset)) &&
+            readRaw(stream, chunks);
+
+    index.assign(valid ? chunks : 0, WaveformChunk());
+    for (WaveformChunk &chunk : index) {
+        valid = valid && readRaw(stream, chunk.firstPoint) &&
+                readRaw(stream, chunk.points) &&
+                readRaw(stream, chunk.axisMin) &&
+                readRaw(stream, chunk.axisMax);
+        chunk.offset.resize(signals + 1);
+        chunk.bytes.resize(signals + 1);
+        for (std::uint32_t column = 0; column <= signals; column++)
+            valid = valid && readRaw(stream, chunk.offset[column]) &&
+                    readRaw(stream, chunk.bytes[column]);
+    }
+
+    if (!valid) {
+        cout << "Error: " + file + " is not a valid waveform file" << endl;
+        return 1;
+    }
+    return 0;
+}
+
+int WaveformReader::read(const std::string &name, double from, double to,
+                         std::vector<double> &axisValues,
+                         std::vector<double> &values)
+{
+    std::vector<std::string>::iterator found =
+        std::find(names.begin(), names.end(), name);
+    if (found == names.end()) {
+        cout << "Error: Signal " + name + " is not in the waveform file"
+             << endl;
+        return 1;
+    }
+    int column = int(found - names.begin()) + 1;
+    double low = std::min(from, to), high = std::max(from, to);
+
+    axisValues.clear();
+    values.clear();
+    std::string data;
+    std::vector<double> chunkAxis, chunkValues;
+    for (const WaveformChunk &chunk : index) {
+        if (chunk.axisMax < low || chunk.axisMin > high) continue;
+
+        bool valid = true;
+        const int columns[2] = {0, column};
+        std::vector<double> *decoded[2] = {&chunkAxis, &chunkValues};
+        for (int k = 0; k < 2 && valid; k++) {
+            data.resize(chunk.bytes[columns[k]]);
+            valid = stream.seekg(std::streamoff(chunk.offset[columns[k]])) &&
+                    stream.read(&data[0], std::streamsize(data.size())) &&
+                    decodeColumn(data, int(chunk.points),
+                                 k == 0 ? 0.0 : tolerance, *decoded[k]);
+        }
+        if (!valid) {
+            cout << "Error: Corrupted chunk in the waveform file" << endl;
+            stream.clear();
+            return 1;
+        }
+
+        for (std::uint32_t k = 0; k < chunk.points; k++) {
+            if (chunkAxis[k] < low || chunkAxis[k] > high) continue;
+            axisValues.push_back(chunkAxis[k]);
+            values.push_back(chunkValues[k]);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,1270 @@
+/*
+ * Copyright (c) 2022, Shiv Nadar University, Delhi NCR, India. All Rights
+ * Reserved. Permission to use, copy, modify and distribute this software for
+ * educational, research, and not-for-profit purposes, without fee and without a
+ * signed license agreement, is hereby granted, provided that this paragraph and
+ * the following two paragraphs appear in all copies, modifications, and
+ * distributions.
+ *
+ * IN NO EVENT SHALL SHIV NADAR UNIVERSITY BE LIABLE TO ANY PARTY FOR DIRECT,
+ * INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST
+ * PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE.
+ *
+ * SHIV NADAR UNIVERSITY SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS PROVIDED "AS IS". SHIV
+ * NADAR UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+/**
+ * @file test.cpp
+ *
+ * @brief Contains the golden result and performance budget tests
+ *
+ * Every netlist of tests/netlists is solved and compared with its reference
+ * solution in tests/references. The parse, assemble and solve phases of
+ * each case have a wall time and an allocation budget, exceeding one fails
+ * the test like a wrong value does.
+ *
+ * The references are rewritten from the current solver by running the tests
+ * with SNU_SPICE_UPDATE_GOLDEN=1 set.
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../include/CodeGen.hpp"
+#include "../include/LinearSolver.hpp"
+#include "../include/MatrixMarket.hpp"
+#include "../include/ModelReduction.hpp"
+#include "../include/Parser.hpp"
+#include "../include/ResultCache.hpp"
+#include "../include/Probe.hpp"
+#include "../include/Solver.hpp"
+#include "../include/SourceTable.hpp"
+#include "../include/SpscQueue.hpp"
+#include "../include/Stamp.hpp"
+#include "../include/Topology.hpp"
+
+// Counts the operator new calls of the whole test binary. Eigen allocates
+// its buffers with malloc, so only the C++ allocations are counted.
+static std::atomic<long> allocations{0};
+
+void *operator new(std::size_t size)
+{
+    allocations++;
+    if (void *pointer = std::malloc(size != 0 ? size : 1)) return pointer;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept { std::free(pointer); }
+
+void operator delete(void *pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+/** Phases of a case, in the order they run */
+enum Phase
+{
+    parsePhase,
+    assemblePhase,
+    solvePhase,
+    phaseCount
+};
+
+static const char *phaseNames[phaseCount] = {"parse", "assemble", "solve"};
+
+/** @struct GoldenCase
+ *
+ * @brief A netlist of the corpus with the budgets of its phases
+ * */
+struct GoldenCase
+{
+    const char *netlist; /**< Name of the netlist and its reference */
+    bool sparse;         /**< Solves with sparse LU instead of dense LU */
+    double milliseconds[phaseCount]; /**< Wall time budget of each phase */
+    long allocations[phaseCount];    /**< Allocation budget of each phase */
+};
+
+// Names the case in the test output instead of dumping its bytes
+void PrintTo(const GoldenCase &goldenCase, std::ostream *stream)
+{
+    *stream << goldenCase.netlist << (goldenCase.sparse ? " (sparse)" : "");
+}
+
+/** @struct PhaseCost
+ *
+ * @brief Measured cost of a phase
+ * */
+struct PhaseCost
+{
+    double milliseconds = 0.0; /**< Wall time */
+    long allocations = 0;      /**< Number of operator new calls */
+};
+
+template <class Function>
+static PhaseCost measure(Function function)
+{
+    long allocated = allocations;
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    function();
+    PhaseCost cost;
+    cost.milliseconds = std::chrono::duration<double, std::milli>(
+                            std::chrono::steady_clock::now() - start)
+                            .count();
+    cost.allocations = allocations - allocated;
+    return cost;
+}
+
+static std::string testFile(const std::string &directory,
+                            const std::string &name,
+                            const std::string &extension)
+{
+    return std::string(SNU_SPICE_TEST_DIR) + "/" + directory + "/" + name +
+           extension;
+}
+
+/**
+ * Solves a netlist the way runSolver does without reduction or probes, and
+ * measures each phase. The assemble phase stamps every island's system once
+ * on its own, the solve phase is solveIslands, which stamps and factorizes.
+ */
+static int solveCase(const GoldenCase &goldenCase,
+                     std::map<std::string, int> &indexMap,
+                     Eigen::MatrixXd &X, PhaseCost (&costs)[phaseCount])
+{
+    int errors = 0;
+    Parser parser;
+    costs[parsePhase] = measure([&] {
+        errors += parser.parse(testFile("netlists", goldenCase.netlist,
+                                        ".sns"));
+    });
+    if (errors != 0) return errors;
+
+    SolverOptions options;
+    options.sparse = goldenCase.sparse;
+    options.threads = 1;
+    std::vector<Island> islands;
+    costs[assemblePhase] = measure([&] {
+        makeIndexMap(indexMap, parser);
+        errors +=
+            findIslands(makeGraph(parser.circuitElements), indexMap, islands);
+
+        for (Island &island : islands) {
+            std::map<std::string, int> localIndexMap;
+            for (std::string &node : island.nodes) localIndexMap[node] = 0;
+            for (const std::string &name : island.circuit.names)
+                if (indexMap.count(name)) localIndexMap[name] = 0;
+            int m = 0;
+            for (auto &entry : localIndexMap) entry.second = m++;
+
+            std::vector<StampRecord> records =
+                makeStampRecords(island.circuit, localIndexMap);
+            Eigen::VectorXd rhs = Eigen::VectorXd::Zero(m + 1);
+            if (options.sparse) {
+                Eigen::SparseMatrix<double> A;
+                assembleSparse(records, m, 1, A, rhs);
+            } else {
+                Eigen::MatrixXd mna = Eigen::MatrixXd::Zero(m + 1, m + 1);
+                DenseSink sink{mna, rhs};
+                stampRecords(records, sink);
+            }
+        }
+    });
+    if (errors != 0) return errors;
+
+    costs[solvePhase] = measure([&] {
+        X = Eigen::MatrixXd::Zero(int(indexMap.size()), 1);
+        solveIslands(islands, indexMap, options, X);
+        appendProbeCurrents(makeCurrentProbes(parser.currentProbes, indexMap,
+                                              int(X.rows())),
+                            indexMap, X);
+    });
+    return errors;
+}
+
+static void writeReference(const std::string &file,
+                           const std::map<std::string, int> &indexMap,
+                           const Eigen::MatrixXd &X)
+{
+    std::ofstream stream(file);
+    stream << std::setprecision(17);
+    for (const std::pair<const std::string, int> &entry : indexMap)
+        stream << entry.first << " " << X(entry.second, 0) << "\n";
+}
+
+static std::map<std::string, double> readReference(const std::string &file)
+{
+    std::map<std::string, double> reference;
+    std::ifstream stream(file);
+    std::string name;
+    double value;
+    while (stream >> name >> value) reference[name] = value;
+    return reference;
+}
+
+class GoldenTest : public ::testing::TestWithParam<GoldenCase>
+{
+};
+
+TEST_P(GoldenTest, MatchesReferenceWithinBudgets)
+{
+    const GoldenCase &goldenCase = GetParam();
+    std::map<std::string, int> indexMap;
+    Eigen::MatrixXd X;
+    PhaseCost costs[phaseCount];
+    ASSERT_EQ(solveCase(goldenCase, indexMap, X, costs), 0);
+
+    std::string file = testFile("references", goldenCase.netlist, ".ref");
+    if (std::getenv("SNU_SPICE_UPDATE_GOLDEN") != nullptr)
+        writeReference(file, indexMap, X);
+
+    std::map<std::string, double> reference = readReference(file);
+    ASSERT_FALSE(reference.empty()) << "No reference solution in " << file;
+    EXPECT_EQ(reference.size(), indexMap.size());
+    for (const std::pair<const std::string, double> &entry : reference) {
+        std::map<std::string, int>::const_iterator iter =
+            indexMap.find(entry.first);
+        ASSERT_NE(iter, indexMap.end()) << entry.first << " is not solved";
+        EXPECT_NEAR(X(iter->second, 0), entry.second,
+                    1e-9 * std::max(1.0, std::abs(entry.second)))
+            << entry.first;
+    }
+
+    for (int phase = 0; phase < phaseCount; phase++) {
+        EXPECT_LE(costs[phase].milliseconds,
+                  goldenCase.milliseconds[phase])
+            << phaseNames[phase] << " phase is over its time budget";
+        EXPECT_LE(costs[phase].allocations, goldenCase.allocations[phase])
+            << phaseNames[phase] << " phase is over its allocation budget";
+        RecordProperty(std::string(phaseNames[phase]) + "_ms",
+                       std::to_string(costs[phase].milliseconds));
+        RecordProperty(std::string(phaseNames[phase]) + "_allocations",
+                       std::to_string(costs[phase].allocations));
+    }
+}
+
+// Budgets: {parse, assemble, solve} in milliseconds, then in allocations.
+// Times leave room for unoptimized builds and loaded machines, allocations
+// are about twice the measured counts.
+INSTANTIATE_TEST_SUITE_P(
+    Corpus, GoldenTest,
+    ::testing::Values(
+        GoldenCase{"passive", false, {25, 25, 25}, {250, 500, 150}},
+        GoldenCase{"passive", true, {25, 25, 25}, {250, 500, 150}},
+        GoldenCase{"sources", false, {25, 25, 25}, {200, 350, 100}},
+        GoldenCase{"sources", true, {25, 25, 25}, {200, 350, 100}},
+        GoldenCase{"controlled", false, {25, 25, 25}, {350, 600, 150}},
+        GoldenCase{"controlled", true, {25, 25, 25}, {350, 600, 150}},
+        GoldenCase{"islands", false, {25, 25, 25}, {200, 550, 200}},
+        GoldenCase{"islands", true, {25, 25, 25}, {200, 550, 200}},
+        GoldenCase{"mixed", false, {25, 25, 25}, {500, 1100, 300}},
+        GoldenCase{"mixed", true, {25, 25, 25}, {500, 1100, 300}},
+        GoldenCase{"parameters", false, {25, 25, 25}, {500, 350, 100}},
+        GoldenCase{"parameters", true, {25, 25, 25}, {500, 350, 100}},
+        GoldenCase{"ladder", true, {150, 250, 250}, {26000, 37000, 4100}}),
+    [](const ::testing::TestParamInfo<GoldenCase> &info) {
+        return std::string(info.param.netlist) +
+               (info.param.sparse ? "_sparse" : "_dense");
+    });
+
+// Solves a parsed netlist with dense LU
+static void solveParsed(Parser &parser, std::map<std::string, int> &indexMap,
+                        Eigen::MatrixXd &X,
+                        SolverOptions options = SolverOptions(),
+                        std::vector<SolveReport> *reports = nullptr)
+{
+    std::vector<Island> islands;
+    makeIndexMap(indexMap, parser);
+    ASSERT_EQ(findIslands(makeGraph(parser.circuitElements), indexMap, islands),
+              0);
+    options.threads = 1;
+    X = Eigen::MatrixXd::Zero(int(indexMap.size()), 1);
+    std::vector<SolveReport> solved =
+        solveIslands(islands, indexMap, options, X);
+    if (reports != nullptr) *reports = solved;
+    appendProbeCurrents(
+        makeCurrentProbes(parser.currentProbes, indexMap, int(X.rows())),
+        indexMap, X);
+}
+
+TEST(Reduction, MatchesTheUnreducedSolve)
+{
+    for (const std::string name :
+         {"reducible", "controlled", "scaled", "coupled"}) {
+        std::string netlist = testFile("netlists", name, ".sns");
+        Parser full, reduced;
+        ASSERT_EQ(full.parse(netlist), 0);
+        ASSERT_EQ(reduced.parse(netlist), 0);
+
+        std::map<std::string, int> fullMap, reducedMap;
+        Eigen::MatrixXd fullX, reducedX;
+        solveParsed(full, fullMap, fullX);
+
+        // Removed nodes are recovered before the currents are computed, as
+        // the solver does
+        Reduction reduction = reduceCircuit(reduced);
+        EXPECT_GT(reduction.series + reduction.parallel + reduction.sources +
+                      reduction.dangling,
+                  0)
+            << name;
+        std::vector<Island> islands;
+        makeIndexMap(reducedMap, reduced);
+        ASSERT_EQ(findIslands(makeGraph(reduced.circuitElements), reducedMap,
+                              islands),
+                  0);
+        SolverOptions options;
+        options.threads = 1;
+        reducedX = Eigen::MatrixXd::Zero(int(reducedMap.size()), 1);
+        solveIslands(islands, reducedMap, options, reducedX);
+        recoverEliminated(reduction, reducedMap, reducedX);
+        appendProbeCurrents(makeCurrentProbes(reduced.currentProbes,
+                                              reducedMap,
+                                              int(reducedX.rows())),
+                            reducedMap, reducedX);
+
+        // Every node is solved or recovered, merged elements have no
+        // current of their own
+        for (const std::pair<const std::string, int> &entry : fullMap) {
+            std::map<std::string, int>::const_iterator iter =
+                reducedMap.find(entry.first);
+            if (iter == reducedMap.end()) {
+                EXPECT_FALSE(full.nodes_group2.count(entry.first))
+                    << name << " " << entry.first << " is not recovered";
+                continue;
+            }
+            EXPECT_NEAR(reducedX(iter->second, 0), fullX(entry.second, 0),
+                        1e-9 * std::max(1.0, std::abs(fullX(entry.second, 0))))
+                << name << " " << entry.first;
+        }
+    }
+}
+
+TEST(ModelReduction, MatchesTheFullCircuitAtThePorts)
+{
+    std::string netlist = testFile("netlists", "passive", ".sns");
+    Parser full, reduced;
+    ASSERT_EQ(full.parse(netlist), 0);
+    ASSERT_EQ(reduced.parse(netlist), 0);
+
+    std::vector<ReducedModel> models;
+    ASSERT_EQ(reduceNetworks(reduced, 2, models), 0);
+    // Nodes 4 and 6 with the current of L1, node 7 with the one of L2
+    ASSERT_EQ(models.size(), 2u);
+    EXPECT_EQ(models[0].internal, 3);
+    EXPECT_EQ(models[1].internal, 2);
+
+    std::map<std::string, int> fullMap, reducedMap;
+    Eigen::MatrixXd fullX, reducedX;
+    solveParsed(full, fullMap, fullX);
+    solveParsed(reduced, reducedMap, reducedX);
+    EXPECT_FALSE(reducedMap.count("4"));
+    for (const std::pair<const std::string, int> &entry : reducedMap)
+        if (fullMap.count(entry.first)) {
+            EXPECT_NEAR(reducedX(entry.second, 0),
+                        fullX(fullMap.at(entry.first), 0), 1e-9)
+                << entry.first;
+        }
+
+    // The saved model is read back as it was written
+    std::string file = ::testing::TempDir() + "passive.rom";
+    ASSERT_EQ(saveReducedModels(file, models), 0);
+    std::vector<ReducedModel> loaded;
+    ASSERT_EQ(loadReducedModels(file, loaded), 0);
+    ASSERT_EQ(loaded.size(), models.size());
+    for (size_t k = 0; k < models.size(); k++) {
+        EXPECT_EQ(loaded[k].ports, models[k].ports);
+        EXPECT_EQ(loaded[k].G, models[k].G);
+        EXPECT_EQ(loaded[k].C, models[k].C);
+    }
+}
+
+TEST(Sensitivity, MatchesCentralDifferences)
+{
+    std::string netlist = testFile("netlists", "controlled", ".sns");
+    Parser parser;
+    ASSERT_EQ(parser.parse(netlist), 0);
+
+    // Every unknown and every computed current is an output
+    std::map<std::string, int> indexMap;
+    makeIndexMap(indexMap, parser);
+    std::vector<std::string> outputs;
+    for (const std::pair<const std::string, int> &entry : indexMap)
+        outputs.push_back(entry.first);
+    for (const std::shared_ptr<CircuitElement> &probe : parser.currentProbes)
+        outputs.push_back(probe->name);
+
+    std::vector<Island> islands;
+    ASSERT_EQ(findIslands(makeGraph(parser.circuitElements), indexMap, islands),
+              0);
+    Eigen::MatrixXd seeds;
+    ASSERT_EQ(makeSensitivitySeeds(outputs, indexMap, parser.currentProbes,
+                                   seeds),
+              0);
+    const int m = int(indexMap.size());
+    Eigen::MatrixXd X = Eigen::MatrixXd::Zero(m, 1);
+    Eigen::MatrixXd adjoints = Eigen::MatrixXd::Zero(m, seeds.cols());
+    SolverOptions options;
+    options.threads = 1;
+    solveIslands(islands, indexMap, options, X, &seeds, &adjoints);
+    std::map<std::string, int> solvedMap = indexMap;
+    appendProbeCurrents(makeCurrentProbes(parser.currentProbes, indexMap, m),
+                        indexMap, X);
+
+    std::vector<std::shared_ptr<CircuitElement>> elements;
+    for (Island &island : islands)
+        elements.insert(elements.end(), island.elements.begin(),
+                        island.elements.end());
+
+    // Outputs solved again with the value of one element moved by a step
+    auto solveWith = [&](const std::string &name, double scale,
+                         std::map<std::string, int> &changedMap,
+                         Eigen::MatrixXd &changedX) {
+        Parser changed;
+        ASSERT_EQ(changed.parse(netlist), 0);
+        for (std::shared_ptr<CircuitElement> &element :
+             changed.circuitElements)
+            if (element->name == name) element->value *= scale;
+        solveParsed(changed, changedMap, changedX);
+    };
+
+    const double step = 1e-6;
+    int checked = 0;
+    for (size_t k = 0; k < outputs.size(); k++) {
+        double value = X(indexMap.at(outputs[k]), 0);
+        std::vector<Sensitivity> sensitivities = computeSensitivities(
+            elements, solvedMap, X.col(0), adjoints.col(int(k)), outputs[k],
+            value, parser.currentProbes);
+        for (const Sensitivity &sensitivity : sensitivities) {
+            double elementValue = 0;
+            for (const std::shared_ptr<CircuitElement> &element :
+                 parser.circuitElements)
+                if (element->name == sensitivity.element)
+                    elementValue = element->value;
+            std::map<std::string, int> upMap, downMap;
+            Eigen::MatrixXd upX, downX;
+            solveWith(sensitivity.element, 1 + step, upMap, upX);
+            solveWith(sensitivity.element, 1 - step, downMap, downX);
+            double difference = (upX(upMap.at(outputs[k]), 0) -
+                                 downX(downMap.at(outputs[k]), 0)) /
+                                (2 * step * elementValue);
+            // Rounding of the differences scales with output / value
+            EXPECT_NEAR(sensitivity.derivative, difference,
+                        1e-6 * (std::abs(sensitivity.derivative) +
+                                std::max(1.0, std::abs(value)) /
+                                    std::abs(elementValue)))
+                << outputs[k] << " to " << sensitivity.element;
+            checked++;
+        }
+    }
+    EXPECT_GT(checked, 0);
+}
+
+TEST(Relaxation, MatchesTheDirectSolution)
+{
+    std::string netlist = testFile("netlists", "coupled", ".sns");
+    Parser direct, relaxed;
+    ASSERT_EQ(direct.parse(netlist), 0);
+    ASSERT_EQ(relaxed.parse(netlist), 0);
+
+    std::map<std::string, int> directMap, relaxedMap;
+    Eigen::MatrixXd directX, relaxedX;
+    std::vector<SolveReport> reports;
+    SolverOptions options;
+    options.relaxCut = 1e6;
+    solveParsed(direct, directMap, directX);
+    solveParsed(relaxed, relaxedMap, relaxedX, options, &reports);
+
+    // RC1 and RC2 are cut, and VC1 is cut from its controlling node
+    ASSERT_EQ(reports.size(), 1u);
+    const RelaxationReport &relaxation = reports[0].relaxation;
+    EXPECT_EQ(relaxation.partitions.size(), 4u);
+    EXPECT_TRUE(relaxation.converged);
+    EXPECT_GT(relaxation.iterations, 2);
+    EXPECT_EQ(relaxedMap, directMap);
+    for (const std::pair<const std::string, int> &entry : directMap)
+        EXPECT_NEAR(relaxedX(entry.second, 0), directX(entry.second, 0),
+                    1e-9 * std::max(1.0, std::abs(directX(entry.second, 0))))
+            << entry.first;
+}
+
+TEST(NumericalHealth, FlagsAndEquilibratesAnIllConditionedSystem)
+{
+    for (bool sparse : {false, true}) {
+        SolverOptions options;
+        options.sparse = sparse;
+        for (bool equilibrate : {false, true}) {
+            options.equilibrate = equilibrate;
+            Parser parser;
+            ASSERT_EQ(parser.parse(testFile("netlists", "scaled", ".sns")), 0);
+            std::map<std::string, int> indexMap;
+            Eigen::MatrixXd X;
+            std::vector<SolveReport> reports;
+            solveParsed(parser, indexMap, X, options, &reports);
+
+            ASSERT_EQ(reports.size(), 1u);
+            const SolveReport &report = reports[0];
+            ASSERT_TRUE(report.diagnosed);
+            EXPECT_EQ(report.equilibrated, equilibrate);
+            if (equilibrate) {
+                EXPECT_GT(report.rcond, 1e-3);
+            } else {
+                EXPECT_LT(report.rcond, illConditioned);
+                // Node 4 only sees the two 10 TOhm resistors
+                EXPECT_EQ(report.pivotName, "4");
+            }
+            EXPECT_GE(report.growth, 1.0);
+            EXPECT_LT(report.residual, 1e-15);
+            EXPECT_NEAR(X(indexMap.at("4"), 0), 0.5, 1e-12);
+        }
+    }
+}
+
+TEST(MixedPrecision, RefinesToDoubleAccuracyOrFallsBack)
+{
+    // Diagonally dominant, so float factors refine to double accuracy
+    const int n = 200;
+    Eigen::MatrixXd A = 4.0 * Eigen::MatrixXd::Identity(n, n);
+    A.diagonal(1).setConstant(-1.0);
+    A.diagonal(-1).setConstant(-1.5);
+    Eigen::VectorXd b = Eigen::VectorXd::LinSpaced(n, -1.0, 3.0);
+    Eigen::VectorXd exact = Eigen::PartialPivLU<Eigen::MatrixXd>(A).solve(b);
+
+    // Hilbert matrix, condition ~1e13: beyond what float factors can refine
+    const int h = 10;
+    Eigen::MatrixXd H(h, h);
+    for (int i = 0; i < h; i++)
+        for (int j = 0; j < h; j++) H(i, j) = 1.0 / (i + j + 1);
+    Eigen::VectorXd c = Eigen::VectorXd::Ones(h);
+
+    for (bool sparse : {false, true}) {
+        SCOPED_TRACE(sparse ? "sparse" : "dense");
+        const double eps = std::numeric_limits<double>::epsilon();
+
+        SolveReport report;
+        Eigen::VectorXd x = sparse ? solveSparseMixed(A.sparseView(), b,
+                                                      report)
+                                   : solveDenseMixed(A, b, report);
+        EXPECT_FALSE(report.fellBack);
+        EXPECT_GT(report.refinements, 0);
+        EXPECT_LE(report.residual, std::sqrt(double(n)) * eps);
+        EXPECT_LT((x - exact).lpNorm<Eigen::Infinity>(),
+                  1e-13 * exact.lpNorm<Eigen::Infinity>());
+
+        report = SolveReport();
+        x = sparse ? solveSparseMixed(H.sparseView(), c, report)
+                   : solveDenseMixed(H, c, report);
+        EXPECT_TRUE(report.fellBack);
+        EXPECT_LT(scaledResidual(H, x, c), 1e-15);
+    }
+}
+
+TEST(NumericalHealth, ReadsTheUpperFactorOfTheSparseLU)
+{
+    // Small pivots on the diagonal, so rows and columns are both reordered
+    const int n = 8;
+    Eigen::MatrixXd dense = Eigen::MatrixXd::Zero(n, n);
+    for (int k = 0; k < n; k++) {
+        dense(k, k) = 1e-3 * (k + 1);
+        dense((k + 3) % n, k) = 2.0 + k;
+        dense(k, (k + 5) % n) -= 0.5 * k;
+    }
+    Eigen::SparseMatrix<double> A = dense.sparseView();
+    Eigen::SparseLU<Eigen::SparseMatrix<double>> lu;
+    lu.compute(A);
+    ASSERT_EQ(lu.info(), Eigen::Success);
+
+    // U = L^-1 P_r A P_c^-1 through the documented solves
+    Eigen::MatrixXd U =
+        lu.rowsPermutation() * dense * lu.colsPermutation().inverse();
+    lu.matrixL().solveInPlace(U);
+
+    Eigen::VectorXd pivots;
+    double umax = upperFactorPivots(lu, pivots);
+    ASSERT_EQ(pivots.size(), n);
+    for (int k = 0; k < n; k++)
+        EXPECT_NEAR(pivots(k), U(k, k), 1e-12 * std::abs(U(k, k))) << k;
+    Eigen::MatrixXd upper = U.triangularView<Eigen::Upper>();
+    EXPECT_NEAR(umax, upper.cwiseAbs().maxCoeff(), 1e-12 * umax);
+    EXPECT_LT((U - upper).cwiseAbs().maxCoeff(), 1e-12 * umax);
+}
+
+TEST(SourceTable, ReadsEngineeringValuesAndRejectsRepeatedSources)
+{
+    std::string file = ::testing::TempDir() + "engineering.table";
+    std::ofstream(file) << "V1, I1\n% comment\n4.7K 1MEG\n10m -2u\n";
+    SourceTable table;
+    ASSERT_EQ(parseSourceTable(file, table), 0);
+    EXPECT_EQ(table.sources, (std::vector<std::string>{"V1", "I1"}));
+    ASSERT_EQ(table.values.rows(), 2);
+    EXPECT_DOUBLE_EQ(table.values(0, 0), 4.7e3);
+    EXPECT_DOUBLE_EQ(table.values(0, 1), 1e6);
+    EXPECT_DOUBLE_EQ(table.values(1, 0), 10e-3);
+    EXPECT_DOUBLE_EQ(table.values(1, 1), -2e-6);
+
+    std::ofstream(file) << "V1 I1 V1\n1 2 3\n";
+    EXPECT_EQ(parseSourceTable(file, table), 1);
+}
+
+TEST(SourceTable, EveryCaseMatchesASolveWithItsValues)
+{
+    // V1 and V2 have branch unknowns; the first case keeps the netlist
+    // values
+    SourceTable table;
+    table.sources = {"V1", "I2", "V2"};
+    table.values.resize(3, 3);
+    table.values << 10, 0.02, 3, -4, 0.02, 7.5, 2.5, -0.1, 0;
+
+    std::string netlist = testFile("netlists", "mixed", ".sns");
+    for (bool sparse : {false, true}) {
+        SCOPED_TRACE(sparse ? "sparse" : "dense");
+        SolverOptions options;
+        options.sparse = sparse;
+        options.threads = 1;
+
+        Parser parser;
+        ASSERT_EQ(parser.parse(netlist), 0);
+        std::map<std::string, int> indexMap;
+        makeIndexMap(indexMap, parser);
+        ASSERT_TRUE(indexMap.count("V1"));
+        std::vector<Island> islands;
+        ASSERT_EQ(findIslands(makeGraph(parser.circuitElements), indexMap,
+                              islands),
+                  0);
+        Eigen::MatrixXd X =
+            Eigen::MatrixXd::Zero(int(indexMap.size()), table.values.rows());
+        solveIslands(islands, indexMap, options, X, nullptr, nullptr, &table);
+
+        for (int c = 0; c < table.values.rows(); c++) {
+            Parser single;
+            ASSERT_EQ(single.parse(netlist), 0);
+            for (std::shared_ptr<CircuitElement> &element :
+                 single.circuitElements)
+                for (size_t s = 0; s < table.sources.size(); s++)
+                    if (element->name == table.sources[s])
+                        element->value = table.values(c, int(s));
+            std::map<std::string, int> singleMap;
+            Eigen::MatrixXd expected;
+            solveParsed(single, singleMap, expected, options);
+
+            for (const auto &entry : indexMap)
+                EXPECT_NEAR(X(entry.second, c),
+                            expected(singleMap.at(entry.first), 0),
+                            1e-12 * (1.0 + std::abs(X(entry.second, c))))
+                    << entry.first << ", case " << c;
+        }
+    }
+}
+
+TEST(Batch, MatchesOneSolvePerInstance)
+{
+    // Not a multiple of the lanes, so that the last batch is partial
+    std::string netlist = testFile("netlists", "controlled", ".sns");
+    SourceTable table;
+    table.sources = {"V1", "R1", "R2", "VC1", "IC2", "IC3", "R8"};
+    table.values.resize(37, int(table.sources.size()));
+    for (int c = 0; c < table.values.rows(); c++)
+        table.values.row(c) << 10.0 - c, 100.0 + 7 * c, 200.0 / (c + 1),
+            2.0 + 0.1 * c, 3.0 - 0.2 * c, 0.2 * c, 1000.0 * (c % 5 + 1);
+
+    Parser batched;
+    ASSERT_EQ(batched.parse(netlist), 0);
+    std::map<std::string, int> indexMap;
+    std::vector<Island> islands;
+    makeIndexMap(indexMap, batched);
+    ASSERT_EQ(
+        findIslands(makeGraph(batched.circuitElements), indexMap, islands), 0);
+    SolverOptions options;
+    options.batchTable = "table";
+    options.threads = 1;
+    Eigen::MatrixXd X =
+        Eigen::MatrixXd::Zero(int(indexMap.size()), table.values.rows());
+    std::vector<SolveReport> reports = solveIslands(
+        islands, indexMap, options, X, nullptr, nullptr, &table);
+    for (const SolveReport &report : reports) {
+        EXPECT_EQ(report.batch.instances, table.values.rows());
+        EXPECT_TRUE(report.batch.fixedSize);
+    }
+
+    for (int c = 0; c < table.values.rows(); c++) {
+        Parser parser;
+        ASSERT_EQ(parser.parse(netlist), 0);
+        for (std::shared_ptr<CircuitElement> element : parser.circuitElements)
+            for (size_t k = 0; k < table.sources.size(); k++)
+                if (element->name == table.sources[k])
+                    element->value = table.values(c, int(k));
+        std::map<std::string, int> singleMap;
+        Eigen::MatrixXd single;
+        solveParsed(parser, singleMap, single);
+        for (const std::pair<const std::string, int> &entry : indexMap)
+            EXPECT_NEAR(X(entry.second, c), single(entry.second, 0),
+                        1e-9 * std::max(1.0, std::abs(single(entry.second, 0))))
+                << entry.first << " in case " << c;
+    }
+}
+
+TEST(CodeGen, RecordedSolveMatchesTheSolver)
+{
+    std::string netlist = testFile("netlists", "controlled", ".sns");
+    Parser parser;
+    ASSERT_EQ(parser.parse(netlist), 0);
+    std::map<std::string, int> indexMap;
+    makeIndexMap(indexMap, parser);
+    StaticSolve solve;
+    ASSERT_EQ(makeStaticSolve(parser.circuitElements, indexMap, solve), 0);
+    EXPECT_EQ(solve.values.size(), parser.circuitElements.size());
+
+    // The values are parameters of the solve, not part of it
+    Eigen::VectorXd values = solve.defaults;
+    for (int k = 0; k < values.size(); k++) values(k) *= 1.0 + 0.1 * k;
+    Parser changed;
+    ASSERT_EQ(changed.parse(netlist), 0);
+    for (size_t k = 0; k < changed.circuitElements.size(); k++)
+        changed.circuitElements[k]->value = values(int(k));
+
+    std::map<std::string, int> solvedMap;
+    Eigen::MatrixXd X;
+    solveParsed(changed, solvedMap, X);
+    Eigen::VectorXd x;
+    ASSERT_TRUE(runStaticSolve(solve, values, x));
+    for (const std::pair<const std::string, int> &entry : indexMap)
+        EXPECT_NEAR(x(entry.second), X(solvedMap.at(entry.first), 0),
+                    1e-9 * std::max(1.0, std::abs(x(entry.second))))
+            << entry.first;
+
+    std::string file = ::testing::TempDir() + "controlled.cpp";
+    ASSERT_EQ(writeStaticSolve(file, solve, netlist), 0);
+    std::ifstream generated(file);
+    std::string code((std::istreambuf_iterator<char>(generated)),
+                     std::istreambuf_iterator<char>());
+    EXPECT_NE(code.find("int snuSpiceSolve(const double *v, double *x)"),
+              std::string::npos);
+}
+
+TEST(Memory, PlanPicksThePreferredPathThenFallsBackInOrder)
+{
+    // A long ladder is cheapest sparse, a complete graph cheapest dense
+    std::string ladder = ::testing::TempDir() + "plan_ladder.sns";
+    std::string complete = ::testing::TempDir() + "plan_complete.sns";
+    {
+        std::ofstream file(ladder);
+        file << "V1 1 0 1\n";
+        for (int k = 1; k < 3000; k++)
+            file << "R" << k << " " << k << " " << k + 1 << " 1\nRS" << k
+                 << " " << k + 1 << " 0 1\n";
+    }
+    {
+        std::ofstream file(complete);
+        file << "V1 1 0 1\n";
+        for (int a = 1; a <= 300; a++)
+            for (int b = 0; b < a; b++)
+                file << "R" << a << "_" << b << " " << a << " " << b << " 1\n";
+    }
+
+    for (const std::string &netlist : {ladder, complete}) {
+        SCOPED_TRACE(netlist);
+        Parser parser;
+        ASSERT_EQ(parser.parse(netlist), 0);
+        std::map<std::string, int> indexMap;
+        makeIndexMap(indexMap, parser);
+        std::vector<Island> islands;
+        ASSERT_EQ(findIslands(makeGraph(parser.circuitElements), indexMap,
+                              islands),
+                  0);
+
+        // Limits are set around the estimates on top of what is resident
+        // right before planning
+        std::map<SolvePath, std::size_t> bytes;
+        auto plan = [&](SolvePath preferred, double limit) {
+            MemoryPlan estimates = planMemory(islands, indexMap, 1, preferred,
+                                              0, true);
+            for (const MemoryEstimate &estimate : estimates.candidates)
+                bytes[estimate.path] = estimate.bytes;
+            return planMemory(islands, indexMap, 1, preferred,
+                              estimates.resident + std::size_t(limit), true);
+        };
+
+        // Candidates come in the documented order, out-of-core last
+        MemoryPlan first = plan(mixedSolve, 0);
+        std::vector<SolvePath> order;
+        for (const MemoryEstimate &estimate : first.candidates)
+            order.push_back(estimate.path);
+        EXPECT_EQ(order, (std::vector<SolvePath>{mixedSolve, sparseSolve,
+                                                  denseSolve,
+                                                  outOfCoreSolve}));
+        ASSERT_LT(bytes[denseSolve], bytes[mixedSolve]);
+
+        // The preferred path whenever it fits
+        MemoryPlan picked = plan(mixedSolve, 1.25 * bytes[mixedSolve]);
+        EXPECT_TRUE(picked.fits);
+        EXPECT_EQ(picked.path, mixedSolve);
+
+        // Then sparse, then dense
+        picked =
+            plan(mixedSolve, 0.5 * (bytes[denseSolve] + bytes[mixedSolve]));
+        EXPECT_TRUE(picked.fits);
+        if (netlist == ladder) {
+            ASSERT_LT(bytes[sparseSolve], bytes[denseSolve]);
+            EXPECT_EQ(picked.path, sparseSolve);
+        } else {
+            ASSERT_GT(bytes[sparseSolve], bytes[mixedSolve]);
+            EXPECT_EQ(picked.path, denseSolve);
+        }
+
+        // Nothing fits: every estimate is still reported
+        std::size_t smallest = bytes[outOfCoreSolve];
+        for (const auto &estimate : bytes)
+            smallest = std::min(smallest, estimate.second);
+        MemoryPlan none = plan(denseSolve, 0.5 * smallest);
+        EXPECT_FALSE(none.fits);
+        ASSERT_EQ(none.candidates.size(), 4u);
+        for (const MemoryEstimate &estimate : none.candidates)
+            EXPECT_EQ(estimate.bytes, bytes[estimate.path]);
+    }
+}
+
+TEST(OutOfCore, MatchesTheInMemorySolution)
+{
+    // Budgets of a few columns per panel, so that the factors of the
+    // largest island take several panels
+    std::vector<std::pair<std::string, std::size_t>> cases = {
+        {"controlled", 1024}, {"mixed", 4096}};
+    for (const std::pair<std::string, std::size_t> &test : cases) {
+        const std::string &name = test.first;
+        std::string netlist = testFile("netlists", name, ".sns");
+        Parser inMemory, outOfCore;
+        ASSERT_EQ(inMemory.parse(netlist), 0);
+        ASSERT_EQ(outOfCore.parse(netlist), 0);
+
+        std::map<std::string, int> memoryMap, diskMap;
+        Eigen::MatrixXd memoryX, diskX;
+        std::vector<SolveReport> reports;
+        SolverOptions options;
+        options.outOfCore = true;
+        options.scratchDir = ::testing::TempDir();
+        options.outOfCoreBudget = test.second;
+        solveParsed(inMemory, memoryMap, memoryX);
+        solveParsed(outOfCore, diskMap, diskX, options, &reports);
+
+        int panels = 0;
+        for (const SolveReport &report : reports) {
+            EXPECT_TRUE(report.outOfCore.used) << report.outOfCore.failure;
+            panels = std::max(panels, report.outOfCore.panels);
+        }
+        EXPECT_GT(panels, 1);
+        for (const std::pair<const std::string, int> &entry : memoryMap)
+            EXPECT_NEAR(diskX(entry.second, 0), memoryX(entry.second, 0),
+                        1e-9 * std::max(1.0,
+                                        std::abs(memoryX(entry.second, 0))))
+                << name << " " << entry.first;
+    }
+}
+
+TEST(Domain, MatchesTheDirectSolution)
+{
+    for (const std::string name : {"ladder", "mixed"}) {
+        std::string netlist = testFile("netlists", name, ".sns");
+        Parser direct, split;
+        ASSERT_EQ(direct.parse(netlist), 0);
+        ASSERT_EQ(split.parse(netlist), 0);
+
+        std::map<std::string, int> directMap, splitMap;
+        Eigen::MatrixXd directX;
+        solveParsed(direct, directMap, directX);
+
+        // Several threads, which the islands solved by domains must not use
+        std::vector<Island> islands;
+        makeIndexMap(splitMap, split);
+        ASSERT_EQ(
+            findIslands(makeGraph(split.circuitElements), splitMap, islands),
+            0);
+        SolverOptions options;
+        options.domains = 3;
+        options.threads = 4;
+        Eigen::MatrixXd splitX = Eigen::MatrixXd::Zero(int(splitMap.size()), 1);
+        std::vector<SolveReport> reports =
+            solveIslands(islands, splitMap, options, splitX);
+        appendProbeCurrents(makeCurrentProbes(split.currentProbes, splitMap,
+                                              int(splitX.rows())),
+                            splitMap, splitX);
+
+        // The largest island is split over every worker, the others at
+        // least tried
+        bool splitOverAll = false;
+        for (const SolveReport &report : reports) {
+            EXPECT_TRUE(report.domains.used ||
+                        report.domains.failure == "it is too small to split")
+                << name << ": " << report.domains.failure;
+            splitOverAll =
+                splitOverAll || (report.domains.used &&
+                                 report.domains.interiors.size() == 3);
+        }
+        EXPECT_TRUE(splitOverAll) << name;
+        for (const std::pair<const std::string, int> &entry : directMap)
+            EXPECT_NEAR(splitX(entry.second, 0), directX(entry.second, 0),
+                        1e-9 * std::max(1.0,
+                                        std::abs(directX(entry.second, 0))))
+                << name << " " << entry.first;
+    }
+}
+
+TEST(CircuitTable, ControllerRowsKeepTheNodesOfTheControllingElement)
+{
+    // A table holding only a grounded half of the controlling source
+    std::shared_ptr<CircuitElement> source = std::make_shared<CircuitElement>(
+        CircuitElement{"I1", I, "7", "8", G1, 1e-3, none, nullptr, false});
+    std::shared_ptr<CircuitElement> half =
+        std::make_shared<CircuitElement>(*source);
+    half->nodeB = "0";
+    std::shared_ptr<CircuitElement> controlled =
+        std::make_shared<CircuitElement>(
+            CircuitElement{"VC1", Vc, "9", "0", G2, 2, v, source, false});
+    CircuitTable circuit = makeCircuitTable({half, controlled});
+
+    ASSERT_EQ(circuit.count, 2);
+    int c = circuit.controller[1];
+    ASSERT_GE(c, 0);
+    EXPECT_EQ(circuit.nodes[circuit.nodeA[c]], "7");
+    EXPECT_EQ(circuit.nodes[circuit.nodeB[c]], "8");
+}
+
+TEST(Assembly, ThreadsBuildTheSameMatrix)
+{
+    // A ladder with every rung doubled, so the matrix sums duplicates, long
+    // enough for four threads of assemblyGrain records
+    const int n = 6000;
+    std::vector<std::shared_ptr<CircuitElement>> elements;
+    std::map<std::string, int> indexMap;
+    for (int k = 1; k <= n; k++) {
+        std::string node = std::to_string(k), previous = std::to_string(k - 1);
+        indexMap[node] = k - 1;
+        elements.push_back(std::make_shared<CircuitElement>(CircuitElement{
+            "R" + node, R, node, previous, G1, 1.0 + k % 7, none, nullptr,
+            false}));
+        elements.push_back(std::make_shared<CircuitElement>(CircuitElement{
+            "S" + node, R, previous, node, G1, 3.0 + k % 5, none, nullptr,
+            false}));
+        elements.push_back(std::make_shared<CircuitElement>(CircuitElement{
+            "I" + node, I, "0", node, G1, 1e-3 * k, none, nullptr, false}));
+    }
+    std::vector<StampRecord> records = makeStampRecords(elements, indexMap);
+    ASSERT_GE(records.size(), 4 * assemblyGrain);
+
+    Eigen::SparseMatrix<double> serial, threaded;
+    Eigen::VectorXd serialRhs, threadedRhs;
+    assembleSparse(records, n, 1, serial, serialRhs);
+    assembleSparse(records, n, 4, threaded, threadedRhs);
+
+    ASSERT_TRUE(serial.isCompressed() && threaded.isCompressed());
+    ASSERT_EQ(serial.nonZeros(), 3 * n - 2);
+    ASSERT_EQ(threaded.nonZeros(), serial.nonZeros());
+    EXPECT_TRUE(std::equal(serial.outerIndexPtr(),
+                           serial.outerIndexPtr() + n + 1,
+                           threaded.outerIndexPtr()));
+    EXPECT_TRUE(std::equal(serial.innerIndexPtr(),
+                           serial.innerIndexPtr() + serial.nonZeros(),
+                           threaded.innerIndexPtr()));
+    EXPECT_TRUE(std::equal(serial.valuePtr(),
+                           serial.valuePtr() + serial.nonZeros(),
+                           threaded.valuePtr()));
+    // The sentinel row sums every grounded source in per thread parts
+    EXPECT_TRUE(serialRhs.head(n) == threadedRhs.head(n));
+    EXPECT_NEAR(serialRhs(n), threadedRhs(n), 1e-12 * std::abs(serialRhs(n)));
+}
+
+TEST(Parser, ReadsSignedSweepRangesAndParameters)
+{
+    // A negative start, then a negative step
+    std::string netlist = ::testing::TempDir() + "signed.sns";
+    std::ofstream(netlist) << "V1 1 0 5\nR1 1 0 1k\n.DC V1 -5 500m 1\n";
+    Parser rising;
+    ASSERT_EQ(rising.parse(netlist), 0);
+    EXPECT_EQ(rising.sweep.source, "V1");
+    EXPECT_DOUBLE_EQ(rising.sweep.start, -5.0);
+    EXPECT_DOUBLE_EQ(rising.sweep.stop, 0.5);
+    EXPECT_DOUBLE_EQ(rising.sweep.step, 1.0);
+
+    std::ofstream(netlist) << "V1 1 0 5\nR1 1 0 1k\n.DC V1 5 0 -1\n";
+    Parser falling;
+    ASSERT_EQ(falling.parse(netlist), 0);
+    EXPECT_DOUBLE_EQ(falling.sweep.start, 5.0);
+    EXPECT_DOUBLE_EQ(falling.sweep.stop, 0.0);
+    EXPECT_DOUBLE_EQ(falling.sweep.step, -1.0);
+
+    std::string program = "SNU_Spice", parameter = "--param",
+                values = "vin=-3,gain=+2k,bias=-10u";
+    char *argv[] = {&program[0], &netlist[0], &parameter[0], &values[0]};
+    SolverOptions options;
+    ASSERT_EQ(parseArguments(4, argv, options), 0);
+    ASSERT_EQ(options.parameters.size(), 3u);
+    EXPECT_EQ(options.parameters[0].first, "VIN");
+    EXPECT_DOUBLE_EQ(options.parameters[0].second, -3.0);
+    EXPECT_DOUBLE_EQ(options.parameters[1].second, 2e3);
+    EXPECT_DOUBLE_EQ(options.parameters[2].second, -10e-6);
+}
+
+TEST(Parser, SelectsProbedUnknownsAndCurrentsInDirectiveOrder)
+{
+    std::string file = ::testing::TempDir() + "probes.sns";
+    std::ofstream(file) << "V1 1 0 10\nR1 1 2 1K\nR3 2 3 500\nR4 3 0 500\n"
+                           ".PROBE V(2) I(R1)\n.PRINT V1 2 R4 NOPE\n";
+    Parser parser;
+    ASSERT_EQ(parser.parse(file), 0);
+    EXPECT_EQ(parser.probes, (std::vector<std::string>{"2", "R1", "V1", "2",
+                                                        "R4", "NOPE"}));
+
+    // The probed resistors get their current computed after the solve
+    std::map<std::string, int> indexMap;
+    Eigen::MatrixXd X;
+    solveParsed(parser, indexMap, X);
+    ASSERT_TRUE(indexMap.count("R1") && indexMap.count("R4"));
+    EXPECT_FALSE(indexMap.count("R3"));
+
+    std::vector<std::pair<std::string, int>> outputs;
+    EXPECT_EQ(selectOutputs(indexMap, parser.probes, outputs), 1);
+    std::vector<std::string> names;
+    for (const std::pair<std::string, int> &output : outputs) {
+        names.push_back(output.first);
+        EXPECT_EQ(output.second, indexMap.at(output.first));
+    }
+    EXPECT_EQ(names, (std::vector<std::string>{"2", "R1", "V1", "R4"}));
+    EXPECT_NEAR(X(indexMap.at("2"), 0), 5.0, 1e-12);
+    EXPECT_NEAR(X(indexMap.at("R1"), 0), 5e-3, 1e-15);
+    EXPECT_NEAR(std::abs(X(indexMap.at("V1"), 0)), 5e-3, 1e-15);
+    EXPECT_NEAR(X(indexMap.at("R4"), 0), 5e-3, 1e-15);
+
+    // Without probes every unknown is printed, in index map order
+    EXPECT_EQ(selectOutputs(indexMap, {}, outputs), 0);
+    EXPECT_EQ(outputs, (std::vector<std::pair<std::string, int>>(
+                           indexMap.begin(), indexMap.end())));
+}
+
+TEST(Graph, ListsEveryElementFromBothTerminals)
+{
+    Parser parser;
+    ASSERT_EQ(parser.parse(testFile("netlists", "controlled", ".sns")), 0);
+    Graph graph = makeGraph(parser.circuitElements);
+
+    ASSERT_EQ(graph.offsets.size(), size_t(graph.nodeCount() + 1));
+    ASSERT_EQ(graph.neighbors.size(), 2 * parser.circuitElements.size());
+    EXPECT_EQ(graph.names[graph.ground], "0");
+    std::vector<int> seen(graph.elements.size(), 0);
+    for (int node = 0; node < graph.nodeCount(); node++)
+        for (int k = graph.offsets[node]; k < graph.offsets[node + 1]; k++) {
+            const CircuitElement &element =
+                *graph.elements[graph.elementIds[k]];
+            std::string near = graph.names[node];
+            std::string far = graph.names[graph.neighbors[k]];
+            EXPECT_TRUE((near == element.nodeA && far == element.nodeB) ||
+                        (near == element.nodeB && far == element.nodeA))
+                << element.name;
+            seen[graph.elementIds[k]]++;
+        }
+    EXPECT_EQ(seen, std::vector<int>(graph.elements.size(), 2));
+}
+
+TEST(Waveform, ReadsBackWhatWasWritten)
+{
+    // Chunks of 64 points, the last one partial, and a signal that changes
+    // sign and magnitude so the differences take varints of every length
+    const int points = 150;
+    Eigen::MatrixXd values(points, 2);
+    std::vector<double> axis(points);
+    for (int k = 0; k < points; k++) {
+        axis[k] = 0.01 * k + 1e-3 * (k % 3);
+        values(k, 0) = std::exp(0.013 * k);
+        values(k, 1) = std::sin(0.3 * k) * std::pow(10.0, k % 7 - 3);
+    }
+
+    for (double tolerance : {0.0, 1e-4}) {
+        std::string file = ::testing::TempDir() + "roundtrip.wave";
+        WaveformWriter writer;
+        ASSERT_EQ(writer.open(file, "V1", {"up", "swing"}, tolerance, 64), 0);
+        for (int k = 0; k < points; k++)
+            writer.append(axis[k], values.row(k).transpose());
+        ASSERT_EQ(writer.close(), 0);
+
+        WaveformReader reader;
+        ASSERT_EQ(reader.open(file), 0);
+        EXPECT_EQ(reader.axis, "V1");
+        EXPECT_EQ(reader.names, (std::vector<std::string>{"up", "swing"}));
+        EXPECT_EQ(reader.points, std::uint64_t(points));
+        ASSERT_EQ(reader.index.size(), 3u);
+        for (int signal = 0; signal < 2; signal++) {
+            std::vector<double> axisValues, read;
+            ASSERT_EQ(reader.read(reader.names[signal], -HUGE_VAL, HUGE_VAL,
+                                  axisValues, read),
+                      0);
+            ASSERT_EQ(read.size(), size_t(points));
+            for (int k = 0; k < points; k++) {
+                // The axis is always lossless
+                EXPECT_EQ(axisValues[k], axis[k]);
+                if (tolerance == 0.0) {
+                    EXPECT_EQ(read[k], values(k, signal)) << k;
+                } else {
+                    EXPECT_LE(std::abs(read[k] - values(k, signal)),
+                              tolerance)
+                        << k;
+                }
+            }
+        }
+
+        // A window across the first chunk boundary
+        std::vector<double> axisValues, read;
+        ASSERT_EQ(reader.read("swing", axis[60], axis[70], axisValues, read),
+                  0);
+        ASSERT_EQ(read.size(), 11u);
+        EXPECT_EQ(axisValues.front(), axis[60]);
+        EXPECT_EQ(axisValues.back(), axis[70]);
+    }
+}
+
+TEST(MatrixMarket, ReadsBackWhatWasWrittenAndRejectsOtherKinds)
+{
+    // Values that need all 17 significant digits
+    std::vector<Eigen::Triplet<double>> triplets = {
+        {0, 0, 1.0 / 3.0}, {1, 0, -2e-300}, {2, 1, 3.141592653589793},
+        {1, 1, 0.1},       {0, 2, -7e12},   {2, 2, std::sqrt(2.0)}};
+    Eigen::SparseMatrix<double> A(3, 3);
+    A.setFromTriplets(triplets.begin(), triplets.end());
+    A.makeCompressed();
+    Eigen::VectorXd b(3);
+    b << 2.0 / 3.0, -1e-17, 6.02214076e23;
+    std::vector<std::string> names = {"1", "out", "V1"};
+
+    std::string base = ::testing::TempDir() + "roundtrip";
+    ASSERT_EQ(writeMatrixMarket(base, A, b, names), 0);
+
+    Eigen::SparseMatrix<double> readA;
+    Eigen::VectorXd readB;
+    std::vector<std::string> readNames;
+    ASSERT_EQ(readMatrixMarket(base, readA, readB, readNames), 0);
+    ASSERT_EQ(readA.rows(), 3);
+    ASSERT_EQ(readA.nonZeros(), A.nonZeros());
+    EXPECT_TRUE(std::equal(A.outerIndexPtr(), A.outerIndexPtr() + 4,
+                           readA.outerIndexPtr()));
+    EXPECT_TRUE(std::equal(A.innerIndexPtr(),
+                           A.innerIndexPtr() + A.nonZeros(),
+                           readA.innerIndexPtr()));
+    EXPECT_TRUE(std::equal(A.valuePtr(), A.valuePtr() + A.nonZeros(),
+                           readA.valuePtr()));
+    EXPECT_TRUE(readB == b);
+    EXPECT_EQ(readNames, names);
+
+    // Symmetric files hold half of the entries, pattern files no values
+    for (const std::string banner :
+         {"%%MatrixMarket matrix coordinate real symmetric",
+          "%%MatrixMarket matrix coordinate pattern general"}) {
+        std::ofstream(base + ".mtx") << banner << "\n1 1 1\n1 1 2\n";
+        EXPECT_EQ(readMatrixMarket(base, readA, readB, readNames), 1)
+            << banner;
+    }
+}
+
+TEST(SpscQueue, DeliversEveryItemInOrderThenCloses)
+{
+    SpscQueue<int> queue(4);
+    const int count = 100000;
+    std::thread producer([&] {
+        for (int k = 0; k < count; k++) queue.push(k);
+        queue.close();
+    });
+    int item = -1, expected = 0;
+    while (queue.pop(item)) EXPECT_EQ(item, expected++);
+    producer.join();
+    EXPECT_EQ(expected, count);
+}
+
+TEST(ResultCache, KeysIgnoreLineOrderAndEvictLeastRecentlyUsed)
+{
+    // The same netlist reversed, with a comment
+    std::string netlist = testFile("netlists", "mixed", ".sns");
+    std::string reversed = ::testing::TempDir() + "reversed.sns";
+    {
+        std::ifstream in(netlist);
+        std::vector<std::string> lines;
+        for (std::string line; std::getline(in, line);) lines.push_back(line);
+        std::ofstream out(reversed);
+        out << "% reversed\n";
+        for (size_t k = lines.size(); k-- > 0;) out << lines[k] << "\n";
+    }
+    Parser original, shuffled;
+    ASSERT_EQ(original.parse(netlist), 0);
+    ASSERT_EQ(shuffled.parse(reversed), 0);
+    SourceTable table;
+    std::string description = describeCircuit(original, table, "dense");
+    EXPECT_EQ(describeCircuit(shuffled, table, "dense"), description);
+    EXPECT_NE(describeCircuit(shuffled, table, "sparse"), description);
+    shuffled.circuitElements[0]->value *= 1 + 1e-15;
+    EXPECT_NE(describeCircuit(shuffled, table, "dense"), description);
+
+    // Reduced models are described by the contents of their files
+    std::string model = ::testing::TempDir() + "model.rom";
+    std::ofstream(model) << "first\n";
+    original.reducedModels = {model};
+    std::string withModel = describeCircuit(original, table, "dense");
+    std::ofstream(model) << "second\n";
+    EXPECT_NE(describeCircuit(original, table, "dense"), withModel);
+    original.reducedModels.clear();
+
+    std::string directory = ::testing::TempDir() + "cache";
+    std::filesystem::remove_all(directory);
+    ResultCache cache;
+    ASSERT_EQ(cache.open(directory, 1 << 20), 0);
+    std::vector<std::string> names;
+    Eigen::MatrixXd values;
+    EXPECT_FALSE(cache.lookup(description, names, values));
+    Eigen::MatrixXd stored = Eigen::MatrixXd::Random(3, 2);
+    ASSERT_EQ(cache.store(description, {"1", "2", "V1"}, stored), 0);
+    ASSERT_TRUE(cache.lookup(description, names, values));
+    EXPECT_EQ(names, (std::vector<std::string>{"1", "2", "V1"}));
+    EXPECT_EQ(values, stored);
+
+    // The first entry, used again after two newer ones were stored, is
+    // kept when the next store evicts one entry
+    for (const std::string entry : {"entry B", "entry C"}) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        ASSERT_EQ(cache.store(entry, {"1"}, stored.topRows(1)), 0);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ASSERT_TRUE(cache.lookup(description, names, values));
+    std::uintmax_t total = 0;
+    for (const auto &entry : std::filesystem::directory_iterator(directory))
+        if (entry.path().extension() == ".op") total += entry.file_size();
+    cache.limit = total;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ASSERT_EQ(cache.store("entry D", {"1"}, stored.topRows(1)), 0);
+    EXPECT_EQ(cache.evictions, 1u);
+    EXPECT_TRUE(cache.lookup(description, names, values));
+    EXPECT_FALSE(cache.lookup("entry B", names, values));
+    EXPECT_TRUE(cache.lookup("entry C", names, values));
+    EXPECT_TRUE(cache.lookup("entry D", names, values));
+
+    // A limit of one byte keeps only the last one stored
+    cache.limit = 1;
+    ASSERT_EQ(cache.store("other", {"1"}, stored.topRows(1)), 0);
+    EXPECT_FALSE(cache.lookup(description, names, values));
+    EXPECT_TRUE(cache.lookup("other", names, values));
+    EXPECT_EQ(cache.hits, 6u);
+    EXPECT_EQ(cache.misses, 3u);
+    EXPECT_EQ(cache.evictions, 4u);
+}